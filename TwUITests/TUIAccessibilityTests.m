@@ -0,0 +1,139 @@
+//
+//  TUIAccessibilityTests.m
+//  TwUITests
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import <TwUI/TUIKit.h>
+#import <TwUI/TUIView+Private.h>
+
+@interface TUIAccessibilityTests : SenTestCase
+{
+	NSWindow *_window;
+	TUINSView *_nsView;
+	TUIView *_root;
+}
+@end
+
+@implementation TUIAccessibilityTests
+
+- (void)setUp
+{
+	[super setUp];
+	_window = [[NSWindow alloc] initWithContentRect:NSMakeRect(100, 200, 300, 300) styleMask:NSBorderlessWindowMask backing:NSBackingStoreBuffered defer:YES];
+	[_window setReleasedWhenClosed:NO];
+	_nsView = [[TUINSView alloc] initWithFrame:NSMakeRect(0, 0, 300, 300)];
+	[_window setContentView:_nsView];
+	_root = [[TUIView alloc] initWithFrame:CGRectMake(0, 0, 300, 300)];
+	_nsView.rootView = _root;
+}
+
+- (void)tearDown
+{
+	[_window close];
+	_window = nil;
+	_nsView = nil;
+	_root = nil;
+	[super tearDown];
+}
+
+- (TUIView *)elementWithFrame:(CGRect)frame
+{
+	TUIView *view = [[TUIView alloc] initWithFrame:frame];
+	view.isAccessibilityElement = YES;
+	return view;
+}
+
+- (NSArray *)childrenOf:(TUIView *)view
+{
+	return [view accessibilityAttributeValue:NSAccessibilityChildrenAttribute];
+}
+
+#pragma mark Children
+
+- (void)testChildrenAreCachedUntilTheHierarchyChanges
+{
+	TUIView *a = [self elementWithFrame:CGRectMake(0, 0, 10, 10)];
+	[_root addSubview:a];
+	
+	NSArray *children = [self childrenOf:_root];
+	STAssertEqualObjects(children, [NSArray arrayWithObject:a], nil);
+	STAssertTrue([self childrenOf:_root] == children, @"the same array until something changes");
+	
+	TUIView *b = [self elementWithFrame:CGRectMake(20, 0, 10, 10)];
+	[_root addSubview:b];
+	children = [self childrenOf:_root];
+	STAssertEqualObjects(children, ([NSArray arrayWithObjects:a, b, nil]), nil);
+	
+	[a removeFromSuperview];
+	STAssertEqualObjects([self childrenOf:_root], [NSArray arrayWithObject:b], nil);
+}
+
+- (void)testChildrenFollowIsAccessibilityElement
+{
+	TUIView *a = [self elementWithFrame:CGRectMake(0, 0, 10, 10)];
+	TUIView *plain = [[TUIView alloc] initWithFrame:CGRectMake(20, 0, 10, 10)];
+	[_root addSubview:a];
+	[_root addSubview:plain];
+	STAssertEqualObjects([self childrenOf:_root], [NSArray arrayWithObject:a], nil);
+	
+	NSArray *children = [self childrenOf:_root];
+	a.isAccessibilityElement = YES; // unchanged
+	STAssertTrue([self childrenOf:_root] == children, nil);
+	
+	plain.isAccessibilityElement = YES;
+	STAssertEqualObjects([self childrenOf:_root], ([NSArray arrayWithObjects:a, plain, nil]), nil);
+	a.isAccessibilityElement = NO;
+	STAssertEqualObjects([self childrenOf:_root], [NSArray arrayWithObject:plain], nil);
+}
+
+#pragma mark Geometry
+
+- (void)testFramesAreInScreenCoordinates
+{
+	TUIView *a = [self elementWithFrame:CGRectMake(10, 20, 30, 40)];
+	[_root addSubview:a];
+	STAssertEquals(a.accessibilityFrame, CGRectMake(110, 220, 30, 40), nil);
+	
+	a.frame = CGRectMake(50, 60, 30, 40);
+	STAssertEquals(a.accessibilityFrame, CGRectMake(150, 260, 30, 40), @"moving invalidates the cached frame");
+	
+	_root.frame = CGRectMake(5, 0, 300, 300);
+	STAssertEquals(a.accessibilityFrame, CGRectMake(155, 260, 30, 40), @"so does moving an ancestor");
+}
+
+- (void)testUnchangedGeometryKeepsTheCache
+{
+	TUIView *a = [self elementWithFrame:CGRectMake(10, 20, 30, 40)];
+	[_root addSubview:a];
+	[_root.layer layoutIfNeeded];
+	NSUInteger generation = [_nsView _accessibilityGeometryGeneration];
+	
+	a.frame = a.frame;
+	_root.bounds = _root.bounds;
+	STAssertEquals([_nsView _accessibilityGeometryGeneration], generation, @"setting the same frame moves nothing");
+	
+	[_root layoutSublayersOfLayer:_root.layer];
+	STAssertEquals([_nsView _accessibilityGeometryGeneration], generation, @"a layout pass that changes no size moves nothing");
+	
+	a.frame = CGRectMake(11, 20, 30, 40);
+	STAssertTrue([_nsView _accessibilityGeometryGeneration] != generation, nil);
+}
+
+- (void)testResizingInvalidatesAutoresizedSubviews
+{
+	TUIView *container = [[TUIView alloc] initWithFrame:CGRectMake(0, 0, 100, 100)];
+	TUIView *a = [self elementWithFrame:CGRectMake(0, 90, 10, 10)];
+	a.autoresizingMask = TUIViewAutoresizingFlexibleBottomMargin;
+	[container addSubview:a];
+	[_root addSubview:container];
+	[container layoutSublayersOfLayer:container.layer];
+	NSUInteger generation = [_nsView _accessibilityGeometryGeneration];
+	
+	// the size changing is what lets autoresizing move subviews behind our back
+	container.layer.bounds = CGRectMake(0, 0, 100, 200);
+	[container layoutSublayersOfLayer:container.layer];
+	STAssertTrue([_nsView _accessibilityGeometryGeneration] != generation, nil);
+}
+
+@end
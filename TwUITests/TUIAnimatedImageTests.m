@@ -0,0 +1,131 @@
+//
+//  TUIAnimatedImageTests.m
+//  TwUITests
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import <TwUI/TUIKit.h>
+#import "TUITestHelpers.h"
+
+@interface TUIAnimatedImageTestObserver : NSObject <TUIFrameClockObserver>
+@property (nonatomic, strong) NSMutableArray *ticks;
+@property (nonatomic, assign) BOOL removeOnTick;
+@end
+
+@implementation TUIAnimatedImageTestObserver
+@synthesize ticks;
+@synthesize removeOnTick;
+
+- (id)init
+{
+	if((self = [super init]))
+		ticks = [[NSMutableArray alloc] init];
+	return self;
+}
+
+- (void)frameClockDidTick:(NSTimeInterval)timestamp
+{
+	[ticks addObject:[NSNumber numberWithDouble:timestamp]];
+	if(removeOnTick)
+		[[TUIFrameClock sharedClock] removeObserver:self];
+}
+
+@end
+
+@interface TUIAnimatedImageTests : SenTestCase
+@end
+
+@implementation TUIAnimatedImageTests
+
+- (void)testSingleFrameIsNotAnimated
+{
+	STAssertNil([TUIAnimatedImage animatedImageWithData:TUITestGIF([NSArray arrayWithObject:[NSNumber numberWithDouble:0.1]])], nil);
+	STAssertNil([TUIAnimatedImage animatedImageWithData:nil], nil);
+}
+
+- (void)testDelaysBelowMinimumAreClamped
+{
+	NSArray *delays = [NSArray arrayWithObjects:
+					   [NSNumber numberWithDouble:0.0],
+					   [NSNumber numberWithDouble:0.01],
+					   [NSNumber numberWithDouble:0.05],
+					   [NSNumber numberWithDouble:0.5],
+					   nil];
+	TUIAnimatedImage *image = [TUIAnimatedImage animatedImageWithData:TUITestGIF(delays)];
+	STAssertNotNil(image, nil);
+	STAssertEquals(image.frameCount, (NSUInteger)4, nil);
+	STAssertEqualsWithAccuracy([image delayAtIndex:0], 0.1, 0.001, @"unspecified gets the default");
+	STAssertEqualsWithAccuracy([image delayAtIndex:1], 0.1, 0.001, @"too short to be meant gets the default");
+	STAssertEqualsWithAccuracy([image delayAtIndex:2], 0.05, 0.001, nil);
+	STAssertEqualsWithAccuracy([image delayAtIndex:3], 0.5, 0.001, nil);
+	STAssertEqualsWithAccuracy([image delayAtIndex:4], 0.0, 0.001, @"out of range");
+	STAssertEqualsWithAccuracy(image.duration, 0.75, 0.001, nil);
+}
+
+- (void)testFrameIndexForTime
+{
+	NSArray *delays = [NSArray arrayWithObjects:
+					   [NSNumber numberWithDouble:0.1],
+					   [NSNumber numberWithDouble:0.2],
+					   [NSNumber numberWithDouble:0.3],
+					   nil];
+	TUIAnimatedImage *image = [TUIAnimatedImage animatedImageWithData:TUITestGIF(delays)];
+	STAssertEquals([image frameIndexForTime:-1.0], (NSUInteger)0, nil);
+	STAssertEquals([image frameIndexForTime:0.0], (NSUInteger)0, nil);
+	STAssertEquals([image frameIndexForTime:0.05], (NSUInteger)0, nil);
+	STAssertEquals([image frameIndexForTime:0.15], (NSUInteger)1, nil);
+	STAssertEquals([image frameIndexForTime:0.35], (NSUInteger)2, nil);
+	STAssertEquals([image frameIndexForTime:0.65], (NSUInteger)0, @"wraps at the duration");
+	STAssertEquals([image frameIndexForTime:0.6 * 10 + 0.45], (NSUInteger)2, nil);
+}
+
+- (void)testDecodesAheadWithinBudget
+{
+	NSMutableArray *delays = [NSMutableArray array];
+	for(int i = 0; i < 8; ++i)
+		[delays addObject:[NSNumber numberWithDouble:0.1]];
+	TUIAnimatedImage *image = [TUIAnimatedImage animatedImageWithData:TUITestGIF(delays)];
+	image.maxBufferedBytes = 16 * 16 * 4 * 3; // three frames
+	
+	[image bufferedFrameAtIndex:0];
+	STAssertTrue(TUITestWaitFor(^{ return (BOOL)(image.bufferedFrameCount == 3); }), @"decodes the three frames from the playhead");
+	STAssertNotNil([image bufferedFrameAtIndex:0], nil);
+	STAssertNotNil([image bufferedFrameAtIndex:1], @"moving the playhead keeps frames ahead of it");
+	
+	[image bufferedFrameAtIndex:6];
+	STAssertTrue(image.bufferedFrameCount <= 3, @"frames behind the playhead are dropped");
+	STAssertTrue(TUITestWaitFor(^{ return (BOOL)([image bufferedFrameAtIndex:7] != nil && [image bufferedFrameAtIndex:6] != nil); }), nil);
+	STAssertTrue(TUITestWaitFor(^{ return (BOOL)(image.bufferedFrameCount == 3); }), @"the window wraps to frame 0");
+	
+	image.maxBufferedBytes = 1; // never fewer than two
+	[image bufferedFrameAtIndex:0];
+	STAssertTrue(TUITestWaitFor(^{ return (BOOL)(image.bufferedFrameCount == 2); }), nil);
+	STAssertNil([image bufferedFrameAtIndex:8], @"out of range");
+}
+
+- (void)testPausedClockTicksOnlyWhenTold
+{
+	TUIFrameClock *clock = [TUIFrameClock sharedClock];
+	STAssertEquals(clock, [TUIFrameClock sharedClock], nil);
+	
+	TUIAnimatedImageTestObserver *a = [[TUIAnimatedImageTestObserver alloc] init];
+	TUIAnimatedImageTestObserver *b = [[TUIAnimatedImageTestObserver alloc] init];
+	b.removeOnTick = YES;
+	clock.paused = YES;
+	[clock addObserver:a];
+	[clock addObserver:b];
+	[clock addObserver:a]; // added once
+	
+	[[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
+	STAssertEquals([a.ticks count], (NSUInteger)0, @"paused");
+	
+	[clock tickWithTimestamp:1.0];
+	[clock tickWithTimestamp:2.0];
+	STAssertEqualObjects(a.ticks, ([NSArray arrayWithObjects:[NSNumber numberWithDouble:1.0], [NSNumber numberWithDouble:2.0], nil]), nil);
+	STAssertEquals([b.ticks count], (NSUInteger)1, @"removed itself during the first tick");
+	
+	[clock removeObserver:a];
+	clock.paused = NO;
+}
+
+@end
@@ -0,0 +1,86 @@
+//
+//  TUIAssetPackTests.m
+//  TwUITests
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import <TwUI/TUIKit.h>
+#import "TUITestHelpers.h"
+
+@interface TUIAssetPackTests : SenTestCase
+{
+	NSURL *_directory;
+}
+@end
+
+@implementation TUIAssetPackTests
+
+- (void)setUp
+{
+	[super setUp];
+	NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSProcessInfo processInfo] globallyUniqueString]];
+	[[NSFileManager defaultManager] createDirectoryAtPath:path withIntermediateDirectories:YES attributes:nil error:NULL];
+	_directory = [NSURL fileURLWithPath:path isDirectory:YES];
+}
+
+- (void)tearDown
+{
+	[[NSFileManager defaultManager] removeItemAtURL:_directory error:NULL];
+	[super tearDown];
+}
+
+- (TUIAssetPack *)packWithImageSizes:(const CGSize *)sizes count:(NSUInteger)count
+{
+	NSMutableArray *imageURLs = [NSMutableArray array];
+	for(NSUInteger i = 0; i < count; ++i) {
+		NSURL *url = [_directory URLByAppendingPathComponent:[NSString stringWithFormat:@"image%lu.png", (unsigned long)i]];
+		[TUITestPNG(sizes[i].width, sizes[i].height) writeToURL:url atomically:NO];
+		[imageURLs addObject:url];
+	}
+	NSURL *packURL = [_directory URLByAppendingPathComponent:@"test.tuipack"];
+	if(![TUIAssetPack writePackToURL:packURL withImagesAtURLs:imageURLs])
+		return nil;
+	return [[TUIAssetPack alloc] initWithContentsOfURL:packURL];
+}
+
+- (void)testRoundTrip
+{
+	CGSize sizes[] = {{7, 3}, {64, 64}};
+	TUIAssetPack *pack = [self packWithImageSizes:sizes count:2];
+	STAssertNotNil(pack, nil);
+	STAssertEquals([pack.imageNames count], (NSUInteger)2, nil);
+	
+	TUIImage *image = [pack imageNamed:@"image0.png"];
+	STAssertEquals(image.size, CGSizeMake(7, 3), nil);
+	STAssertEquals([pack imageNamed:@"image1.png"].size, CGSizeMake(64, 64), nil);
+	STAssertNil([pack imageNamed:@"missing.png"], nil);
+}
+
+- (void)testImagesAreTaggedSRGB
+{
+	CGSize size = {8, 8};
+	TUIAssetPack *pack = [self packWithImageSizes:&size count:1];
+	CGImageRef image = [pack imageNamed:@"image0.png"].CGImage;
+	
+	CGColorSpaceRef sRGB = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+	CFDataRef expected = CGColorSpaceCopyICCProfile(sRGB);
+	CFDataRef tagged = CGColorSpaceCopyICCProfile(CGImageGetColorSpace(image));
+	STAssertTrue(expected && tagged && CFEqual(expected, tagged), @"packed in sRGB whatever the screen");
+	if(expected)
+		CFRelease(expected);
+	if(tagged)
+		CFRelease(tagged);
+	CGColorSpaceRelease(sRGB);
+	
+	// drawn straight from the mapped pages, not converted into a copy
+	STAssertEquals(CGImageGetBytesPerRow(image) % 64, (size_t)0, nil);
+}
+
+- (void)testRejectsOtherFiles
+{
+	NSURL *url = [_directory URLByAppendingPathComponent:@"bogus.tuipack"];
+	[TUITestPNG(4, 4) writeToURL:url atomically:NO];
+	STAssertNil([[TUIAssetPack alloc] initWithContentsOfURL:url], nil);
+}
+
+@end
@@ -0,0 +1,139 @@
+//
+//  TUIDebugOverlayTests.m
+//  TwUITests
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import <TwUI/TUIKit.h>
+
+#define Threshold (4 * 1024 * 1024)
+#define HeatMax (1.0 / 60.0)
+
+@interface TUIDebugOverlayTests : SenTestCase
+@end
+
+@implementation TUIDebugOverlayTests
+
+static TUIDebugOverlayDraw TestDraw(CGRect bounds)
+{
+	TUIDebugOverlayDraw draw;
+	memset(&draw, 0, sizeof(draw));
+	draw.bounds = bounds;
+	draw.dirtyRect = bounds;
+	draw.scale = 1.0;
+	draw.opaque = YES;
+	return draw;
+}
+
+- (void)testOptionsFromString
+{
+	STAssertEquals([TUIDebugOverlay optionsFromString:@"redraw"], (TUIDebugOverlayOptions)TUIDebugOverlayRedraw, nil);
+	STAssertEquals([TUIDebugOverlay optionsFromString:@" Blending , drawtime"], (TUIDebugOverlayOptions)(TUIDebugOverlayBlending | TUIDebugOverlayDrawTime), @"names are trimmed and case insensitive");
+	STAssertEquals([TUIDebugOverlay optionsFromString:@"backingstore,bogus,background"], (TUIDebugOverlayOptions)(TUIDebugOverlayLargeBackingStore | TUIDebugOverlayBackgroundDrawing), @"unknown names are ignored");
+	STAssertEquals([TUIDebugOverlay optionsFromString:@"all"], (TUIDebugOverlayOptions)TUIDebugOverlayAll, nil);
+	STAssertEquals([TUIDebugOverlay optionsFromString:@""], (TUIDebugOverlayOptions)TUIDebugOverlayNone, nil);
+}
+
+- (void)testSetOptionsMasksUnknownBits
+{
+	TUIDebugOverlayOptions old = [TUIDebugOverlay options];
+	[TUIDebugOverlay setOptions:TUIDebugOverlayBlending | (1 << 10)];
+	STAssertEquals([TUIDebugOverlay options], (TUIDebugOverlayOptions)TUIDebugOverlayBlending, nil);
+	STAssertEquals(TUIDebugOverlays, (TUIDebugOverlayOptions)TUIDebugOverlayBlending, nil);
+	[TUIDebugOverlay setOptions:old];
+}
+
+- (void)testNoOptionsOrEmptyViewPlansNothing
+{
+	TUIDebugOverlayPlan plan = TUIDebugOverlayPlanForDraw(TUIDebugOverlayNone, TestDraw(CGRectMake(0, 0, 100, 100)), Threshold, HeatMax);
+	STAssertEquals(plan.count, (NSUInteger)0, nil);
+	plan = TUIDebugOverlayPlanForDraw(TUIDebugOverlayAll, TestDraw(CGRectZero), Threshold, HeatMax);
+	STAssertEquals(plan.count, (NSUInteger)0, nil);
+}
+
+- (void)testBlending
+{
+	TUIDebugOverlayDraw draw = TestDraw(CGRectMake(0, 0, 100, 50));
+	TUIDebugOverlayPlan plan = TUIDebugOverlayPlanForDraw(TUIDebugOverlayBlending, draw, Threshold, HeatMax);
+	STAssertEquals(plan.count, (NSUInteger)1, nil);
+	STAssertEquals(plan.items[0].kind, (TUIDebugOverlayItemKind)TUIDebugOverlayItemFill, nil);
+	STAssertTrue(CGRectEqualToRect(plan.items[0].rect, draw.bounds), nil);
+	STAssertTrue(plan.items[0].color[1] == 1.0 && plan.items[0].color[0] == 0.0, @"opaque is green");
+	
+	draw.opaque = NO;
+	plan = TUIDebugOverlayPlanForDraw(TUIDebugOverlayBlending, draw, Threshold, HeatMax);
+	STAssertTrue(plan.items[0].color[0] == 1.0 && plan.items[0].color[1] == 0.0, @"blended is red");
+}
+
+- (void)testDrawTimeHeatMap
+{
+	TUIDebugOverlayDraw draw = TestDraw(CGRectMake(0, 0, 10, 10));
+	draw.drawTime = 0.0;
+	TUIDebugOverlayPlan fast = TUIDebugOverlayPlanForDraw(TUIDebugOverlayDrawTime, draw, Threshold, HeatMax);
+	draw.drawTime = HeatMax / 2;
+	TUIDebugOverlayPlan middle = TUIDebugOverlayPlanForDraw(TUIDebugOverlayDrawTime, draw, Threshold, HeatMax);
+	draw.drawTime = HeatMax * 10;
+	TUIDebugOverlayPlan slow = TUIDebugOverlayPlanForDraw(TUIDebugOverlayDrawTime, draw, Threshold, HeatMax);
+	
+	STAssertEqualsWithAccuracy(fast.items[0].color[1], (CGFloat)1.0, 1e-6, @"fast is yellow");
+	STAssertEqualsWithAccuracy(middle.items[0].color[1], (CGFloat)0.5, 1e-6, nil);
+	STAssertEqualsWithAccuracy(slow.items[0].color[1], (CGFloat)0.0, 1e-6, @"clamped at full red");
+	STAssertTrue(fast.items[0].color[3] < middle.items[0].color[3] && middle.items[0].color[3] < slow.items[0].color[3], @"slower is more opaque");
+}
+
+- (void)testLargeBackingStore
+{
+	STAssertEquals(TUIDebugOverlayBackingStoreSize(CGRectMake(0, 0, 100.5, 10), 2.0), (size_t)(201 * 20 * 4), nil);
+	
+	TUIDebugOverlayDraw draw = TestDraw(CGRectMake(0, 0, 1024, 1024)); // exactly 4MB, not over
+	TUIDebugOverlayPlan plan = TUIDebugOverlayPlanForDraw(TUIDebugOverlayLargeBackingStore, draw, Threshold, HeatMax);
+	STAssertEquals(plan.count, (NSUInteger)0, nil);
+	
+	draw.scale = 2.0;
+	plan = TUIDebugOverlayPlanForDraw(TUIDebugOverlayLargeBackingStore, draw, Threshold, HeatMax);
+	STAssertEquals(plan.count, (NSUInteger)1, nil);
+	STAssertEquals(plan.items[0].kind, (TUIDebugOverlayItemKind)TUIDebugOverlayItemStroke, nil);
+	STAssertEquals(plan.items[0].lineWidth, (CGFloat)2.0, nil);
+	STAssertTrue(CGRectEqualToRect(plan.items[0].rect, CGRectMake(1, 1, 1022, 1022)), @"inset so the stroke isn't clipped");
+}
+
+- (void)testBackgroundMarker
+{
+	TUIDebugOverlayDraw draw = TestDraw(CGRectMake(0, 0, 100, 4));
+	TUIDebugOverlayPlan plan = TUIDebugOverlayPlanForDraw(TUIDebugOverlayBackgroundDrawing, draw, Threshold, HeatMax);
+	STAssertEquals(plan.count, (NSUInteger)0, @"drawn on the main thread");
+	
+	draw.drawnInBackground = YES;
+	plan = TUIDebugOverlayPlanForDraw(TUIDebugOverlayBackgroundDrawing, draw, Threshold, HeatMax);
+	STAssertEquals(plan.count, (NSUInteger)1, nil);
+	STAssertTrue(CGRectEqualToRect(plan.items[0].rect, CGRectMake(0, 0, 4, 4)), @"marker shrinks to fit, top left");
+}
+
+- (void)testRedrawFlashIsClippedToBounds
+{
+	TUIDebugOverlayDraw draw = TestDraw(CGRectMake(0, 0, 100, 100));
+	draw.dirtyRect = CGRectMake(50, 50, 100, 100);
+	TUIDebugOverlayPlan plan = TUIDebugOverlayPlanForDraw(TUIDebugOverlayRedraw, draw, Threshold, HeatMax);
+	STAssertEquals(plan.count, (NSUInteger)1, nil);
+	STAssertEquals(plan.items[0].kind, (TUIDebugOverlayItemKind)TUIDebugOverlayItemFlash, nil);
+	STAssertTrue(CGRectEqualToRect(plan.items[0].rect, CGRectMake(50, 50, 50, 50)), nil);
+	
+	draw.dirtyRect = CGRectMake(200, 200, 10, 10);
+	plan = TUIDebugOverlayPlanForDraw(TUIDebugOverlayRedraw, draw, Threshold, HeatMax);
+	STAssertEquals(plan.count, (NSUInteger)0, @"nothing visible was redrawn");
+}
+
+- (void)testAllOptionsOrderBottomToTop
+{
+	TUIDebugOverlayDraw draw = TestDraw(CGRectMake(0, 0, 2048, 2048));
+	draw.drawnInBackground = YES;
+	TUIDebugOverlayPlan plan = TUIDebugOverlayPlanForDraw(TUIDebugOverlayAll, draw, Threshold, HeatMax);
+	STAssertEquals(plan.count, (NSUInteger)TUIDebugOverlayMaximumItems, nil);
+	STAssertEquals(plan.items[0].kind, (TUIDebugOverlayItemKind)TUIDebugOverlayItemFill, @"blending");
+	STAssertEquals(plan.items[1].kind, (TUIDebugOverlayItemKind)TUIDebugOverlayItemFill, @"draw time");
+	STAssertEquals(plan.items[2].kind, (TUIDebugOverlayItemKind)TUIDebugOverlayItemStroke, @"backing store");
+	STAssertEquals(plan.items[3].kind, (TUIDebugOverlayItemKind)TUIDebugOverlayItemFill, @"background marker");
+	STAssertEquals(plan.items[4].kind, (TUIDebugOverlayItemKind)TUIDebugOverlayItemFlash, @"redraw flash on top");
+}
+
+@end
@@ -0,0 +1,61 @@
+//
+//  TUIDisplayListTests.m
+//  TwUITests
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import <TwUI/TUIKit.h>
+
+@interface TUIDisplayListTests : SenTestCase
+@end
+
+@implementation TUIDisplayListTests
+
+// alpha of the pixel at 'point', bottom left origin like the views
+static uint8_t AlphaAtPoint(TUIImage *image, CGPoint point)
+{
+	uint8_t alpha = 0;
+	CGContextRef ctx = CGBitmapContextCreate(&alpha, 1, 1, 8, 1, NULL, kCGImageAlphaOnly);
+	CGImageRef cgImage = image.CGImage;
+	CGContextDrawImage(ctx, CGRectMake(-point.x, -point.y, CGImageGetWidth(cgImage), CGImageGetHeight(cgImage)), cgImage);
+	CGContextRelease(ctx);
+	return alpha;
+}
+
+- (TUIView *)viewWithSquare:(TUIView **)outSquare
+{
+	TUIView *view = [[TUIView alloc] initWithFrame:CGRectMake(0, 0, 100, 100)];
+	view.backgroundColor = [TUIColor clearColor];
+	TUIView *square = [[TUIView alloc] initWithFrame:CGRectMake(40, 40, 20, 20)];
+	square.backgroundColor = [TUIColor redColor];
+	[view addSubview:square];
+	*outSquare = square;
+	return view;
+}
+
+- (void)testRecordsFrames
+{
+	TUIView *square = nil;
+	TUIView *view = [self viewWithSquare:&square];
+	TUIImage *image = [[TUIDisplayList displayListWithView:view] imageOfPage:0 scale:1];
+	STAssertEquals(AlphaAtPoint(image, CGPointMake(50, 50)), (uint8_t)255, nil);
+	STAssertEquals(AlphaAtPoint(image, CGPointMake(35, 50)), (uint8_t)0, nil);
+}
+
+- (void)testRecordsTransforms
+{
+	TUIView *square = nil;
+	TUIView *view = [self viewWithSquare:&square];
+	square.transform = CGAffineTransformMakeScale(2, 2); // about its centre, now covering 30...70
+	TUIImage *image = [[TUIDisplayList displayListWithView:view] imageOfPage:0 scale:1];
+	STAssertEquals(AlphaAtPoint(image, CGPointMake(35, 50)), (uint8_t)255, nil);
+	STAssertEquals(AlphaAtPoint(image, CGPointMake(50, 65)), (uint8_t)255, nil);
+	STAssertEquals(AlphaAtPoint(image, CGPointMake(25, 50)), (uint8_t)0, nil);
+	
+	square.transform = CGAffineTransformMakeTranslation(30, 0); // 70...90 across
+	image = [[TUIDisplayList displayListWithView:view] imageOfPage:0 scale:1];
+	STAssertEquals(AlphaAtPoint(image, CGPointMake(50, 50)), (uint8_t)0, nil);
+	STAssertEquals(AlphaAtPoint(image, CGPointMake(80, 50)), (uint8_t)255, nil);
+}
+
+@end
@@ -0,0 +1,101 @@
+//
+//  TUIEventTraceTests.m
+//  TwUITests
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import <TwUI/TUIKit.h>
+
+@interface TUIEventTraceTests : SenTestCase
+@end
+
+@implementation TUIEventTraceTests
+
+static NSDictionary *Event(NSTimeInterval t, NSEventType type)
+{
+	return [NSDictionary dictionaryWithObjectsAndKeys:
+			[NSNumber numberWithDouble:t], @"t",
+			[NSNumber numberWithUnsignedInteger:type], @"type",
+			[NSNumber numberWithDouble:10.5], @"x",
+			[NSNumber numberWithDouble:20.0], @"y",
+			nil];
+}
+
+- (void)testRoundTrip
+{
+	NSMutableDictionary *scroll = [Event(0.25, NSScrollWheel) mutableCopy];
+	[scroll setObject:[NSNumber numberWithBool:YES] forKey:@"continuous"];
+	[scroll setObject:[NSNumber numberWithDouble:-3.5] forKey:@"pointDeltaY"];
+	[scroll setObject:[NSNumber numberWithUnsignedInteger:1] forKey:@"phase"];
+	NSArray *events = [NSArray arrayWithObjects:Event(0.0, NSLeftMouseDown), Event(0.1, NSLeftMouseUp), scroll, nil];
+	
+	TUIEventTrace *trace = [[TUIEventTrace alloc] initWithEvents:events];
+	TUIEventTrace *read = [[TUIEventTrace alloc] initWithData:trace.data];
+	STAssertNotNil(read, nil);
+	STAssertEqualObjects(read.events, events, nil);
+	
+	TUIEventReplayer *replayer = [[TUIEventReplayer alloc] initWithTrace:trace.data];
+	STAssertEqualObjects(replayer.events, events, nil);
+}
+
+- (void)testRejectsUnreadableTraces
+{
+	STAssertNil([[TUIEventTrace alloc] initWithData:nil], nil);
+	STAssertNil([[TUIEventTrace alloc] initWithData:[@"not a trace" dataUsingEncoding:NSUTF8StringEncoding]], nil);
+	
+	NSDictionary *future = [NSDictionary dictionaryWithObjectsAndKeys:[NSNumber numberWithInteger:2], @"version", [NSArray array], @"events", nil];
+	NSData *data = [NSPropertyListSerialization dataWithPropertyList:future format:NSPropertyListXMLFormat_v1_0 options:0 error:NULL];
+	STAssertNil([[TUIEventTrace alloc] initWithData:data], @"another version");
+	STAssertNil([[TUIEventReplayer alloc] initWithTrace:data], nil);
+}
+
+- (void)testEmptyRecorderTrace
+{
+	TUIEventRecorder *recorder = [[TUIEventRecorder alloc] init];
+	TUIEventTrace *trace = [[TUIEventTrace alloc] initWithData:[recorder traceData]];
+	STAssertNotNil(trace, nil);
+	STAssertEquals([trace.events count], (NSUInteger)0, nil);
+}
+
+// the schedule as a string: "f1" for frame 1, "e0.02" for an event at 0.02s
+- (NSString *)scheduleOfTrace:(TUIEventTrace *)trace interval:(NSTimeInterval)interval trailing:(NSUInteger)trailing duration:(NSTimeInterval *)duration
+{
+	NSMutableArray *steps = [NSMutableArray array];
+	NSTimeInterval d = [trace scheduleWithFrameInterval:interval trailingFrameCount:trailing frameHandler:^(NSUInteger frame, NSTimeInterval time) {
+		STAssertEqualsWithAccuracy(time, frame * interval, 1e-9, nil);
+		[steps addObject:[NSString stringWithFormat:@"f%lu", (unsigned long)frame]];
+	} eventHandler:^(NSDictionary *event, NSTimeInterval time) {
+		[steps addObject:[NSString stringWithFormat:@"e%g", time]];
+	}];
+	if(duration)
+		*duration = d;
+	return [steps componentsJoinedByString:@" "];
+}
+
+- (void)testScheduleInterleavesFramesAndEvents
+{
+	NSArray *events = [NSArray arrayWithObjects:Event(0.0, NSMouseMoved), Event(0.05, NSMouseMoved), Event(0.1, NSMouseMoved), Event(0.1, NSMouseMoved), Event(0.35, NSMouseMoved), nil];
+	TUIEventTrace *trace = [[TUIEventTrace alloc] initWithEvents:events];
+	NSTimeInterval duration = 0;
+	
+	// an event on a frame boundary comes after that frame
+	NSString *schedule = [self scheduleOfTrace:trace interval:0.1 trailing:2 duration:&duration];
+	STAssertEqualObjects(schedule, @"e0 e0.05 f1 e0.1 e0.1 f2 f3 e0.35 f4 f5", nil);
+	STAssertEqualsWithAccuracy(duration, 0.5, 1e-9, nil);
+	
+	// the same on every run, however long handling takes
+	STAssertEqualObjects([self scheduleOfTrace:trace interval:0.1 trailing:2 duration:NULL], schedule, nil);
+}
+
+- (void)testScheduleTrailingFramesOnly
+{
+	TUIEventTrace *trace = [[TUIEventTrace alloc] initWithEvents:nil];
+	NSTimeInterval duration = 0;
+	STAssertEqualObjects([self scheduleOfTrace:trace interval:0.25 trailing:3 duration:&duration], @"f1 f2 f3", nil);
+	STAssertEqualsWithAccuracy(duration, 0.75, 1e-9, nil);
+	
+	STAssertEqualObjects([self scheduleOfTrace:trace interval:0.25 trailing:0 duration:&duration], @"", nil);
+	STAssertEquals(duration, 0.0, nil);
+}
+
+@end
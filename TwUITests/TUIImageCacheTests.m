@@ -0,0 +1,78 @@
+//
+//  TUIImageCacheTests.m
+//  TwUITests
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import <TwUI/TUIKit.h>
+#import "TUITestHelpers.h"
+
+@interface TUIImageCacheTests : SenTestCase
+@end
+
+@implementation TUIImageCacheTests
+
+- (void)testEvictsLeastRecentlyUsed
+{
+	TUIImageCache *cache = [[TUIImageCache alloc] initWithTotalCostLimit:300];
+	TUIImage *image = TUITestImage(1, 1);
+	[cache setImage:image forKey:@"a" cost:100];
+	[cache setImage:image forKey:@"b" cost:100];
+	[cache setImage:image forKey:@"c" cost:100];
+	
+	STAssertNotNil([cache imageForKey:@"a"], @"a is now most recently used");
+	[cache setImage:image forKey:@"d" cost:100];
+	
+	STAssertNil([cache imageForKey:@"b"], @"b was least recently used");
+	STAssertNotNil([cache imageForKey:@"a"], nil);
+	STAssertNotNil([cache imageForKey:@"c"], nil);
+	STAssertNotNil([cache imageForKey:@"d"], nil);
+	STAssertEquals(cache.count, (NSUInteger)3, nil);
+}
+
+- (void)testByteBudget
+{
+	TUIImageCache *cache = [[TUIImageCache alloc] initWithTotalCostLimit:1000];
+	TUIImage *image = TUITestImage(1, 1);
+	[cache setImage:image forKey:@"a" cost:400];
+	[cache setImage:image forKey:@"b" cost:400];
+	STAssertEquals(cache.totalCost, (NSUInteger)800, nil);
+	
+	[cache setImage:image forKey:@"c" cost:400]; // evicts a
+	STAssertEquals(cache.totalCost, (NSUInteger)800, nil);
+	STAssertNil([cache imageForKey:@"a"], nil);
+	
+	[cache setImage:image forKey:@"huge" cost:1001]; // larger than the whole budget, not cached
+	STAssertNil([cache imageForKey:@"huge"], nil);
+	STAssertEquals(cache.totalCost, (NSUInteger)800, nil);
+	
+	[cache setImage:image forKey:@"b" cost:100]; // replacing an entry replaces its cost
+	STAssertEquals(cache.totalCost, (NSUInteger)500, nil);
+	
+	cache.totalCostLimit = 200;
+	STAssertTrue(cache.totalCost <= 200, nil);
+	STAssertNotNil([cache imageForKey:@"b"], @"most recently used survives the trim");
+}
+
+- (void)testDefaultCostIsDecodedSize
+{
+	TUIImageCache *cache = [[TUIImageCache alloc] initWithTotalCostLimit:1024 * 1024];
+	TUIImage *image = TUITestImage(16, 8);
+	[cache setImage:image forKey:@"a"];
+	STAssertEquals(cache.totalCost, TUIImageDecodedByteCount(image), nil);
+	STAssertTrue(cache.totalCost >= 16 * 8 * 4, nil);
+}
+
+- (void)testStatistics
+{
+	TUIImageCache *cache = [[TUIImageCache alloc] init];
+	[cache setImage:TUITestImage(1, 1) forKey:@"a"];
+	[cache imageForKey:@"a"];
+	[cache imageForKey:@"b"];
+	STAssertEquals(cache.hitCount, (NSUInteger)1, nil);
+	STAssertEquals(cache.missCount, (NSUInteger)1, nil);
+	[cache resetStatistics];
+	STAssertEquals(cache.hitCount, (NSUInteger)0, nil);
+}
+
+@end
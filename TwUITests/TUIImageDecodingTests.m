@@ -0,0 +1,92 @@
+//
+//  TUIImageDecodingTests.m
+//  TwUITests
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import <TwUI/TUIKit.h>
+#import "TUITestHelpers.h"
+
+@interface TUIImageDecodingTests : SenTestCase
+@end
+
+@implementation TUIImageDecodingTests
+
+- (void)testDecodedImageIsDisplayReady
+{
+	TUIImage *image = [TUIImage decodedImageWithData:TUITestPNG(24, 16)];
+	CGImageRef i = image.CGImage;
+	STAssertTrue(i != NULL, nil);
+	STAssertEquals(CGImageGetWidth(i), (size_t)24, nil);
+	STAssertEquals(CGImageGetHeight(i), (size_t)16, nil);
+	STAssertEquals(CGImageGetBitsPerPixel(i), (size_t)32, nil);
+	STAssertEquals(CGImageGetBitmapInfo(i) & kCGBitmapByteOrderMask, (CGBitmapInfo)kCGBitmapByteOrder32Host, nil);
+	STAssertEquals(CGImageGetAlphaInfo(i), kCGImageAlphaPremultipliedFirst, nil);
+	STAssertEquals(CGImageGetBytesPerRow(i) % 64, (size_t)0, @"rows aligned for Core Animation");
+	STAssertTrue(CFEqual(CGImageGetColorSpace(i), TUIGetBackingColorSpace()), @"converted to the backing colour space");
+	
+	STAssertTrue([image decodedImage] == image, @"already display ready");
+}
+
+- (void)testDecodedImageKeepsStretchableCaps
+{
+	TUIImage *image = [[TUIImage imageWithData:TUITestPNG(24, 16)] stretchableImageWithLeftCapWidth:4 topCapHeight:5];
+	TUIImage *decoded = [image decodedImage];
+	STAssertTrue(decoded != image, @"the PNG wasn't display ready");
+	STAssertEquals(decoded.leftCapWidth, (NSInteger)4, nil);
+	STAssertEquals(decoded.topCapHeight, (NSInteger)5, nil);
+}
+
+- (void)testMaxPixelSize
+{
+	NSData *data = TUITestPNG(24, 16);
+	TUIImage *image = [TUIImage imageWithData:data maxPixelSize:12];
+	STAssertEquals(CGImageGetWidth(image.CGImage), (size_t)12, nil);
+	STAssertEquals(CGImageGetHeight(image.CGImage), (size_t)8, @"aspect ratio kept");
+	
+	image = [TUIImage imageWithData:data maxPixelSize:100];
+	STAssertEquals(CGImageGetWidth(image.CGImage), (size_t)24, @"never scaled up");
+}
+
+- (void)testAsyncDecodeSharesOneDecodeAndCaches
+{
+	NSString *key = [[NSProcessInfo processInfo] globallyUniqueString];
+	NSData *data = TUITestPNG(24, 16);
+	NSMutableArray *results = [NSMutableArray array];
+	TUIImageDecodeCompletion completion = ^(TUIImage *image) {
+		STAssertTrue([NSThread isMainThread], nil);
+		[results addObject:image ? (id)image : (id)[NSNull null]];
+	};
+	[TUIImage decodeImageWithData:data key:key completion:completion];
+	[TUIImage decodeImageWithData:data key:key completion:completion];
+	
+	STAssertTrue(TUITestWaitFor(^{ return (BOOL)([results count] == 2); }), @"completions weren't called");
+	STAssertTrue([[results objectAtIndex:0] isKindOfClass:[TUIImage class]], nil);
+	STAssertTrue([results objectAtIndex:0] == [results objectAtIndex:1], @"concurrent requests share the decode");
+	STAssertTrue([[TUIImageCache sharedCache] imageForKey:key] == [results objectAtIndex:0], nil);
+	
+	// cached now, still called back asynchronously
+	__block TUIImage *cached = nil;
+	[TUIImage decodeImageWithData:data key:key completion:^(TUIImage *image) {
+		cached = image;
+	}];
+	STAssertNil(cached, nil);
+	STAssertTrue(TUITestWaitFor(^{ return (BOOL)(cached != nil); }), nil);
+	STAssertTrue(cached == [results objectAtIndex:0], nil);
+	
+	[[TUIImageCache sharedCache] removeImageForKey:key];
+}
+
+- (void)testAsyncDecodeOfBadData
+{
+	__block BOOL called = NO;
+	__block TUIImage *result = nil;
+	[TUIImage decodeImageWithData:[@"not an image" dataUsingEncoding:NSUTF8StringEncoding] key:nil completion:^(TUIImage *image) {
+		called = YES;
+		result = image;
+	}];
+	STAssertTrue(TUITestWaitFor(^{ return called; }), nil);
+	STAssertNil(result, nil);
+}
+
+@end
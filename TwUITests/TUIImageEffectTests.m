@@ -0,0 +1,88 @@
+//
+//  TUIImageEffectTests.m
+//  TwUITests
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import <TwUI/TUIKit.h>
+#import "TUITestHelpers.h"
+
+@interface TUIImageEffectTests : SenTestCase
+@end
+
+@implementation TUIImageEffectTests
+
+- (void)setUp
+{
+	[super setUp];
+	[[TUIImageEffect cache] removeAllImages];
+}
+
+- (TUIImageEffect *)effectWithKey:(NSString *)key
+{
+	return [[[TUIImageEffect effectWithImage:TUITestImage(32, 32) key:key] roundImage:4] pad:2];
+}
+
+- (void)testEqualChainsShareTheCacheKey
+{
+	STAssertEqualObjects([self effectWithKey:@"a"].cacheKey, [self effectWithKey:@"a"].cacheKey, nil);
+	STAssertFalse([[self effectWithKey:@"a"].cacheKey isEqual:[self effectWithKey:@"b"].cacheKey], nil);
+	STAssertFalse([[self effectWithKey:@"a"].cacheKey isEqual:[[self effectWithKey:@"a"] effectWithScale:2].cacheKey], nil);
+	STAssertNil([self effectWithKey:nil].cacheKey, nil);
+}
+
+- (void)testRendersOncePerUniqueChain
+{
+	TUIImage *first = [[self effectWithKey:@"once"] render];
+	STAssertNotNil(first, nil);
+	
+	// a separately built, equal chain gets the first render back
+	STAssertTrue([[self effectWithKey:@"once"] cachedImage] == first, nil);
+	STAssertTrue([[self effectWithKey:@"once"] render] == first, nil);
+	STAssertEquals([TUIImageEffect cache].count, (NSUInteger)1, nil);
+	
+	[[self effectWithKey:@"other"] render];
+	STAssertEquals([TUIImageEffect cache].count, (NSUInteger)2, nil);
+}
+
+- (void)testConcurrentRendersOfOneChainShareTheResult
+{
+	NSMutableArray *results = [NSMutableArray array];
+	for(int i = 0; i < 4; ++i) {
+		[[self effectWithKey:@"concurrent"] renderWithCompletion:^(TUIImage *image) {
+			[results addObject:image ? (id)image : (id)[NSNull null]];
+		}];
+	}
+	STAssertTrue(TUITestWaitFor(^{ return (BOOL)([results count] == 4); }), nil);
+	
+	TUIImage *rendered = [results objectAtIndex:0];
+	STAssertTrue([rendered isKindOfClass:[TUIImage class]], nil);
+	for(id result in results)
+		STAssertTrue(result == rendered, @"every request got the one render");
+	STAssertTrue([[self effectWithKey:@"concurrent"] cachedImage] == rendered, nil);
+}
+
+- (void)testColorKeyIncludesTheColorSpace
+{
+	CGFloat components[] = {0.5, 0.25, 0.75, 1.0};
+	CGColorSpaceRef sRGB = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+	CGColorSpaceRef generic = CGColorSpaceCreateWithName(kCGColorSpaceGenericRGB);
+	CGColorRef a = CGColorCreate(sRGB, components);
+	CGColorRef b = CGColorCreate(generic, components);
+	TUIColor *black = [TUIColor colorWithWhite:0 alpha:1];
+	
+	// same model and components, different colours
+	TUIImageEffect *e = [TUIImageEffect effectWithImage:TUITestImage(8, 8) key:@"shadow"];
+	NSString *keyA = [e innerShadowWithOffset:CGSizeZero radius:1 color:black backgroundColor:[TUIColor colorWithCGColor:a]].cacheKey;
+	NSString *keyB = [e innerShadowWithOffset:CGSizeZero radius:1 color:black backgroundColor:[TUIColor colorWithCGColor:b]].cacheKey;
+	NSString *keyA2 = [e innerShadowWithOffset:CGSizeZero radius:1 color:black backgroundColor:[TUIColor colorWithCGColor:a]].cacheKey;
+	STAssertFalse([keyA isEqual:keyB], nil);
+	STAssertEqualObjects(keyA, keyA2, nil);
+	
+	CGColorRelease(a);
+	CGColorRelease(b);
+	CGColorSpaceRelease(sRGB);
+	CGColorSpaceRelease(generic);
+}
+
+@end
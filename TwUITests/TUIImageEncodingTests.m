@@ -0,0 +1,100 @@
+//
+//  TUIImageEncodingTests.m
+//  TwUITests
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import <TwUI/TUIKit.h>
+#import <TwUI/TUIImage+Encoding.h>
+
+@interface TUIImageEncodingTests : SenTestCase
+@end
+
+@implementation TUIImageEncodingTests
+
+// 8x8 with an alpha channel, every pixel opaque or not
+- (TUIImage *)imageInColorSpace:(CGColorSpaceRef)colorSpace opaque:(BOOL)opaque
+{
+	CGContextRef ctx = CGBitmapContextCreate(NULL, 8, 8, 8, 0, colorSpace, kCGBitmapByteOrder32Host | kCGImageAlphaPremultipliedFirst);
+	CGContextSetRGBFillColor(ctx, 0.2, 0.6, 0.4, opaque ? 1.0 : 0.5);
+	CGContextFillRect(ctx, CGRectMake(0, 0, 8, 8));
+	CGImageRef cgImage = CGBitmapContextCreateImage(ctx);
+	TUIImage *image = [TUIImage imageWithCGImage:cgImage];
+	CGImageRelease(cgImage);
+	CGContextRelease(ctx);
+	return image;
+}
+
+- (CGImageRef)newDecodedImage:(NSData *)data
+{
+	CGImageSourceRef source = CGImageSourceCreateWithData((__bridge CFDataRef)data, NULL);
+	CGImageRef image = source ? CGImageSourceCreateImageAtIndex(source, 0, NULL) : NULL;
+	if(source)
+		CFRelease(source);
+	return image;
+}
+
+- (BOOL)hasAlpha:(CGImageRef)image
+{
+	CGImageAlphaInfo alpha = CGImageGetAlphaInfo(image);
+	return !(alpha == kCGImageAlphaNone || alpha == kCGImageAlphaNoneSkipFirst || alpha == kCGImageAlphaNoneSkipLast);
+}
+
+- (void)testSmallPNGDropsTheAlphaOfOpaqueImages
+{
+	CGColorSpaceRef sRGB = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+	NSData *opaque = [[self imageInColorSpace:sRGB opaque:YES] encodedDataWithType:(NSString *)kUTTypePNG quality:1 options:TUIImageEncodingSmall];
+	NSData *translucent = [[self imageInColorSpace:sRGB opaque:NO] encodedDataWithType:(NSString *)kUTTypePNG quality:1 options:TUIImageEncodingSmall];
+	NSData *asIs = [[self imageInColorSpace:sRGB opaque:YES] encodedDataWithType:(NSString *)kUTTypePNG quality:1 options:TUIImageEncodingDefault];
+	CGColorSpaceRelease(sRGB);
+	
+	CGImageRef decoded = [self newDecodedImage:opaque];
+	STAssertTrue(decoded != NULL, nil);
+	STAssertFalse([self hasAlpha:decoded], nil);
+	CGImageRelease(decoded);
+	
+	decoded = [self newDecodedImage:translucent];
+	STAssertTrue([self hasAlpha:decoded], @"translucent images keep their alpha");
+	CGImageRelease(decoded);
+	
+	decoded = [self newDecodedImage:asIs];
+	STAssertTrue([self hasAlpha:decoded], @"the default writes the image as it is");
+	CGImageRelease(decoded);
+}
+
+- (void)testSmallPNGKeepsTheColorSpace
+{
+	CGColorSpaceRef generic = CGColorSpaceCreateWithName(kCGColorSpaceGenericRGB);
+	NSData *data = [[self imageInColorSpace:generic opaque:YES] encodedDataWithType:(NSString *)kUTTypePNG quality:1 options:TUIImageEncodingSmall];
+	CGImageRef decoded = [self newDecodedImage:data];
+	STAssertFalse([self hasAlpha:decoded], nil);
+	
+	CFDataRef expected = CGColorSpaceCopyICCProfile(generic);
+	CFDataRef written = CGColorSpaceCopyICCProfile(CGImageGetColorSpace(decoded));
+	STAssertTrue(expected && written && CFEqual(expected, written), @"the profile written is the image's own, not device RGB's");
+	if(expected)
+		CFRelease(expected);
+	if(written)
+		CFRelease(written);
+	CGImageRelease(decoded);
+	CGColorSpaceRelease(generic);
+}
+
+- (void)testProgressiveJPEGOnlyWhenSmall
+{
+	CGColorSpaceRef sRGB = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+	TUIImage *image = [self imageInColorSpace:sRGB opaque:YES];
+	CGColorSpaceRelease(sRGB);
+	
+	TUIImageEncodingOptions options[] = {TUIImageEncodingDefault, TUIImageEncodingSmall};
+	for(int i = 0; i < 2; ++i) {
+		NSData *data = [image encodedDataWithType:(NSString *)kUTTypeJPEG quality:0.8 options:options[i]];
+		CGImageSourceRef source = CGImageSourceCreateWithData((__bridge CFDataRef)data, NULL);
+		NSDictionary *properties = CFBridgingRelease(CGImageSourceCopyPropertiesAtIndex(source, 0, NULL));
+		CFRelease(source);
+		BOOL progressive = [[[properties objectForKey:(NSString *)kCGImagePropertyJFIFDictionary] objectForKey:(NSString *)kCGImagePropertyJFIFIsProgressive] boolValue];
+		STAssertEquals(progressive, (BOOL)(options[i] == TUIImageEncodingSmall), nil);
+	}
+}
+
+@end
@@ -0,0 +1,57 @@
+//
+//  TUIImageViewTests.m
+//  TwUITests
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import <TwUI/TUIKit.h>
+#import <TwUI/TUIView+Private.h>
+#import "TUITestHelpers.h"
+
+@interface TUIImageViewTests : SenTestCase
+@end
+
+@implementation TUIImageViewTests
+
+- (void)testDirectContentsDisplayCountsAFrame
+{
+	TUIImage *image = TUITestImage(4, 4);
+	TUIImageView *view = [[TUIImageView alloc] initWithImage:image];
+	NSUInteger before = [TUIView _displayCount];
+	
+	[view displayLayer:view.layer];
+	
+	STAssertEquals([TUIView _displayCount], before + 1, @"displays that don't draw are frames too");
+	STAssertTrue((__bridge CGImageRef)view.layer.contents == image.CGImage, @"the layer shows the image itself");
+}
+
+- (void)testDirectContentsDisplayIsProfiled
+{
+	BOOL wasEnabled = [TUIViewProfiler isEnabled];
+	[TUIViewProfiler setEnabled:YES];
+	[TUIViewProfiler reset];
+	
+	TUIImageView *view = [[TUIImageView alloc] initWithImage:TUITestImage(4, 4)];
+	[view displayLayer:view.layer];
+	
+	NSDictionary *kinds = [[TUIViewProfiler aggregates] objectForKey:NSStringFromClass([TUIImageView class])];
+	STAssertEquals([[[kinds objectForKey:@"display publish"] objectForKey:@"count"] unsignedIntegerValue], (NSUInteger)1, @"%@", kinds);
+	STAssertNil([kinds objectForKey:@"drawRect"], @"nothing was drawn");
+	
+	[TUIViewProfiler reset];
+	[TUIViewProfiler setEnabled:wasEnabled];
+}
+
+- (void)testDebugOverlaysWithoutAContextOnlyFlash
+{
+	TUIDebugOverlayOptions options = [TUIDebugOverlay options];
+	[TUIDebugOverlay setOptions:TUIDebugOverlayAll];
+	
+	TUIImageView *view = [[TUIImageView alloc] initWithImage:TUITestImage(4, 4)];
+	[view displayLayer:view.layer]; // must not paint into a NULL context
+	STAssertTrue((__bridge CGImageRef)view.layer.contents == view.image.CGImage, nil);
+	
+	[TUIDebugOverlay setOptions:options];
+}
+
+@end
@@ -0,0 +1,141 @@
+//
+//  TUIIncrementalImageDecoderTests.m
+//  TwUITests
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import <TwUI/TUIKit.h>
+#import "TUITestHelpers.h"
+
+@interface TUIIncrementalImageDecoderTests : SenTestCase
+{
+	NSMutableArray *updates; // @synchronized, the handler runs on the decoder's queue
+	BOOL finished;
+}
+@end
+
+@implementation TUIIncrementalImageDecoderTests
+
+// pixels drawn into a known format, to compare images regardless of how they're stored
+static NSData *RGBAData(CGImageRef image)
+{
+	size_t width = CGImageGetWidth(image), height = CGImageGetHeight(image);
+	NSMutableData *data = [NSMutableData dataWithLength:width * height * 4];
+	CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+	CGContextRef ctx = CGBitmapContextCreate([data mutableBytes], width, height, 8, width * 4, colorSpace, kCGImageAlphaPremultipliedLast);
+	CGColorSpaceRelease(colorSpace);
+	CGContextSetBlendMode(ctx, kCGBlendModeCopy);
+	CGContextDrawImage(ctx, CGRectMake(0, 0, width, height), image);
+	CGContextRelease(ctx);
+	return data;
+}
+
+- (void)setUp
+{
+	[super setUp];
+	updates = [NSMutableArray array];
+	finished = NO;
+}
+
+- (TUIIncrementalImageDecoder *)decoder
+{
+	TUIIncrementalImageDecoder *decoder = [[TUIIncrementalImageDecoder alloc] init];
+	NSMutableArray *u = updates;
+	__unsafe_unretained TUIIncrementalImageDecoderTests *test = self; // outlives the decoder's work, see -waitForFinish
+	decoder.updateHandler = ^(TUIImage *image, BOOL f) {
+		@synchronized(u) {
+			[u addObject:image ? (id)image : (id)[NSNull null]];
+			if(f)
+				test->finished = YES;
+		}
+	};
+	return decoder;
+}
+
+- (BOOL)waitForFinish
+{
+	NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:5.0];
+	while([deadline timeIntervalSinceNow] > 0) {
+		@synchronized(updates) {
+			if(finished)
+				return YES;
+		}
+		usleep(10000);
+	}
+	return NO;
+}
+
+- (NSArray *)updates
+{
+	@synchronized(updates) {
+		return [updates copy];
+	}
+}
+
+static void Feed(TUIIncrementalImageDecoder *decoder, NSData *data, NSUInteger chunkSize, useconds_t delay)
+{
+	for(NSUInteger offset = 0; offset < [data length]; offset += chunkSize) {
+		[decoder appendData:[data subdataWithRange:NSMakeRange(offset, MIN(chunkSize, [data length] - offset))]];
+		if(delay)
+			usleep(delay);
+	}
+}
+
+- (void)testStreamedImageFinishesComplete
+{
+	NSData *data = TUITestPNG(64, 64);
+	TUIIncrementalImageDecoder *decoder = [self decoder];
+	decoder.minimumUpdateInterval = 0.0;
+	Feed(decoder, data, [data length] / 8, 20000);
+	[decoder finish];
+	
+	STAssertTrue([self waitForFinish], nil);
+	NSArray *u = [self updates];
+	STAssertTrue([u count] >= 2, @"partial updates arrived before the final one: %lu", (unsigned long)[u count]);
+	
+	TUIImage *final = [u lastObject];
+	STAssertTrue([final isKindOfClass:[TUIImage class]], nil);
+	STAssertEquals(CGImageGetWidth(final.CGImage), (size_t)64, nil);
+	STAssertEquals(CGImageGetHeight(final.CGImage), (size_t)64, nil);
+	STAssertTrue(decoder.currentImage == final, nil);
+	
+	TUIImage *whole = [TUIImage decodedImageWithData:data];
+	STAssertEqualObjects(RGBAData(final.CGImage), RGBAData(whole.CGImage), @"same pixels as decoding it in one go");
+}
+
+- (void)testUpdatesAreThrottled
+{
+	NSData *data = TUITestPNG(64, 64);
+	TUIIncrementalImageDecoder *decoder = [self decoder];
+	decoder.minimumUpdateInterval = 10.0;
+	Feed(decoder, data, 256, 1000);
+	[decoder finish];
+	
+	STAssertTrue([self waitForFinish], nil);
+	STAssertTrue([[self updates] count] <= 2, @"at most one update in the interval, then the final one: %lu", (unsigned long)[[self updates] count]);
+}
+
+- (void)testDataThatIsNotAnImage
+{
+	TUIIncrementalImageDecoder *decoder = [self decoder];
+	[decoder appendData:[@"not an image" dataUsingEncoding:NSUTF8StringEncoding]];
+	[decoder finish];
+	
+	STAssertTrue([self waitForFinish], nil);
+	STAssertEqualObjects([self updates], [NSArray arrayWithObject:[NSNull null]], @"finishes once with a nil image");
+	STAssertNil(decoder.currentImage, nil);
+}
+
+- (void)testCancelStopsUpdates
+{
+	NSData *data = TUITestPNG(64, 64);
+	TUIIncrementalImageDecoder *decoder = [self decoder];
+	[decoder appendData:[data subdataWithRange:NSMakeRange(0, [data length] / 2)]];
+	[decoder cancel];
+	[decoder appendData:[data subdataWithRange:NSMakeRange([data length] / 2, [data length] - [data length] / 2)]];
+	[decoder finish];
+	
+	STAssertFalse([self waitForFinish], @"no final update after a cancel");
+}
+
+@end
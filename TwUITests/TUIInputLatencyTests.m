@@ -0,0 +1,141 @@
+//
+//  TUIInputLatencyTests.m
+//  TwUITests
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import <TwUI/TUIKit.h>
+
+@interface TUIInputLatencyTests : SenTestCase
+@end
+
+@implementation TUIInputLatencyTests
+
+static BOOL WithinOneBucket(NSTimeInterval value, NSTimeInterval expected)
+{
+	// buckets are 2^(1/8) wide and report their upper bound
+	return value >= expected && value < expected * exp2(1.0 / 8);
+}
+
+- (void)testEmptyHistogram
+{
+	TUILatencyHistogram *h = [[TUILatencyHistogram alloc] init];
+	STAssertEquals(h.count, (NSUInteger)0, nil);
+	STAssertEquals(h.mean, 0.0, nil);
+	STAssertEquals([h valueAtPercentile:50], 0.0, nil);
+}
+
+- (void)testSingleValueIsExact
+{
+	TUILatencyHistogram *h = [[TUILatencyHistogram alloc] init];
+	[h addValue:0.005];
+	STAssertEquals(h.minimum, 0.005, nil);
+	STAssertEquals(h.maximum, 0.005, nil);
+	STAssertEquals([h valueAtPercentile:0], 0.005, @"clamped to the minimum");
+	STAssertEquals([h valueAtPercentile:50], 0.005, nil);
+	STAssertEquals([h valueAtPercentile:100], 0.005, @"clamped to the maximum");
+}
+
+- (void)testPercentiles
+{
+	TUILatencyHistogram *h = [[TUILatencyHistogram alloc] init];
+	for(int i = 100; i >= 1; --i)
+		[h addValue:i * 0.001];
+	
+	STAssertEquals(h.count, (NSUInteger)100, nil);
+	STAssertEquals(h.minimum, 0.001, nil);
+	STAssertEquals(h.maximum, 0.1, nil);
+	STAssertEqualsWithAccuracy(h.mean, 0.0505, 1e-9, nil);
+	
+	STAssertTrue(WithinOneBucket([h valueAtPercentile:50], 0.05), @"%f", [h valueAtPercentile:50]);
+	STAssertTrue(WithinOneBucket([h valueAtPercentile:90], 0.09), @"%f", [h valueAtPercentile:90]);
+	STAssertTrue(WithinOneBucket([h valueAtPercentile:99], 0.099), @"%f", [h valueAtPercentile:99]);
+	STAssertEquals([h valueAtPercentile:100], 0.1, nil);
+	STAssertEquals([h valueAtPercentile:150], 0.1, @"percentiles over 100 are clamped");
+	
+	NSTimeInterval last = 0.0;
+	for(double p = 0; p <= 100; p += 0.5) {
+		NSTimeInterval v = [h valueAtPercentile:p];
+		STAssertTrue(v >= last, @"p%.1f went down", p);
+		last = v;
+	}
+}
+
+- (void)testOutOfRangeValues
+{
+	TUILatencyHistogram *h = [[TUILatencyHistogram alloc] init];
+	[h addValue:-1.0];
+	[h addValue:0.000001];
+	[h addValue:1000.0];
+	
+	STAssertEquals(h.minimum, 0.0, @"negative latencies count as zero");
+	STAssertEquals(h.maximum, 1000.0, nil);
+	STAssertEquals([h valueAtPercentile:100], 1000.0, @"the last bucket is open ended, the exact maximum is reported");
+	STAssertTrue([h valueAtPercentile:50] <= 0.00001 * exp2(1.0 / 8), @"both small values land in the first bucket");
+}
+
+- (void)testCopyAndReset
+{
+	TUILatencyHistogram *h = [[TUILatencyHistogram alloc] init];
+	[h addValue:0.01];
+	TUILatencyHistogram *c = [h copy];
+	[h addValue:0.02];
+	
+	STAssertEquals(c.count, (NSUInteger)1, @"copies don't see later samples");
+	STAssertEquals(c.maximum, 0.01, nil);
+	
+	[h reset];
+	STAssertEquals(h.count, (NSUInteger)0, nil);
+	STAssertEquals([h valueAtPercentile:50], 0.0, nil);
+	[h addValue:0.03];
+	STAssertEquals(h.minimum, 0.03, @"reset clears the minimum too");
+}
+
+- (void)testTrackerMeasuresEventsThatInvalidate
+{
+	TUIInputLatencyTracker *tracker = [TUIInputLatencyTracker sharedTracker];
+	BOOL wasEnabled = tracker.enabled;
+	tracker.enabled = YES;
+	[tracker reset];
+	
+	NSTimeInterval t = [[NSProcessInfo processInfo] systemUptime];
+	_TUIInputLatencyBeginEvent(NSLeftMouseDown, t);
+	TUIInputLatencyNoteInvalidation();
+	_TUIInputLatencyEndEvent();
+	
+	_TUIInputLatencyBeginEvent(NSKeyDown, t);
+	_TUIInputLatencyEndEvent(); // changed nothing
+	
+	[tracker noteCommitAtTime:t + 0.02];
+	
+	TUILatencyHistogram *h = [tracker histogramForEventType:NSLeftMouseDown];
+	STAssertEquals(h.count, (NSUInteger)1, nil);
+	STAssertEqualsWithAccuracy(h.maximum, 0.02, 1e-9, nil);
+	STAssertNil([tracker histogramForEventType:NSKeyDown], @"events that don't invalidate aren't counted");
+	
+	[tracker reset];
+	tracker.enabled = wasEnabled;
+}
+
+- (void)testTrackerIgnoresInvalidationOffTheMainThread
+{
+	TUIInputLatencyTracker *tracker = [TUIInputLatencyTracker sharedTracker];
+	BOOL wasEnabled = tracker.enabled;
+	tracker.enabled = YES;
+	[tracker reset];
+	
+	NSTimeInterval t = [[NSProcessInfo processInfo] systemUptime];
+	_TUIInputLatencyBeginEvent(NSLeftMouseDown, t);
+	dispatch_sync(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+		TUIInputLatencyNoteInvalidation();
+	});
+	_TUIInputLatencyEndEvent();
+	[tracker noteCommitAtTime:t + 0.02];
+	
+	STAssertNil([tracker histogramForEventType:NSLeftMouseDown], nil);
+	
+	[tracker reset];
+	tracker.enabled = wasEnabled;
+}
+
+@end
@@ -0,0 +1,94 @@
+//
+//  TUINSViewLatchTests.m
+//  TwUITests
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import <TwUI/TUIKit.h>
+#import <TwUI/TUIView+Private.h>
+
+@interface TUINSViewLatchTests : SenTestCase
+@end
+
+// NSEventPhase, 10.7+
+enum {
+	PhaseNone = 0,
+	PhaseBegan = 0x1 << 0,
+	PhaseChanged = 0x1 << 2,
+	PhaseEnded = 0x1 << 3,
+	PhaseMayBegin = 0x1 << 5,
+};
+
+@implementation TUINSViewLatchTests
+
+/*
+ Runs a sequence of {phase, momentum phase, timestamp} events through the
+ latch the way TUINSView's scroll handling does, returning which ones hit
+ tested for a new target as a string of 'H' (hit test) and '.' (latched).
+ */
+static NSString *LatchSequence(const NSUInteger (*events)[3], NSUInteger count)
+{
+	NSMutableString *s = [NSMutableString string];
+	BOOL latched = NO;
+	NSTimeInterval last = 0.0;
+	for(NSUInteger i = 0; i < count; ++i) {
+		NSTimeInterval t = events[i][2] / 1000.0;
+		BOOL relatch = TUIEventShouldRelatch(latched, events[i][0], t, last);
+		[s appendString:relatch ? @"H" : @"."];
+		latched = YES;
+		last = t;
+		if(events[i][1] & PhaseEnded) // only the end of momentum releases a scroll latch
+			latched = NO;
+	}
+	return s;
+}
+
+- (void)testMomentumKeepsTheTarget
+{
+	const NSUInteger events[][3] = { // phase, momentum phase, ms
+		{PhaseMayBegin, PhaseNone, 0},
+		{PhaseBegan, PhaseNone, 10},
+		{PhaseChanged, PhaseNone, 20},
+		{PhaseEnded, PhaseNone, 30},
+		{PhaseNone, PhaseBegan, 40}, // momentum beginning isn't a new scroll
+		{PhaseNone, PhaseChanged, 50},
+		{PhaseNone, PhaseEnded, 60},
+		{PhaseNone, PhaseNone, 70}, // after the latch is released
+	};
+	STAssertEqualObjects(LatchSequence(events, sizeof(events) / sizeof(events[0])), @"HH.....H", nil);
+}
+
+- (void)testNewPhaseDuringMomentumRelatches
+{
+	const NSUInteger events[][3] = {
+		{PhaseBegan, PhaseNone, 0},
+		{PhaseEnded, PhaseNone, 10},
+		{PhaseNone, PhaseBegan, 20},
+		{PhaseNone, PhaseChanged, 30},
+		{PhaseMayBegin, PhaseNone, 40}, // fingers down again, the fling is over
+		{PhaseBegan, PhaseNone, 50},
+		{PhaseChanged, PhaseNone, 60},
+	};
+	STAssertEqualObjects(LatchSequence(events, sizeof(events) / sizeof(events[0])), @"H...HH.", nil);
+}
+
+- (void)testPauseRelatchesWithoutPhases
+{
+	// mice report no phases, a pause separates one scroll from the next
+	const NSUInteger events[][3] = {
+		{PhaseNone, PhaseNone, 0},
+		{PhaseNone, PhaseNone, 100},
+		{PhaseNone, PhaseNone, 350},
+		{PhaseNone, PhaseNone, 1000},
+		{PhaseNone, PhaseNone, 1050},
+	};
+	STAssertEqualObjects(LatchSequence(events, sizeof(events) / sizeof(events[0])), @"H..H.", nil);
+}
+
+- (void)testUnlatchedAlwaysHitTests
+{
+	STAssertTrue(TUIEventShouldRelatch(NO, PhaseChanged, 1.0, 1.0), nil);
+	STAssertFalse(TUIEventShouldRelatch(YES, PhaseChanged, 1.0, 1.0), nil);
+}
+
+@end
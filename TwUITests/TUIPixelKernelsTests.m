@@ -0,0 +1,253 @@
+//
+//  TUIPixelKernelsTests.m
+//  TwUITests
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import <TwUI/TUIKit.h>
+#import <TwUI/TUIPixelKernels.h>
+
+@interface TUIPixelKernelsTests : SenTestCase
+{
+	NSMutableArray *buffers; // NSMutableData keeping the test buffers alive
+}
+@end
+
+#define TestWidth 37 // not a multiple of any vector width, so the scalar tail runs too
+#define TestHeight 9
+#define TestBytesPerRow ((TestWidth + 3) * 4) // padded rows
+
+@implementation TUIPixelKernelsTests
+
+- (void)setUp
+{
+	[super setUp];
+	buffers = [[NSMutableArray alloc] init];
+	srandom(1);
+}
+
+- (void)tearDown
+{
+	TUIPixelKernelsForceScalar = NO;
+	buffers = nil;
+	[super tearDown];
+}
+
+- (TUIPixelBuffer)randomPixelBuffer
+{
+	NSMutableData *data = [NSMutableData dataWithLength:TestBytesPerRow * TestHeight];
+	[buffers addObject:data];
+	TUIPixelBuffer b = {[data mutableBytes], TestWidth, TestHeight, TestBytesPerRow};
+	for(size_t y = 0; y < b.height; ++y) {
+		uint32_t *row = (uint32_t *)((uint8_t *)b.data + y * b.bytesPerRow);
+		for(size_t x = 0; x < b.width; ++x) {
+			// premultiplied, no channel above alpha; include the 0 and 255 edges
+			uint32_t a = (x % 7 == 0) ? 0 : (x % 7 == 1) ? 255 : (uint32_t)(random() & 0xff);
+			uint32_t p = a << 24;
+			for(int c = 0; c < 24; c += 8)
+				p |= (uint32_t)(a ? random() % (a + 1) : 0) << c;
+			row[x] = p;
+		}
+	}
+	return b;
+}
+
+- (TUIPixelBuffer)copyOfPixelBuffer:(TUIPixelBuffer)b
+{
+	NSMutableData *data = [NSMutableData dataWithBytes:b.data length:b.bytesPerRow * b.height];
+	[buffers addObject:data];
+	b.data = [data mutableBytes];
+	return b;
+}
+
+- (TUIAlphaBuffer)randomAlphaBuffer
+{
+	NSMutableData *data = [NSMutableData dataWithLength:TestBytesPerRow * TestHeight];
+	[buffers addObject:data];
+	TUIAlphaBuffer b = {[data mutableBytes], TestWidth, TestHeight, TestBytesPerRow};
+	for(size_t i = 0; i < TestBytesPerRow * TestHeight; ++i)
+		b.data[i] = (i % 5 == 0) ? 255 : (uint8_t)random();
+	return b;
+}
+
+- (void)assertPixelBuffer:(TUIPixelBuffer)a equals:(TUIPixelBuffer)b
+{
+	for(size_t y = 0; y < a.height; ++y) {
+		int cmp = memcmp((uint8_t *)a.data + y * a.bytesPerRow, (uint8_t *)b.data + y * b.bytesPerRow, a.width * 4);
+		STAssertTrue(cmp == 0, @"row %lu differs", (unsigned long)y);
+	}
+}
+
+- (void)testMul255IsRoundedDivision
+{
+	for(uint32_t x = 0; x < 256; ++x) {
+		for(uint32_t a = 0; a < 256; ++a) {
+			uint32_t expected = (uint32_t)floor(x * a / 255.0 + 0.5);
+			if(TUIPixelMul255(x, a) != expected)
+				STFail(@"TUIPixelMul255(%u, %u) = %u, expected %u", x, a, TUIPixelMul255(x, a), expected);
+		}
+	}
+}
+
+- (void)testMultiplyByMaskMatchesScalar
+{
+	TUIPixelBuffer vector = [self randomPixelBuffer];
+	TUIPixelBuffer scalar = [self copyOfPixelBuffer:vector];
+	TUIPixelBuffer original = [self copyOfPixelBuffer:vector];
+	TUIAlphaBuffer mask = [self randomAlphaBuffer];
+	
+	TUIPixelKernelsForceScalar = NO;
+	TUIPixelBufferMultiplyByMask(vector, mask);
+	TUIPixelKernelsForceScalar = YES;
+	TUIPixelBufferMultiplyByMask(scalar, mask);
+	[self assertPixelBuffer:vector equals:scalar];
+	
+	uint32_t p = original.data[3];
+	uint8_t m = mask.data[3];
+	STAssertEquals(scalar.data[3] >> 24, TUIPixelMul255(p >> 24, m), nil);
+	STAssertEquals(scalar.data[3] & 0xff, TUIPixelMul255(p & 0xff, m), nil);
+}
+
+- (void)testInvertAlphaMatchesScalar
+{
+	TUIPixelBuffer src = [self randomPixelBuffer];
+	TUIPixelBuffer vector = [self randomPixelBuffer];
+	TUIPixelBuffer scalar = [self randomPixelBuffer];
+	
+	TUIPixelKernelsForceScalar = NO;
+	TUIPixelBufferInvertAlpha(vector, src);
+	TUIPixelKernelsForceScalar = YES;
+	TUIPixelBufferInvertAlpha(scalar, src);
+	[self assertPixelBuffer:vector equals:scalar];
+	STAssertEquals(scalar.data[5], (~src.data[5]) & 0xff000000, nil);
+	
+	// in place
+	TUIPixelBuffer inPlace = [self copyOfPixelBuffer:src];
+	TUIPixelKernelsForceScalar = NO;
+	TUIPixelBufferInvertAlpha(inPlace, inPlace);
+	[self assertPixelBuffer:inPlace equals:scalar];
+}
+
+- (void)testEmbossAlphaMatchesScalar
+{
+	TUIPixelBuffer src = [self randomPixelBuffer];
+	NSInteger offsets[] = {0, 1, -1, 3, -5, TestWidth, -TestWidth - 2};
+	for(int i = 0; i < sizeof(offsets) / sizeof(offsets[0]); ++i) {
+		for(int j = 0; j < sizeof(offsets) / sizeof(offsets[0]); ++j) {
+			TUIPixelBuffer vector = [self randomPixelBuffer];
+			TUIPixelBuffer scalar = [self randomPixelBuffer];
+			TUIPixelKernelsForceScalar = NO;
+			TUIPixelBufferEmbossAlpha(vector, src, offsets[i], offsets[j]);
+			TUIPixelKernelsForceScalar = YES;
+			TUIPixelBufferEmbossAlpha(scalar, src, offsets[i], offsets[j]);
+			[self assertPixelBuffer:vector equals:scalar];
+		}
+	}
+}
+
+- (TUIPixelBuffer)pixelBufferWithWidth:(size_t)width height:(size_t)height
+{
+	NSMutableData *data = [NSMutableData dataWithLength:width * height * 4];
+	[buffers addObject:data];
+	TUIPixelBuffer b = {[data mutableBytes], width, height, width * 4};
+	return b;
+}
+
+- (void)testScaleBilinearMatchesScalar
+{
+	TUIPixelBuffer src = [self randomPixelBuffer];
+	size_t sizes[][2] = {{TestWidth * 2 + 1, TestHeight * 3}, {TestWidth / 2 + 1, TestHeight / 2 + 1}, {TestWidth, 1}, {1, TestHeight}};
+	for(int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+		TUIPixelBuffer vector = [self pixelBufferWithWidth:sizes[i][0] height:sizes[i][1]];
+		TUIPixelBuffer scalar = [self pixelBufferWithWidth:sizes[i][0] height:sizes[i][1]];
+		TUIPixelKernelsForceScalar = NO;
+		STAssertTrue(TUIPixelBufferScaleBilinear(vector, src), nil);
+		TUIPixelKernelsForceScalar = YES;
+		STAssertTrue(TUIPixelBufferScaleBilinear(scalar, src), nil);
+		[self assertPixelBuffer:vector equals:scalar];
+	}
+}
+
+- (void)testScaleBilinearToSameSizeCopies
+{
+	TUIPixelBuffer src = [self randomPixelBuffer];
+	TUIPixelBuffer dst = [self randomPixelBuffer];
+	STAssertTrue(TUIPixelBufferScaleBilinear(dst, src), nil);
+	[self assertPixelBuffer:dst equals:src];
+}
+
+- (void)testScaleBilinearHalvesToPairAverages
+{
+	uint32_t src[] = {0xff000000, 0xff0000fe, 0x00000000, 0x80808080};
+	uint32_t halves[2];
+	TUIPixelBuffer s = {src, 4, 1, sizeof(src)};
+	TUIPixelBuffer d = {halves, 2, 1, sizeof(halves)};
+	STAssertTrue(TUIPixelBufferScaleBilinear(d, s), nil);
+	STAssertEquals(halves[0], (uint32_t)0xff00007f, nil);
+	STAssertEquals(halves[1], (uint32_t)0x40404040, nil);
+}
+
+- (void)testRoundCornersTouchesOnlyCorners
+{
+	TUIPixelBuffer b = [self pixelBufferWithWidth:16 height:12];
+	for(size_t i = 0; i < 16 * 12; ++i)
+		b.data[i] = 0xffffffff;
+	TUIPixelBufferRoundCorners(b, 4);
+	
+	for(size_t y = 0; y < 12; ++y) {
+		for(size_t x = 0; x < 16; ++x) {
+			BOOL corner = (x < 4 || x >= 12) && (y < 4 || y >= 8);
+			uint32_t p = b.data[y * 16 + x];
+			if(!corner)
+				STAssertEquals(p, (uint32_t)0xffffffff, @"(%lu, %lu)", (unsigned long)x, (unsigned long)y);
+			// still premultiplied, all channels scaled alike
+			STAssertEquals(p & 0xff, p >> 24, nil);
+			// symmetric
+			STAssertEquals(p, b.data[(11 - y) * 16 + (15 - x)], nil);
+		}
+	}
+	STAssertEquals(b.data[0], (uint32_t)0, nil); // the corner pixel is outside the arc
+	STAssertEquals(b.data[3 * 16 + 3], (uint32_t)0xffffffff, nil); // the one next to the arc's center is inside
+	
+	// the radius is clamped to half the smaller side
+	TUIPixelBuffer small = [self pixelBufferWithWidth:4 height:2];
+	for(size_t i = 0; i < 8; ++i)
+		small.data[i] = 0xffffffff;
+	TUIPixelBufferRoundCorners(small, 100);
+	STAssertTrue(small.data[0] >> 24 < 0xff, nil);
+	STAssertEquals(small.data[1], (uint32_t)0xffffffff, nil);
+}
+
+- (void)testBoxBlurKeepsConstantPlane
+{
+	TUIAlphaBuffer b = [self randomAlphaBuffer];
+	for(size_t y = 0; y < b.height; ++y)
+		memset(b.data + y * b.bytesPerRow, 200, b.width);
+	STAssertTrue(TUIAlphaBufferBoxBlur(b, 3, 3), nil);
+	for(size_t y = 0; y < b.height; ++y)
+		for(size_t x = 0; x < b.width; ++x)
+			STAssertEquals(b.data[y * b.bytesPerRow + x], (uint8_t)200, nil);
+}
+
+- (void)testInnerShadowUsesBackgroundAlpha
+{
+	uint8_t full = 255, none = 0;
+	uint32_t pixel = 0;
+	TUIPixelBuffer dst = {&pixel, 1, 1, 4};
+	TUIAlphaBuffer shape = {&full, 1, 1, 1};
+	TUIAlphaBuffer fill = {&none, 1, 1, 1}; // outside the fill, only the shadow shows
+	TUIAlphaBuffer blurred = {&full, 1, 1, 1};
+	uint32_t shadow = 0xff000000; // opaque black
+	
+	TUIPixelBufferCompositeInnerShadow(dst, shape, fill, blurred, shadow, 0xffffffff);
+	STAssertEquals(pixel >> 24, (uint32_t)255, nil);
+	
+	// a half transparent background casts a half transparent shadow, like CG's transparency layer
+	TUIPixelBufferCompositeInnerShadow(dst, shape, fill, blurred, shadow, 0x80808080);
+	STAssertEquals(pixel >> 24, (uint32_t)0x80, nil);
+	
+	TUIPixelBufferCompositeInnerShadow(dst, shape, fill, blurred, shadow, 0);
+	STAssertEquals(pixel, (uint32_t)0, nil);
+}
+
+@end
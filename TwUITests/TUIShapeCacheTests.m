@@ -0,0 +1,129 @@
+//
+//  TUIShapeCacheTests.m
+//  TwUITests
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import <TwUI/TUIKit.h>
+
+@interface TUIShapeCacheTests : SenTestCase
+@end
+
+#define TestSize CGSizeMake(60, 30)
+
+@implementation TUIShapeCacheTests
+
+- (void)setUp
+{
+	[super setUp];
+	TUIShapeCacheRemoveAll();
+}
+
+// largest per channel difference between two contexts of TestSize
+- (int)maximumDifferenceBetween:(CGContextRef)a and:(CGContextRef)b
+{
+	const uint8_t *pa = CGBitmapContextGetData(a);
+	const uint8_t *pb = CGBitmapContextGetData(b);
+	size_t length = CGBitmapContextGetBytesPerRow(a) * CGBitmapContextGetHeight(a);
+	int difference = 0;
+	for(size_t i = 0; i < length; ++i)
+		difference = MAX(difference, abs((int)pa[i] - (int)pb[i]));
+	return difference;
+}
+
+- (void)testGradientsAreInternedByStops
+{
+	CGFloat stops[] = {1, 1, 0.5, 1, 1, 1, 0.25, 1};
+	CGFloat sameStops[] = {1, 1, 0.5, 1, 1, 1, 0.25, 1};
+	CGFloat otherStops[] = {1, 1, 0.5, 1, 1, 1, 0.26, 1};
+	CGFloat locations[] = {0, 0.5};
+	
+	CGGradientRef a = TUICreateCachedGradient(stops, NULL, 2);
+	CGGradientRef b = TUICreateCachedGradient(sameStops, NULL, 2);
+	CGGradientRef c = TUICreateCachedGradient(otherStops, NULL, 2);
+	CGGradientRef d = TUICreateCachedGradient(stops, locations, 2);
+	STAssertTrue(a == b, @"equal stops share a gradient");
+	STAssertTrue(a != c, nil);
+	STAssertTrue(a != d, @"locations are part of the key");
+	CGGradientRelease(a);
+	CGGradientRelease(b);
+	CGGradientRelease(c);
+	CGGradientRelease(d);
+}
+
+- (void)testRoundRectFillMatchesPathFill
+{
+	CGRect rect = CGRectMake(3, 4, 50, 20);
+	CGColorRef color = CGColorGetConstantColor(kCGColorBlack);
+	CGContextRef path = TUICreateGraphicsContext(TestSize);
+	CGContextRef sliced = TUICreateGraphicsContext(TestSize);
+	
+	CGContextSetFillColorWithColor(path, color);
+	CGContextFillRoundRect(path, rect, 6);
+	CGContextFillRoundRectWithColor(sliced, rect, 6, color);
+	CGContextClearRect(sliced, CGRectMake(0, 0, TestSize.width, TestSize.height));
+	CGContextFillRoundRectWithColor(sliced, rect, 6, color); // from the cache this time
+	
+	STAssertTrue([self maximumDifferenceBetween:path and:sliced] <= 2, nil);
+	CGContextRelease(path);
+	CGContextRelease(sliced);
+}
+
+- (void)testVerticalGradientMatchesClippedGradient
+{
+	CGRect rect = CGRectMake(0, 0, 57, 18);
+	CGFloat top[] = {1.0, 1.0, 198/255., 1.0};
+	CGFloat bottom[] = {1.0, 1.0, 158/255., 1.0};
+	CGContextRef clipped = TUICreateGraphicsContext(TestSize);
+	CGContextRef sliced = TUICreateGraphicsContext(TestSize);
+	
+	CGContextClipToRoundRect(clipped, rect, 2);
+	CGContextDrawLinearGradientBetweenPoints(clipped, CGPointMake(0, rect.size.height), top, CGPointZero, bottom);
+	CGContextFillRoundRectWithVerticalGradient(sliced, rect, 2, top, bottom);
+	
+	STAssertTrue([self maximumDifferenceBetween:clipped and:sliced] <= 2, nil);
+	CGContextRelease(clipped);
+	CGContextRelease(sliced);
+}
+
+- (void)testGlowMatchesShadowedFill
+{
+	CGRect rect = CGRectMake(15, 10, 30, 10);
+	CGColorRef white = CGColorGetConstantColor(kCGColorWhite);
+	CGContextRef shadowed = TUICreateGraphicsContext(TestSize);
+	CGContextRef sliced = TUICreateGraphicsContext(TestSize);
+	
+	CGContextSetFillColorWithColor(shadowed, white);
+	CGContextSetShadowWithColor(shadowed, CGSizeZero, 4, white);
+	CGContextFillRoundRect(shadowed, rect, 10);
+	CGContextFillRoundRectWithColorAndGlow(sliced, rect, 10, white, 4, white);
+	
+	// the stretched middle of the glow is only close to the shadow of the real rect
+	STAssertTrue([self maximumDifferenceBetween:shadowed and:sliced] <= 16, nil);
+	CGContextRelease(shadowed);
+	CGContextRelease(sliced);
+}
+
+- (void)testRotatedContextFallsBackToPathFill
+{
+	CGRect rect = CGRectMake(20, 5, 20, 20);
+	CGColorRef color = CGColorGetConstantColor(kCGColorBlack);
+	CGContextRef path = TUICreateGraphicsContext(TestSize);
+	CGContextRef sliced = TUICreateGraphicsContext(TestSize);
+	for(int i = 0; i < 2; ++i) {
+		CGContextRef ctx = i ? sliced : path;
+		CGContextTranslateCTM(ctx, 30, 15);
+		CGContextRotateCTM(ctx, M_PI / 4);
+		CGContextTranslateCTM(ctx, -30, -15);
+	}
+	
+	CGContextSetFillColorWithColor(path, color);
+	CGContextFillRoundRect(path, rect, 4);
+	CGContextFillRoundRectWithColor(sliced, rect, 4, color);
+	
+	STAssertEquals([self maximumDifferenceBetween:path and:sliced], 0, nil);
+	CGContextRelease(path);
+	CGContextRelease(sliced);
+}
+
+@end
@@ -0,0 +1,118 @@
+//
+//  TUIStallWatchdogTests.m
+//  TwUITests
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import <TwUI/TUIKit.h>
+
+@interface TUIStallWatchdogTests : SenTestCase
+{
+	NSMutableArray *reports; // @synchronized, the handler runs on the watchdog's queue
+	dispatch_semaphore_t reported;
+}
+@end
+
+@implementation TUIStallWatchdogTests
+
+- (void)setUp
+{
+	[super setUp];
+	reports = [NSMutableArray array];
+	reported = dispatch_semaphore_create(0);
+	
+	TUIStallWatchdog *watchdog = [TUIStallWatchdog sharedWatchdog];
+	[watchdog stop];
+	watchdog.threshold = 0.05;
+	NSMutableArray *r = reports;
+	dispatch_semaphore_t s = reported;
+	watchdog.reportHandler = ^(TUIStallReport *report) {
+		@synchronized(r) {
+			[r addObject:report];
+		}
+		dispatch_semaphore_signal(s);
+	};
+}
+
+- (void)tearDown
+{
+	TUIStallWatchdog *watchdog = [TUIStallWatchdog sharedWatchdog];
+	[watchdog stop];
+	watchdog.reportHandler = nil;
+	watchdog.threshold = 0.25;
+	dispatch_release(reported);
+	[super tearDown];
+}
+
+- (NSArray *)reports
+{
+	@synchronized(reports) {
+		return [reports copy];
+	}
+}
+
+- (void)testReportsStallWithActivePhases
+{
+	TUIView *view = [[TUIView alloc] initWithFrame:CGRectZero];
+	[[TUIStallWatchdog sharedWatchdog] start];
+	
+	TUIPhaseBegin(TUIPhaseEvent, nil);
+	TUIPhaseBegin(TUIPhaseLayout, view);
+	usleep(200000); // the main thread doesn't get back to its run loop
+	TUIPhaseEnd();
+	TUIPhaseEnd();
+	
+	STAssertTrue(dispatch_semaphore_wait(reported, dispatch_time(DISPATCH_TIME_NOW, NSEC_PER_SEC)) == 0, @"no report");
+	
+	TUIStallReport *report = [[self reports] objectAtIndex:0];
+	STAssertTrue(report.duration >= 0.05, @"%@", report);
+	STAssertEquals([report.phases count], (NSUInteger)2, @"%@", report);
+	STAssertTrue([[report.phases objectAtIndex:0] hasPrefix:@"event ("], @"%@", report);
+	STAssertTrue([[report.phases objectAtIndex:1] hasPrefix:@"layout TUIView ("], @"%@", report);
+}
+
+- (void)testOneReportPerStall
+{
+	[[TUIStallWatchdog sharedWatchdog] start];
+	usleep(300000); // several timer intervals past the threshold
+	[[TUIStallWatchdog sharedWatchdog] stop];
+	
+	STAssertEquals([[self reports] count], (NSUInteger)1, nil);
+	STAssertEquals([[[[self reports] lastObject] phases] count], (NSUInteger)0, @"no TUIKit phase was active");
+}
+
+- (void)wake:(NSTimer *)timer
+{
+}
+
+- (void)testNoReportWhileRunLoopWaits
+{
+	[[TUIStallWatchdog sharedWatchdog] start];
+	
+	// a timer keeps the run loop waiting rather than returning straight away
+	NSDate *until = [NSDate dateWithTimeIntervalSinceNow:0.3];
+	[NSTimer scheduledTimerWithTimeInterval:0.3 target:self selector:@selector(wake:) userInfo:nil repeats:NO];
+	while([until timeIntervalSinceNow] > 0)
+		[[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:until];
+	
+	[[TUIStallWatchdog sharedWatchdog] stop];
+	STAssertEquals([[self reports] count], (NSUInteger)0, @"%@", [self reports]);
+}
+
+- (void)testPhasesOffTheMainThreadAreIgnored
+{
+	[[TUIStallWatchdog sharedWatchdog] start];
+	dispatch_sync(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+		TUIPhaseBegin(TUIPhaseImageDecode, nil); // never ended, would corrupt the main thread's stack
+	});
+	TUIPhaseBegin(TUIPhaseDisplay, nil);
+	usleep(200000);
+	TUIPhaseEnd();
+	
+	STAssertTrue(dispatch_semaphore_wait(reported, dispatch_time(DISPATCH_TIME_NOW, NSEC_PER_SEC)) == 0, @"no report");
+	NSArray *phases = [[[self reports] objectAtIndex:0] phases];
+	STAssertEquals([phases count], (NSUInteger)1, @"%@", phases);
+	STAssertTrue([[phases objectAtIndex:0] hasPrefix:@"display ("], @"%@", phases);
+}
+
+@end
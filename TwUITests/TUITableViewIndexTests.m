@@ -0,0 +1,171 @@
+//
+//  TUITableViewIndexTests.m
+//  TwUITests
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import <TwUI/TUIKit.h>
+
+@interface TUITableViewIndexTests : SenTestCase <TUITableViewDataSource, TUITableViewDelegate>
+{
+	NSArray *_rowCounts; // NSNumber per section
+	TUITableView *_table;
+}
+@end
+
+#define ROW_HEIGHT 10.0
+
+@implementation TUITableViewIndexTests
+
+- (void)tearDown
+{
+	_table.dataSource = nil;
+	_table.delegate = nil;
+	_table = nil;
+	[super tearDown];
+}
+
+- (TUITableView *)tableWithRowCounts:(NSArray *)rowCounts
+{
+	_rowCounts = rowCounts;
+	NSInteger rows = 0;
+	for(NSNumber *n in rowCounts)
+		rows += [n integerValue];
+	_table = [[TUITableView alloc] initWithFrame:CGRectMake(0, 0, 100, MAX(rows, 1) * ROW_HEIGHT) style:TUITableViewStylePlain];
+	_table.dataSource = self;
+	_table.delegate = self;
+	[_table reloadData];
+	return _table;
+}
+
+- (NSInteger)numberOfSectionsInTableView:(TUITableView *)tableView
+{
+	return [_rowCounts count];
+}
+
+- (NSInteger)tableView:(TUITableView *)table numberOfRowsInSection:(NSInteger)section
+{
+	return [[_rowCounts objectAtIndex:section] integerValue];
+}
+
+- (CGFloat)tableView:(TUITableView *)tableView heightForRowAtIndexPath:(TUIFastIndexPath *)indexPath
+{
+	return ROW_HEIGHT;
+}
+
+- (TUITableViewCell *)tableView:(TUITableView *)tableView cellForRowAtIndexPath:(TUIFastIndexPath *)indexPath
+{
+	TUITableViewCell *cell = [tableView dequeueReusableCellWithIdentifier:@"cell"];
+	if(!cell)
+		cell = [[TUITableViewCell alloc] initWithStyle:TUITableViewCellStyleDefault reuseIdentifier:@"cell"];
+	return cell;
+}
+
+static TUIFastIndexPath *IP(NSUInteger section, NSUInteger row)
+{
+	return [TUIFastIndexPath indexPathForRow:row inSection:section];
+}
+
+#pragma mark Row indexes
+
+- (void)testRowIndexesSkipEmptySections
+{
+	TUITableView *table = [self tableWithRowCounts:[NSArray arrayWithObjects:[NSNumber numberWithInt:0], [NSNumber numberWithInt:2], [NSNumber numberWithInt:0], [NSNumber numberWithInt:0], [NSNumber numberWithInt:3], [NSNumber numberWithInt:0], nil]];
+	STAssertEquals([table numberOfRows], (NSInteger)5, nil);
+	
+	TUIFastIndexPath *expected[] = {IP(1, 0), IP(1, 1), IP(4, 0), IP(4, 1), IP(4, 2)};
+	for(NSUInteger i = 0; i < 5; ++i) {
+		STAssertEqualObjects([table indexPathForRowAtIndex:i], expected[i], @"row %lu", (unsigned long)i);
+		STAssertEquals([table indexOfRowAtIndexPath:expected[i]], i, nil);
+	}
+}
+
+- (void)testRowIndexesOutOfRange
+{
+	TUITableView *table = [self tableWithRowCounts:[NSArray arrayWithObjects:[NSNumber numberWithInt:2], [NSNumber numberWithInt:0], [NSNumber numberWithInt:1], nil]];
+	STAssertNil([table indexPathForRowAtIndex:3], nil);
+	STAssertNil([table indexPathForRowAtIndex:NSUIntegerMax], nil);
+	
+	STAssertEquals([table indexOfRowAtIndexPath:IP(0, 2)], (NSUInteger)NSNotFound, @"past the end of its section");
+	STAssertEquals([table indexOfRowAtIndexPath:IP(1, 0)], (NSUInteger)NSNotFound, @"in an empty section");
+	STAssertEquals([table indexOfRowAtIndexPath:IP(3, 0)], (NSUInteger)NSNotFound, @"no such section");
+	STAssertEquals([table indexOfRowAtIndexPath:IP(NSUIntegerMax, 0)], (NSUInteger)NSNotFound, nil);
+	STAssertEquals([table indexOfRowAtIndexPath:nil], (NSUInteger)NSNotFound, nil);
+}
+
+- (void)testEmptyTables
+{
+	TUITableView *table = [self tableWithRowCounts:[NSArray array]];
+	STAssertEquals([table numberOfRows], (NSInteger)0, nil);
+	STAssertNil([table indexPathForRowAtIndex:0], nil);
+	STAssertNil([table indexPathForRowAtVerticalOffset:0], nil);
+	
+	table = [self tableWithRowCounts:[NSArray arrayWithObjects:[NSNumber numberWithInt:0], [NSNumber numberWithInt:0], nil]];
+	STAssertEquals([table numberOfRows], (NSInteger)0, nil);
+	STAssertNil([table indexPathForRowAtIndex:0], nil);
+	STAssertEquals([table indexOfRowAtIndexPath:IP(0, 0)], (NSUInteger)NSNotFound, nil);
+	STAssertNil([table indexPathForRowAtVerticalOffset:0], nil);
+}
+
+#pragma mark Vertical offsets
+
+- (void)testVerticalOffsets
+{
+	// 2 rows, an empty section, 3 rows: 50pt of rows, the first one at the top (y 40...50)
+	TUITableView *table = [self tableWithRowCounts:[NSArray arrayWithObjects:[NSNumber numberWithInt:2], [NSNumber numberWithInt:0], [NSNumber numberWithInt:3], nil]];
+	STAssertEqualObjects([table indexPathForRowAtVerticalOffset:45], IP(0, 0), nil);
+	STAssertEqualObjects([table indexPathForRowAtVerticalOffset:35], IP(0, 1), nil);
+	STAssertEqualObjects([table indexPathForRowAtVerticalOffset:25], IP(2, 0), nil);
+	STAssertEqualObjects([table indexPathForRowAtVerticalOffset:5], IP(2, 2), nil);
+	
+	// every row agrees with its own rect
+	for(NSUInteger i = 0; i < 5; ++i) {
+		TUIFastIndexPath *indexPath = [table indexPathForRowAtIndex:i];
+		CGRect r = [table rectForRowAtIndexPath:indexPath];
+		STAssertEqualObjects([table indexPathForRowAtVerticalOffset:CGRectGetMidY(r)], indexPath, nil);
+	}
+}
+
+- (void)testVerticalOffsetsOnSharedEdges
+{
+	TUITableView *table = [self tableWithRowCounts:[NSArray arrayWithObjects:[NSNumber numberWithInt:2], [NSNumber numberWithInt:0], [NSNumber numberWithInt:3], nil]];
+	// rows contain both edges and the upper row wins where two meet, across sections too
+	STAssertEqualObjects([table indexPathForRowAtVerticalOffset:50], IP(0, 0), @"top edge");
+	STAssertEqualObjects([table indexPathForRowAtVerticalOffset:40], IP(0, 0), nil);
+	STAssertEqualObjects([table indexPathForRowAtVerticalOffset:30], IP(0, 1), @"over the empty section");
+	STAssertEqualObjects([table indexPathForRowAtVerticalOffset:20], IP(2, 0), nil);
+	STAssertEqualObjects([table indexPathForRowAtVerticalOffset:0], IP(2, 2), @"bottom edge");
+}
+
+- (void)testVerticalOffsetsOutsideTheRows
+{
+	TUITableView *table = [self tableWithRowCounts:[NSArray arrayWithObjects:[NSNumber numberWithInt:2], [NSNumber numberWithInt:3], nil]];
+	STAssertNil([table indexPathForRowAtVerticalOffset:50.5], nil);
+	STAssertNil([table indexPathForRowAtVerticalOffset:-0.5], nil);
+	STAssertNil([table indexPathForRowAtVerticalOffset:1e6], nil);
+}
+
+#pragma mark Accessibility
+
+- (void)testHitTestingMatchesChildren
+{
+	TUITableView *table = [self tableWithRowCounts:[NSArray arrayWithObjects:[NSNumber numberWithInt:2], nil]];
+	TUIView *header = [[TUIView alloc] initWithFrame:CGRectMake(0, 0, 100, 10)];
+	header.isAccessibilityElement = YES;
+	table.headerView = header;
+	table.frame = CGRectMake(0, 0, 100, 30);
+	[table reloadData];
+	[table layoutIfNeeded];
+	
+	NSArray *children = [table accessibilityAttributeValue:NSAccessibilityChildrenAttribute];
+	STAssertEquals([children count], (NSUInteger)2, @"rows only");
+	
+	id row = [table accessibilityHitTest:NSMakePoint(50, CGRectGetMidY([table rectForRowAtIndexPath:IP(0, 0)]))];
+	STAssertEqualObjects(row, [table accessibilityElementForRowAtIndexPath:IP(0, 0)], nil);
+	STAssertTrue([children containsObject:row], nil);
+	
+	id hit = [table accessibilityHitTest:[table convertPoint:NSMakePoint(50, 5) fromView:header]];
+	STAssertTrue(hit == table, @"the header isn't a child, so it isn't hit either");
+}
+
+@end
@@ -0,0 +1,240 @@
+//
+//  TUITableViewKeyboardTests.m
+//  TwUITests
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import <TwUI/TUIKit.h>
+
+@interface TUITableViewKeyboardTests : SenTestCase <TUITableViewDataSource, TUITableViewDelegate>
+{
+	TUITableView *_table;
+	NSMutableArray *_notifications; // "+row" for a select, "-row" for a deselect
+	BOOL _clockWasPaused;
+	NSTimeInterval _clockTime;
+}
+@end
+
+#define ROW_COUNT 100
+#define ROW_HEIGHT 10.0
+
+@implementation TUITableViewKeyboardTests
+
+- (void)setUp
+{
+	[super setUp];
+	// ticked by hand, so frames only pass when a test says so
+	TUIFrameClock *clock = [TUIFrameClock sharedClock];
+	_clockWasPaused = clock.paused;
+	clock.paused = YES;
+	_clockTime = [NSDate timeIntervalSinceReferenceDate];
+	
+	_notifications = [NSMutableArray array];
+	_table = [[TUITableView alloc] initWithFrame:CGRectMake(0, 0, 100, 10 * ROW_HEIGHT) style:TUITableViewStylePlain];
+	_table.dataSource = self;
+	_table.delegate = self;
+	_table.animateSelectionChanges = NO;
+	[_table reloadData];
+	[_table layoutSubviews];
+}
+
+- (void)tearDown
+{
+	_table.dataSource = nil;
+	_table.delegate = nil;
+	_table = nil;
+	[TUIFrameClock sharedClock].paused = _clockWasPaused;
+	[super tearDown];
+}
+
+- (NSInteger)tableView:(TUITableView *)table numberOfRowsInSection:(NSInteger)section
+{
+	return ROW_COUNT;
+}
+
+- (CGFloat)tableView:(TUITableView *)tableView heightForRowAtIndexPath:(TUIFastIndexPath *)indexPath
+{
+	return ROW_HEIGHT;
+}
+
+- (TUITableViewCell *)tableView:(TUITableView *)tableView cellForRowAtIndexPath:(TUIFastIndexPath *)indexPath
+{
+	TUITableViewCell *cell = [tableView dequeueReusableCellWithIdentifier:@"cell"];
+	if(!cell)
+		cell = [[TUITableViewCell alloc] initWithStyle:TUITableViewCellStyleDefault reuseIdentifier:@"cell"];
+	return cell;
+}
+
+- (void)tableView:(TUITableView *)tableView didSelectRowAtIndexPath:(TUIFastIndexPath *)indexPath
+{
+	[_notifications addObject:[NSString stringWithFormat:@"+%lu", (unsigned long)indexPath.row]];
+}
+
+- (void)tableView:(TUITableView *)tableView didDeselectRowAtIndexPath:(TUIFastIndexPath *)indexPath
+{
+	[_notifications addObject:[NSString stringWithFormat:@"-%lu", (unsigned long)indexPath.row]];
+}
+
+- (void)selectRow:(NSUInteger)row
+{
+	[_table selectRowAtIndexPath:[TUIFastIndexPath indexPathForRow:row inSection:0] animated:NO scrollPosition:TUITableViewScrollPositionToVisible];
+	[_table layoutSubviews];
+	[_notifications removeAllObjects];
+}
+
+- (NSUInteger)selectedRow
+{
+	TUIFastIndexPath *indexPath = [_table indexPathForSelectedRow];
+	return indexPath ? indexPath.row : NSNotFound;
+}
+
+- (void)press:(unichar)key modifiers:(NSUInteger)modifiers repeat:(BOOL)repeat
+{
+	NSString *characters = [NSString stringWithCharacters:&key length:1];
+	NSEvent *event = [NSEvent keyEventWithType:NSKeyDown location:NSZeroPoint modifierFlags:modifiers timestamp:[[NSProcessInfo processInfo] systemUptime] windowNumber:0 context:nil characters:characters charactersIgnoringModifiers:characters isARepeat:repeat keyCode:0];
+	STAssertTrue([_table performKeyAction:event], nil);
+	[_table layoutSubviews];
+}
+
+- (void)tick
+{
+	_clockTime += 1.0 / 60.0;
+	[[TUIFrameClock sharedClock] tickWithTimestamp:_clockTime];
+}
+
+#pragma mark Arrows
+
+- (void)testArrowsMoveARow
+{
+	_table.keyRepeatSelectionNotificationDelay = 0.0;
+	[self selectRow:5];
+	[self press:NSDownArrowFunctionKey modifiers:0 repeat:NO];
+	STAssertEquals([self selectedRow], (NSUInteger)6, nil);
+	[self tick];
+	[self press:NSUpArrowFunctionKey modifiers:0 repeat:NO];
+	STAssertEquals([self selectedRow], (NSUInteger)5, nil);
+	STAssertEqualObjects(_notifications, ([NSArray arrayWithObjects:@"-5", @"+6", @"-6", @"+5", nil]), nil);
+}
+
+- (void)testArrowsStopAtTheEnds
+{
+	[self selectRow:0];
+	[self press:NSUpArrowFunctionKey modifiers:0 repeat:NO];
+	STAssertEquals([self selectedRow], (NSUInteger)0, nil);
+	
+	[self selectRow:ROW_COUNT - 1];
+	[self press:NSDownArrowFunctionKey modifiers:0 repeat:NO];
+	STAssertEquals([self selectedRow], (NSUInteger)ROW_COUNT - 1, nil);
+}
+
+#pragma mark Key repeat
+
+- (void)testRepeatsWithinAFrameAreMerged
+{
+	_table.keyRepeatSelectionNotificationDelay = 0.0;
+	[self selectRow:0];
+	[self press:NSDownArrowFunctionKey modifiers:0 repeat:NO];
+	STAssertEquals([self selectedRow], (NSUInteger)1, @"the first move of a frame is applied at once");
+	
+	for(int i = 0; i < 3; ++i)
+		[self press:NSDownArrowFunctionKey modifiers:0 repeat:YES];
+	STAssertEquals([self selectedRow], (NSUInteger)1, @"later repeats in the same frame wait for the tick");
+	
+	[self tick];
+	STAssertEquals([self selectedRow], (NSUInteger)4, @"and then move by all of them at once");
+	STAssertEqualObjects(_notifications, ([NSArray arrayWithObjects:@"-0", @"+1", @"-1", @"+4", nil]), @"one selection per frame");
+	
+	[self tick]; // nothing pending, the next repeat applies straight away
+	[self press:NSDownArrowFunctionKey modifiers:0 repeat:YES];
+	STAssertEquals([self selectedRow], (NSUInteger)5, nil);
+}
+
+- (void)testKeyDownAfterRepeatsDropsTheirPendingTarget
+{
+	_table.keyRepeatSelectionNotificationDelay = 0.0;
+	[self selectRow:10];
+	[self press:NSDownArrowFunctionKey modifiers:0 repeat:YES];
+	[self press:NSDownArrowFunctionKey modifiers:0 repeat:YES]; // pending 12
+	[self press:NSUpArrowFunctionKey modifiers:0 repeat:NO]; // from the pending target
+	STAssertEquals([self selectedRow], (NSUInteger)11, nil);
+	[self tick];
+	STAssertEquals([self selectedRow], (NSUInteger)11, @"the tick mustn't move back to the dropped target");
+}
+
+- (void)testRepeatNotificationsAreDeferred
+{
+	_table.keyRepeatSelectionNotificationDelay = 0.05;
+	[self selectRow:0];
+	
+	[self press:NSDownArrowFunctionKey modifiers:0 repeat:YES];
+	[self tick];
+	[self tick];
+	[self press:NSDownArrowFunctionKey modifiers:0 repeat:YES];
+	[self tick];
+	STAssertEquals([self selectedRow], (NSUInteger)2, @"the selection moves right away");
+	STAssertEqualObjects(_notifications, [NSArray array], @"the delegate hears once the repeats pause");
+	
+	usleep(60 * 1000);
+	[self tick];
+	STAssertEqualObjects(_notifications, ([NSArray arrayWithObjects:@"-0", @"+2", nil]), @"once, for the net change");
+}
+
+- (void)testKeyDownSendsDeferredNotificationsFirst
+{
+	_table.keyRepeatSelectionNotificationDelay = 10.0;
+	[self selectRow:0];
+	[self press:NSDownArrowFunctionKey modifiers:0 repeat:YES];
+	[self tick];
+	[self tick];
+	[self press:NSDownArrowFunctionKey modifiers:0 repeat:YES];
+	[self tick];
+	[self tick];
+	STAssertEqualObjects(_notifications, [NSArray array], nil);
+	
+	[self press:NSDownArrowFunctionKey modifiers:0 repeat:NO];
+	STAssertEquals([self selectedRow], (NSUInteger)3, nil);
+	STAssertEqualObjects(_notifications, ([NSArray arrayWithObjects:@"-0", @"+2", @"-2", @"+3", nil]), @"in order");
+}
+
+- (void)testSelectingDirectlySendsDeferredNotificationsFirst
+{
+	_table.keyRepeatSelectionNotificationDelay = 10.0;
+	[self selectRow:0];
+	[self press:NSDownArrowFunctionKey modifiers:0 repeat:YES];
+	[_table selectRowAtIndexPath:[TUIFastIndexPath indexPathForRow:7 inSection:0] animated:NO scrollPosition:TUITableViewScrollPositionNone];
+	STAssertEqualObjects(_notifications, ([NSArray arrayWithObjects:@"-0", @"+1", @"-1", @"+7", nil]), nil);
+}
+
+#pragma mark Paging
+
+- (void)testOptionArrowsPage
+{
+	[self selectRow:0];
+	[self press:NSDownArrowFunctionKey modifiers:NSAlternateKeyMask repeat:NO];
+	STAssertEquals([self selectedRow], (NSUInteger)10, @"a screenful, 10 rows");
+	[self tick];
+	[self press:NSDownArrowFunctionKey modifiers:NSAlternateKeyMask repeat:NO];
+	STAssertEquals([self selectedRow], (NSUInteger)20, nil);
+	[self tick];
+	[self press:NSUpArrowFunctionKey modifiers:NSAlternateKeyMask repeat:NO];
+	STAssertEquals([self selectedRow], (NSUInteger)10, nil);
+	
+	[self selectRow:ROW_COUNT - 5];
+	[self press:NSDownArrowFunctionKey modifiers:NSAlternateKeyMask repeat:NO];
+	STAssertEquals([self selectedRow], (NSUInteger)ROW_COUNT - 1, @"a page past the end stops on the last row");
+	[self selectRow:3];
+	[self press:NSUpArrowFunctionKey modifiers:NSAlternateKeyMask repeat:NO];
+	STAssertEquals([self selectedRow], (NSUInteger)0, nil);
+}
+
+- (void)testCommandArrowsJumpToTheEnds
+{
+	[self selectRow:40];
+	[self press:NSDownArrowFunctionKey modifiers:NSCommandKeyMask repeat:NO];
+	STAssertEquals([self selectedRow], (NSUInteger)ROW_COUNT - 1, nil);
+	[self tick];
+	[self press:NSUpArrowFunctionKey modifiers:NSCommandKeyMask repeat:NO];
+	STAssertEquals([self selectedRow], (NSUInteger)0, nil);
+}
+
+@end
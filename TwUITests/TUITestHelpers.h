@@ -0,0 +1,21 @@
+//
+//  TUITestHelpers.h
+//  TwUITests
+//
+
+#import <Foundation/Foundation.h>
+
+@class TUIImage;
+
+/*
+ Fixtures shared by the test cases.
+ */
+
+extern TUIImage *TUITestImage(size_t width, size_t height); // transparent
+extern NSData *TUITestPNG(size_t width, size_t height); // random pixels, so the data doesn't compress away
+extern NSData *TUITestGIF(NSArray *delays); // 16x16 frames, one per delay (NSNumber seconds)
+
+/**
+ Runs the main run loop until 'condition' holds, NO if it didn't within 5s.
+ */
+extern BOOL TUITestWaitFor(BOOL (^condition)(void));
@@ -0,0 +1,74 @@
+//
+//  TUITestHelpers.m
+//  TwUITests
+//
+
+#import "TUITestHelpers.h"
+#import <TwUI/TUIKit.h>
+
+TUIImage *TUITestImage(size_t width, size_t height)
+{
+	CGContextRef ctx = TUICreateGraphicsContext(CGSizeMake(width, height));
+	CGImageRef i = CGBitmapContextCreateImage(ctx);
+	TUIImage *image = [TUIImage imageWithCGImage:i];
+	CGImageRelease(i);
+	CGContextRelease(ctx);
+	return image;
+}
+
+static NSData *TUITestEncode(CFStringRef type, NSArray *images, NSArray *properties)
+{
+	NSMutableData *data = [NSMutableData data];
+	CGImageDestinationRef destination = CGImageDestinationCreateWithData((__bridge CFMutableDataRef)data, type, [images count], NULL);
+	for(NSUInteger i = 0; i < [images count]; ++i)
+		CGImageDestinationAddImage(destination, (__bridge CGImageRef)[images objectAtIndex:i], properties ? (__bridge CFDictionaryRef)[properties objectAtIndex:i] : NULL);
+	CGImageDestinationFinalize(destination);
+	CFRelease(destination);
+	return data;
+}
+
+NSData *TUITestPNG(size_t width, size_t height)
+{
+	CGContextRef ctx = TUICreateGraphicsContext(CGSizeMake(width, height));
+	srandom(1);
+	for(size_t y = 0; y < height; ++y) {
+		for(size_t x = 0; x < width; ++x) {
+			CGContextSetRGBFillColor(ctx, (random() % 256) / 255.0, (random() % 256) / 255.0, (random() % 256) / 255.0, 1);
+			CGContextFillRect(ctx, CGRectMake(x, y, 1, 1));
+		}
+	}
+	CGImageRef image = CGBitmapContextCreateImage(ctx);
+	NSData *data = TUITestEncode(kUTTypePNG, [NSArray arrayWithObject:(__bridge id)image], nil);
+	CGImageRelease(image);
+	CGContextRelease(ctx);
+	return data;
+}
+
+NSData *TUITestGIF(NSArray *delays)
+{
+	NSMutableArray *images = [NSMutableArray arrayWithCapacity:[delays count]];
+	NSMutableArray *properties = [NSMutableArray arrayWithCapacity:[delays count]];
+	for(NSUInteger i = 0; i < [delays count]; ++i) {
+		CGContextRef ctx = TUICreateGraphicsContext(CGSizeMake(16, 16));
+		CGContextSetGrayFillColor(ctx, (CGFloat)i / [delays count], 1);
+		CGContextFillRect(ctx, CGRectMake(0, 0, 16, 16));
+		CGImageRef image = CGBitmapContextCreateImage(ctx);
+		[images addObject:(__bridge id)image];
+		CGImageRelease(image);
+		CGContextRelease(ctx);
+		NSDictionary *gif = [NSDictionary dictionaryWithObject:[delays objectAtIndex:i] forKey:(__bridge NSString *)kCGImagePropertyGIFDelayTime];
+		[properties addObject:[NSDictionary dictionaryWithObject:gif forKey:(__bridge NSString *)kCGImagePropertyGIFDictionary]];
+	}
+	return TUITestEncode(kUTTypeGIF, images, properties);
+}
+
+BOOL TUITestWaitFor(BOOL (^condition)(void))
+{
+	NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:5.0];
+	while(!condition()) {
+		if([deadline timeIntervalSinceNow] < 0)
+			return NO;
+		[[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+	}
+	return YES;
+}
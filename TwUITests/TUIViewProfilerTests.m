@@ -0,0 +1,105 @@
+//
+//  TUIViewProfilerTests.m
+//  TwUITests
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import <TwUI/TUIKit.h>
+
+#define TUIViewProfilerTestsCapacity 65536 // TUIViewProfilerCapacity
+
+@interface TUIViewProfilerTests : SenTestCase
+{
+	BOOL wasEnabled;
+}
+@end
+
+@implementation TUIViewProfilerTests
+
+- (void)setUp
+{
+	[super setUp];
+	wasEnabled = [TUIViewProfiler isEnabled];
+	[TUIViewProfiler setEnabled:YES];
+	[TUIViewProfiler reset];
+}
+
+- (void)tearDown
+{
+	[TUIViewProfiler reset];
+	[TUIViewProfiler setEnabled:wasEnabled];
+	[super tearDown];
+}
+
+// trace events recorded for this class, anything else drawing meanwhile is left out
+- (NSArray *)traceEvents
+{
+	NSDictionary *trace = [NSJSONSerialization JSONObjectWithData:[TUIViewProfiler chromeTraceData] options:0 error:NULL];
+	NSString *category = NSStringFromClass([self class]);
+	return [[trace objectForKey:@"traceEvents"] filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"cat == %@", category]];
+}
+
+- (void)testTraceOfRecordedIntervals
+{
+	uint64_t t = TUIProfileBegin();
+	STAssertTrue(t != 0, @"enabled, Begin returns the time");
+	t = TUIProfileEnd(TUIProfileDisplaySetup, self, t);
+	TUIProfileEnd(TUIProfileDrawRect, self, t);
+	
+	NSArray *events = [self traceEvents];
+	STAssertEquals([events count], (NSUInteger)2, nil);
+	STAssertEqualObjects([[events objectAtIndex:0] objectForKey:@"name"], @"display setup", nil);
+	STAssertEqualObjects([[events objectAtIndex:1] objectForKey:@"name"], @"drawRect", nil);
+	STAssertEqualObjects([[events objectAtIndex:0] objectForKey:@"ph"], @"X", nil);
+	
+	NSDictionary *kinds = [[TUIViewProfiler aggregates] objectForKey:NSStringFromClass([self class])];
+	STAssertEquals([[[kinds objectForKey:@"drawRect"] objectForKey:@"count"] unsignedIntegerValue], (NSUInteger)1, nil);
+}
+
+- (void)testDisabledRecordsNothing
+{
+	[TUIViewProfiler setEnabled:NO];
+	uint64_t t = TUIProfileBegin();
+	STAssertEquals(t, (uint64_t)0, nil);
+	TUIProfileEnd(TUIProfileLayoutSubviews, self, t);
+	STAssertEquals([[self traceEvents] count], (NSUInteger)0, nil);
+}
+
+- (void)testRingBufferKeepsNewestRecordsInOrder
+{
+	NSUInteger extra = 100;
+	NSUInteger total = TUIViewProfilerTestsCapacity + extra;
+	for(NSUInteger i = 0; i < total; ++i)
+		_TUIProfileRecord(TUIProfileLayoutSubviews, self, 1000 * (i + 1)); // start times identify each record
+	
+	NSArray *events = [self traceEvents];
+	STAssertEquals([events count], (NSUInteger)TUIViewProfilerTestsCapacity, @"the oldest records were overwritten");
+	
+	double previous = -1.0;
+	BOOL ordered = YES;
+	for(NSDictionary *e in events) {
+		double ts = [[e objectForKey:@"ts"] doubleValue];
+		ordered = ordered && ts > previous;
+		previous = ts;
+	}
+	STAssertTrue(ordered, @"oldest first");
+	
+	// the first surviving record is the one after the overwritten ones
+	mach_timebase_info_data_t info;
+	mach_timebase_info(&info);
+	double firstStart = 1000.0 * (extra + 1) * info.numer / info.denom / 1000.0; // microseconds
+	STAssertEqualsWithAccuracy([[[events objectAtIndex:0] objectForKey:@"ts"] doubleValue], firstStart, 0.01, nil);
+	
+	NSDictionary *kinds = [[TUIViewProfiler aggregates] objectForKey:NSStringFromClass([self class])];
+	STAssertEquals([[[kinds objectForKey:@"layoutSubviews"] objectForKey:@"count"] unsignedIntegerValue], (NSUInteger)TUIViewProfilerTestsCapacity, nil);
+}
+
+- (void)testReset
+{
+	TUIProfileEnd(TUIProfileDrawRect, self, TUIProfileBegin());
+	[TUIViewProfiler reset];
+	STAssertEquals([[self traceEvents] count], (NSUInteger)0, nil);
+	STAssertNil([[TUIViewProfiler aggregates] objectForKey:NSStringFromClass([self class])], nil);
+}
+
+@end
@@ -0,0 +1,220 @@
+/*
+ Copyright 2011 Twitter, Inc.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+
+/*
+ Benchmarks the TUIImage (Drawing) pixel kernels, and checks that the SSE2/NEON
+ paths match the scalar ones bit for bit. Builds as plain C, so it runs on Linux:
+ 
+	cc -O2 -std=gnu99 -Wno-deprecated -I../../lib/UIKit -x c ../../lib/UIKit/TUIPixelKernels.m -x none main.c -lm -o pixelbench
+	./pixelbench [width height [iterations]]
+ 
+ Exits with 1 if any vector path differs from its scalar path.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include "TUIPixelKernels.h"
+
+static size_t width = 1024;
+static size_t height = 1024;
+static int iterations = 20;
+static int failures = 0;
+
+static double Now(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static TUIPixelBuffer PixelBuffer(size_t w, size_t h)
+{
+	TUIPixelBuffer b = {malloc(w * h * 4), w, h, w * 4};
+	for(size_t i = 0; i < w * h; ++i) {
+		// premultiplied, no channel above alpha
+		uint32_t a = (uint32_t)(random() & 0xff);
+		uint32_t p = a << 24;
+		for(int c = 0; c < 24; c += 8)
+			p |= (uint32_t)(random() % (a + 1)) << c;
+		b.data[i] = p;
+	}
+	return b;
+}
+
+static TUIAlphaBuffer AlphaBuffer(size_t w, size_t h)
+{
+	TUIAlphaBuffer b = {malloc(w * h), w, h, w};
+	for(size_t i = 0; i < w * h; ++i)
+		b.data[i] = (uint8_t)random();
+	return b;
+}
+
+static TUIPixelBuffer Copy(TUIPixelBuffer b)
+{
+	TUIPixelBuffer c = b;
+	c.data = malloc(b.bytesPerRow * b.height);
+	memcpy(c.data, b.data, b.bytesPerRow * b.height);
+	return c;
+}
+
+// runs 'kernel' on a fresh copy of 'input' each iteration, the copy isn't timed
+static double Time(void (*kernel)(TUIPixelBuffer, void *), TUIPixelBuffer input, void *context, TUIPixelBuffer *output)
+{
+	double total = 0;
+	for(int i = 0; i < iterations; ++i) {
+		memcpy(output->data, input.data, input.bytesPerRow * input.height);
+		double start = Now();
+		kernel(*output, context);
+		total += Now() - start;
+	}
+	return total / iterations;
+}
+
+static void Report(const char *name, size_t pixels, double vector, double scalar, TUIPixelBuffer a, TUIPixelBuffer b)
+{
+	const char *result = "";
+	if(a.data && b.data) {
+		result = memcmp(a.data, b.data, a.bytesPerRow * a.height) == 0 ? "exact" : "MISMATCH";
+		if(result[0] == 'M')
+			++failures;
+	}
+	if(scalar > 0)
+		printf("%-20s %8.3f ms %8.1f Mpix/s   scalar %8.3f ms   %5.2fx   %s\n", name, vector * 1e3, pixels / vector * 1e-6, scalar * 1e3, scalar / vector, result);
+	else
+		printf("%-20s %8.3f ms %8.1f Mpix/s   (scalar only)\n", name, vector * 1e3, pixels / vector * 1e-6);
+}
+
+// both paths of one kernel on the same input
+static void Compare(const char *name, void (*kernel)(TUIPixelBuffer, void *), TUIPixelBuffer input, void *context, size_t outWidth, size_t outHeight)
+{
+	TUIPixelBuffer vector = {malloc(MAX(input.bytesPerRow * input.height, outWidth * outHeight * 4)), input.width, input.height, input.bytesPerRow};
+	TUIPixelBuffer scalar = vector;
+	scalar.data = malloc(MAX(input.bytesPerRow * input.height, outWidth * outHeight * 4));
+	
+	TUIPixelKernelsForceScalar = NO;
+	double v = Time(kernel, input, context, &vector);
+	TUIPixelKernelsForceScalar = YES;
+	double s = Time(kernel, input, context, &scalar);
+	TUIPixelKernelsForceScalar = NO;
+	
+	vector.width = scalar.width = outWidth;
+	vector.height = scalar.height = outHeight;
+	vector.bytesPerRow = scalar.bytesPerRow = outWidth * 4;
+	Report(name, outWidth * outHeight, v, s, vector, scalar);
+	free(vector.data);
+	free(scalar.data);
+}
+
+static void MultiplyByMask(TUIPixelBuffer b, void *mask)
+{
+	TUIPixelBufferMultiplyByMask(b, *(TUIAlphaBuffer *)mask);
+}
+
+static void InvertAlpha(TUIPixelBuffer b, void *context)
+{
+	TUIPixelBufferInvertAlpha(b, b);
+}
+
+static void EmbossAlpha(TUIPixelBuffer b, void *src)
+{
+	TUIPixelBufferEmbossAlpha(b, *(TUIPixelBuffer *)src, 1, -1);
+}
+
+static void RoundCorners(TUIPixelBuffer b, void *radius)
+{
+	TUIPixelBufferRoundCorners(b, *(NSUInteger *)radius);
+}
+
+static void ScaleBy(const char *name, TUIPixelBuffer src, double factor)
+{
+	size_t w = (size_t)(src.width * factor);
+	size_t h = (size_t)(src.height * factor);
+	TUIPixelBuffer vector = {malloc(w * h * 4), w, h, w * 4};
+	TUIPixelBuffer scalar = {malloc(w * h * 4), w, h, w * 4};
+	double v = 0, s = 0;
+	
+	for(int i = 0; i < iterations; ++i) {
+		TUIPixelKernelsForceScalar = NO;
+		double start = Now();
+		TUIPixelBufferScaleBilinear(vector, src);
+		v += Now() - start;
+		TUIPixelKernelsForceScalar = YES;
+		start = Now();
+		TUIPixelBufferScaleBilinear(scalar, src);
+		s += Now() - start;
+	}
+	TUIPixelKernelsForceScalar = NO;
+	
+	Report(name, w * h, v / iterations, s / iterations, vector, scalar);
+	free(vector.data);
+	free(scalar.data);
+}
+
+int main(int argc, const char *argv[])
+{
+	if(argc >= 3) {
+		width = (size_t)atol(argv[1]);
+		height = (size_t)atol(argv[2]);
+	}
+	if(argc >= 4)
+		iterations = atoi(argv[3]);
+	if(width < 2 || height < 2 || iterations < 1) {
+		fprintf(stderr, "usage: %s [width height [iterations]]\n", argv[0]);
+		return 2;
+	}
+	
+	srandom(1);
+	size_t pixels = width * height;
+	TUIPixelBuffer src = PixelBuffer(width, height);
+	TUIAlphaBuffer mask = AlphaBuffer(width, height);
+	printf("%lux%lu, %d iterations\n", (unsigned long)width, (unsigned long)height, iterations);
+	
+	Compare("multiply by mask", MultiplyByMask, src, &mask, width, height);
+	Compare("invert alpha", InvertAlpha, src, NULL, width, height);
+	Compare("emboss alpha", EmbossAlpha, src, &src, width, height);
+	ScaleBy("scale 0.6x", src, 0.6);
+	ScaleBy("scale 1.5x", src, 1.5);
+	
+	NSUInteger radius = MIN(width, height) / 8;
+	TUIPixelBuffer rounded = Copy(src);
+	double start = Now();
+	for(int i = 0; i < iterations; ++i)
+		RoundCorners(rounded, &radius);
+	Report("round corners", pixels, (Now() - start) / iterations, 0, (TUIPixelBuffer){0}, (TUIPixelBuffer){0});
+	
+	TUIAlphaBuffer shape = AlphaBuffer(width, height);
+	TUIAlphaBuffer fill = AlphaBuffer(width, height);
+	TUIAlphaBuffer blurred = AlphaBuffer(width, height);
+	
+	start = Now();
+	for(int i = 0; i < iterations; ++i)
+		TUIAlphaBufferFromPixelBuffer(blurred, src, YES, 2, -2, 0);
+	Report("alpha plane", pixels, (Now() - start) / iterations, 0, (TUIPixelBuffer){0}, (TUIPixelBuffer){0});
+	
+	start = Now();
+	for(int i = 0; i < iterations; ++i)
+		TUIAlphaBufferBoxBlur(blurred, 4, 3);
+	Report("box blur r4 x3", pixels, (Now() - start) / iterations, 0, (TUIPixelBuffer){0}, (TUIPixelBuffer){0});
+	
+	TUIPixelBuffer composite = Copy(src);
+	start = Now();
+	for(int i = 0; i < iterations; ++i)
+		TUIPixelBufferCompositeInnerShadow(composite, shape, fill, blurred, 0x80000000, 0xffe0e0e0);
+	Report("inner shadow", pixels, (Now() - start) / iterations, 0, (TUIPixelBuffer){0}, (TUIPixelBuffer){0});
+	
+	return failures ? 1 : 0;
+}
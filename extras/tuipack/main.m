@@ -0,0 +1,46 @@
+/*
+ Copyright 2011 Twitter, Inc.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+/*
+ Packs images into a TUIAssetPack, run it as a build phase and bundle the
+ output as TUIAssets.tuipack:
+ 
+	tuipack TUIAssets.tuipack Images/*.png
+ 
+ Build against the TwUI framework:
+ 
+	clang -fobjc-arc -F<dir containing TwUI.framework> -framework TwUI -framework Cocoa main.m -o tuipack
+ */
+
+#import <Cocoa/Cocoa.h>
+#import <TwUI/TUIKit.h>
+
+int main(int argc, const char *argv[])
+{
+	@autoreleasepool {
+		if(argc < 3) {
+			fprintf(stderr, "usage: %s output.tuipack image ...\n", argv[0]);
+			return 1;
+		}
+		
+		NSMutableArray *imageURLs = [NSMutableArray array];
+		for(int i = 2; i < argc; ++i)
+			[imageURLs addObject:[NSURL fileURLWithPath:[NSString stringWithUTF8String:argv[i]]]];
+		
+		NSURL *output = [NSURL fileURLWithPath:[NSString stringWithUTF8String:argv[1]]];
+		return [TUIAssetPack writePackToURL:output withImagesAtURLs:imageURLs] ? 0 : 1;
+	}
+}
@@ -0,0 +1,62 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIImage.h"
+
+/**
+ A multi-frame image (GIF) that plays back without holding every decoded
+ frame. A background decoder keeps a bounded ring of frames decoded ahead of
+ the playhead; frames behind it are dropped. Decoding is driven by
+ -bufferedFrameAtIndex:, so an animation nobody asks frames of decodes nothing.
+ 
+ As a plain TUIImage it is the first frame. TUIImageView plays animated
+ images automatically while it is in a window and not hidden, driven by
+ +[TUIFrameClock sharedClock].
+ */
+@interface TUIAnimatedImage : TUIImage
+
+/**
+ nil if the data has fewer than two frames, use +[TUIImage imageWithData:] for those.
+ */
++ (TUIAnimatedImage *)animatedImageWithData:(NSData *)data;
+- (id)initWithData:(NSData *)data;
+
+@property (nonatomic, readonly) NSUInteger frameCount;
+@property (nonatomic, readonly) NSTimeInterval duration; // of one loop
+@property (nonatomic, readonly) NSUInteger loopCount; // 0 means forever
+
+/**
+ Upper bound on the decoded bytes kept in the ring, default 4MB. At least two
+ frames are always kept. If every frame fits, each is decoded only once.
+ */
+@property (nonatomic, assign) NSUInteger maxBufferedBytes;
+@property (nonatomic, readonly) NSUInteger bufferedFrameCount; // frames currently decoded
+
+- (NSTimeInterval)delayAtIndex:(NSUInteger)index;
+
+/**
+ Frame showing 'time' seconds into playback, wrapping at 'duration'.
+ */
+- (NSUInteger)frameIndexForTime:(NSTimeInterval)time;
+
+/**
+ The decoded frame if it's in the ring, or nil if the decoder hasn't got to it
+ yet (keep showing the previous frame). Also moves the playhead to 'index', so
+ the decoder works on the frames after it. Main thread.
+ */
+- (TUIImage *)bufferedFrameAtIndex:(NSUInteger)index;
+
+@end
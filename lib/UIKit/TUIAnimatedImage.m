@@ -0,0 +1,275 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIAnimatedImage.h"
+#import <pthread.h>
+
+#define TUIAnimatedImageDefaultMaxBufferedBytes (4 * 1024 * 1024)
+#define TUIAnimatedImageMinimumDelay 0.02 // browsers treat anything shorter as "unspecified"
+#define TUIAnimatedImageDefaultDelay 0.1
+
+static NSTimeInterval TUIAnimatedImageDelayAtIndex(CGImageSourceRef source, size_t index)
+{
+	NSTimeInterval delay = TUIAnimatedImageDefaultDelay;
+	CFDictionaryRef properties = CGImageSourceCopyPropertiesAtIndex(source, index, NULL);
+	if(properties) {
+		NSDictionary *gif = (__bridge NSDictionary *)CFDictionaryGetValue(properties, kCGImagePropertyGIFDictionary);
+		NSNumber *d = [gif objectForKey:(__bridge NSString *)kCGImagePropertyGIFUnclampedDelayTime];
+		if(!d || [d doubleValue] <= 0)
+			d = [gif objectForKey:(__bridge NSString *)kCGImagePropertyGIFDelayTime];
+		if(d && [d doubleValue] >= TUIAnimatedImageMinimumDelay)
+			delay = [d doubleValue];
+		CFRelease(properties);
+	}
+	return delay;
+}
+
+@interface TUIAnimatedImage ()
+{
+	CGImageSourceRef _source;
+	NSUInteger _frameCount;
+	NSUInteger _loopCount;
+	NSTimeInterval *_frameStarts; // _frameCount + 1 entries, the last one is the duration
+	NSUInteger _maxBufferedBytes;
+	
+	pthread_mutex_t _lock; // guards the following
+	NSMutableDictionary *_frames; // NSNumber index -> TUIImage
+	NSUInteger _playhead;
+	NSUInteger _capacity;
+	BOOL _decoding;
+}
+@end
+
+@implementation TUIAnimatedImage
+
++ (TUIAnimatedImage *)animatedImageWithData:(NSData *)data
+{
+	return [[self alloc] initWithData:data];
+}
+
+- (id)initWithData:(NSData *)data
+{
+	if(!data)
+		return nil;
+	
+	CGImageSourceRef source = CGImageSourceCreateWithData((__bridge CFDataRef)data, NULL);
+	if(!source)
+		return nil;
+	
+	size_t count = CGImageSourceGetCount(source);
+	CGImageRef first = count > 1 ? CGImageSourceCreateImageAtIndex(source, 0, NULL) : NULL;
+	if(!first) {
+		CFRelease(source);
+		return nil;
+	}
+	
+	self = [super initWithCGImage:first];
+	CGImageRelease(first);
+	if(!self) {
+		CFRelease(source);
+		return nil;
+	}
+	
+	_source = source;
+	_frameCount = count;
+	_frameStarts = malloc(sizeof(NSTimeInterval) * (count + 1));
+	_frameStarts[0] = 0.0;
+	for(size_t i = 0; i < count; ++i)
+		_frameStarts[i + 1] = _frameStarts[i] + TUIAnimatedImageDelayAtIndex(source, i);
+	
+	CFDictionaryRef properties = CGImageSourceCopyProperties(source, NULL);
+	if(properties) {
+		NSDictionary *gif = (__bridge NSDictionary *)CFDictionaryGetValue(properties, kCGImagePropertyGIFDictionary);
+		_loopCount = [[gif objectForKey:(__bridge NSString *)kCGImagePropertyGIFLoopCount] unsignedIntegerValue];
+		CFRelease(properties);
+	}
+	
+	pthread_mutex_init(&_lock, NULL);
+	_frames = [[NSMutableDictionary alloc] init];
+	self.maxBufferedBytes = TUIAnimatedImageDefaultMaxBufferedBytes;
+	return self;
+}
+
+- (void)dealloc
+{
+	// the decode block retains self, so it can't be running now
+	if(_source)
+		CFRelease(_source);
+	free(_frameStarts);
+	pthread_mutex_destroy(&_lock);
+}
+
+- (NSUInteger)frameCount
+{
+	return _frameCount;
+}
+
+- (NSTimeInterval)duration
+{
+	return _frameStarts[_frameCount];
+}
+
+- (NSUInteger)loopCount
+{
+	return _loopCount;
+}
+
+- (NSUInteger)maxBufferedBytes
+{
+	return _maxBufferedBytes;
+}
+
+- (void)setMaxBufferedBytes:(NSUInteger)bytes
+{
+	_maxBufferedBytes = bytes;
+	
+	CGSize s = self.size;
+	NSUInteger frameBytes = MAX((NSUInteger)(s.width * s.height * 4), 1);
+	pthread_mutex_lock(&_lock);
+	_capacity = MIN(MAX(bytes / frameBytes, 2), _frameCount);
+	pthread_mutex_unlock(&_lock);
+}
+
+- (NSUInteger)bufferedFrameCount
+{
+	pthread_mutex_lock(&_lock);
+	NSUInteger c = [_frames count];
+	pthread_mutex_unlock(&_lock);
+	return c;
+}
+
+- (NSTimeInterval)delayAtIndex:(NSUInteger)index
+{
+	if(index >= _frameCount)
+		return 0.0;
+	return _frameStarts[index + 1] - _frameStarts[index];
+}
+
+- (NSUInteger)frameIndexForTime:(NSTimeInterval)time
+{
+	NSTimeInterval duration = self.duration;
+	if(duration <= 0.0 || time <= 0.0)
+		return 0;
+	time = fmod(time, duration);
+	
+	NSUInteger lo = 0, hi = _frameCount - 1; // last frame whose start <= time
+	while(lo < hi) {
+		NSUInteger mid = (lo + hi + 1) / 2;
+		if(_frameStarts[mid] <= time)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	return lo;
+}
+
+/*
+ * The following must be called with _lock held.
+ */
+
+// distance from the playhead going forwards, wrapping at the end
+- (NSUInteger)_distanceFromPlayhead:(NSUInteger)index
+{
+	return (index + _frameCount - _playhead) % _frameCount;
+}
+
+- (NSInteger)_nextFrameToDecode
+{
+	for(NSUInteger i = 0; i < _capacity; ++i) {
+		NSUInteger index = (_playhead + i) % _frameCount;
+		if(![_frames objectForKey:[NSNumber numberWithUnsignedInteger:index]])
+			return index;
+	}
+	return -1;
+}
+
+- (void)_evictFramesOutsideWindow
+{
+	for(NSNumber *n in [_frames allKeys]) {
+		if([self _distanceFromPlayhead:[n unsignedIntegerValue]] >= _capacity)
+			[_frames removeObjectForKey:n];
+	}
+}
+
+/*
+ * Decoder
+ */
+
++ (dispatch_queue_t)_decodeQueue
+{
+	static dispatch_queue_t queue = NULL;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		// one at a time across all animations, so many GIFs on screen don't swamp the CPU
+		queue = dispatch_queue_create("com.twitter.TUIAnimatedImage.decode", NULL);
+		dispatch_set_target_queue(queue, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0));
+	});
+	return queue;
+}
+
+- (void)_decodeAhead
+{
+	for(;;) {
+		pthread_mutex_lock(&_lock);
+		NSInteger index = [self _nextFrameToDecode];
+		if(index < 0) {
+			_decoding = NO;
+			pthread_mutex_unlock(&_lock);
+			return;
+		}
+		pthread_mutex_unlock(&_lock);
+		
+		TUIImage *frame = nil;
+		CGImageRef image = CGImageSourceCreateImageAtIndex(_source, index, NULL);
+		if(image) {
+			frame = [[TUIImage imageWithCGImage:image] decodedImage];
+			CGImageRelease(image);
+		}
+		if(!frame)
+			frame = [TUIImage imageWithCGImage:_imageRef]; // hold the first frame rather than stall
+		
+		pthread_mutex_lock(&_lock);
+		if([self _distanceFromPlayhead:index] < _capacity) { // the playhead may have moved on while decoding
+			[_frames setObject:frame forKey:[NSNumber numberWithUnsignedInteger:index]];
+			[self _evictFramesOutsideWindow];
+		}
+		pthread_mutex_unlock(&_lock);
+	}
+}
+
+- (TUIImage *)bufferedFrameAtIndex:(NSUInteger)index
+{
+	if(index >= _frameCount)
+		return nil;
+	
+	pthread_mutex_lock(&_lock);
+	_playhead = index;
+	[self _evictFramesOutsideWindow];
+	TUIImage *frame = [_frames objectForKey:[NSNumber numberWithUnsignedInteger:index]];
+	BOOL start = !_decoding && [self _nextFrameToDecode] >= 0;
+	if(start)
+		_decoding = YES;
+	pthread_mutex_unlock(&_lock);
+	
+	if(start) {
+		dispatch_async([[self class] _decodeQueue], ^{
+			[self _decodeAhead];
+		});
+	}
+	return frame;
+}
+
+@end
@@ -0,0 +1,56 @@
+/*
+ Copyright 2011 Twitter, Inc.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class TUIImage;
+
+/**
+ A single file of pre-decoded images, built ahead of time (see extras/tuipack).
+ 
+ Pixels are stored premultiplied in host byte order with page aligned image
+ data, so the pack is memory mapped and images point straight at the mapped
+ pages: no I/O or decode until a page is touched, and the pages are shared
+ with every other process mapping the same file.
+ 
+ Pixels are drawn in sRGB whatever machine builds the pack, and the images
+ are tagged sRGB. Core Graphics converts an image to the screen's colour
+ space once, the first time it's drawn, and keeps the result with the image;
+ nothing is copied into +[TUIImageCache sharedCache].
+ 
+ +[TUIImage imageNamed:] looks in the main bundle's TUIAssets.tuipack, if
+ there is one, before reading individual files.
+ */
+@interface TUIAssetPack : NSObject
+
+/**
+ TUIAssets.tuipack in the main bundle's resources, nil if there isn't one.
+ */
++ (TUIAssetPack *)mainBundlePack;
+
+/**
+ Pack a set of image files. Images are keyed by file name (so "button@2x.png"
+ is its own entry). Returns NO and logs if a file can't be read or decoded.
+ */
++ (BOOL)writePackToURL:(NSURL *)url withImagesAtURLs:(NSArray *)imageURLs;
+
+- (id)initWithContentsOfURL:(NSURL *)url; // nil if the file isn't a valid pack for this architecture
+
+@property (nonatomic, readonly) NSArray *imageNames;
+
+- (TUIImage *)imageNamed:(NSString *)name; // thread safe
+
+@end
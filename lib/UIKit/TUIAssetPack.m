@@ -0,0 +1,235 @@
+/*
+ Copyright 2011 Twitter, Inc.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIAssetPack.h"
+#import "TUIImage.h"
+
+/*
+ File layout, all integers in host byte order:
+ 
+	TUIAssetPackHeader
+	TUIAssetPackEntry[entryCount]
+	UTF-8 names, not terminated
+	pixel data in sRGB, each image starting on a page boundary
+ */
+
+#define TUIAssetPackMagic 0x54554950 // 'TUIP'
+#define TUIAssetPackVersion 3
+#define TUIAssetPackPageSize 4096
+#define TUIAssetPackRowAlignment 64
+
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t byteOrderMark; // 0x01020304 as written, detects packs built for the other byte order
+	uint32_t entryCount;
+} TUIAssetPackHeader;
+
+typedef struct {
+	uint64_t nameOffset;
+	uint64_t dataOffset;
+	uint32_t nameLength;
+	uint32_t width;
+	uint32_t height;
+	uint32_t bytesPerRow;
+	uint32_t opaque;
+	uint32_t reserved;
+} TUIAssetPackEntry;
+
+static size_t TUIAssetPackAlign(size_t n, size_t alignment)
+{
+	return (n + (alignment - 1)) & ~(alignment - 1);
+}
+
+static void TUIAssetPackReleaseData(void *info, const void *data, size_t size)
+{
+	CFRelease(info); // the mapped NSData
+}
+
+/*
+ Packs are always drawn in sRGB, whatever the packing machine's screen, so
+ the same file is right everywhere and is built the same way every time.
+ */
+static CGColorSpaceRef TUIAssetPackColorSpace(void)
+{
+	static CGColorSpaceRef colorSpace = NULL;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		colorSpace = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+	});
+	return colorSpace;
+}
+
+@interface TUIAssetPack ()
+{
+	NSData *_data;
+	NSDictionary *_entries; // name -> NSNumber index
+}
+@end
+
+@implementation TUIAssetPack
+
++ (TUIAssetPack *)mainBundlePack
+{
+	static TUIAssetPack *pack = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		NSURL *url = [[NSBundle mainBundle] URLForResource:@"TUIAssets" withExtension:@"tuipack"];
+		if(url)
+			pack = [[TUIAssetPack alloc] initWithContentsOfURL:url];
+	});
+	return pack;
+}
+
+- (id)initWithContentsOfURL:(NSURL *)url
+{
+	if((self = [super init])) {
+		_data = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedAlways error:NULL];
+		if([_data length] < sizeof(TUIAssetPackHeader)) {
+			NSLog(@"could not map asset pack %@", url);
+			return nil;
+		}
+		
+		const uint8_t *bytes = [_data bytes];
+		size_t length = [_data length];
+		const TUIAssetPackHeader *header = (const TUIAssetPackHeader *)bytes;
+		if(header->magic != TUIAssetPackMagic || header->version != TUIAssetPackVersion || header->byteOrderMark != 0x01020304) {
+			NSLog(@"%@ is not an asset pack for this architecture", url);
+			return nil;
+		}
+		if(sizeof(TUIAssetPackHeader) + (uint64_t)header->entryCount * sizeof(TUIAssetPackEntry) > length) {
+			NSLog(@"asset pack %@ is truncated", url);
+			return nil;
+		}
+		
+		// only the index is touched here, pixel pages fault in when an image is drawn
+		const TUIAssetPackEntry *entries = (const TUIAssetPackEntry *)(bytes + sizeof(TUIAssetPackHeader));
+		NSMutableDictionary *index = [NSMutableDictionary dictionaryWithCapacity:header->entryCount];
+		for(uint32_t i = 0; i < header->entryCount; ++i) {
+			const TUIAssetPackEntry *e = &entries[i];
+			if(e->nameOffset + e->nameLength > length || e->dataOffset + (uint64_t)e->bytesPerRow * e->height > length || e->bytesPerRow < (uint64_t)e->width * 4) {
+				NSLog(@"asset pack %@ has a bad entry at %u", url, i);
+				return nil;
+			}
+			NSString *name = [[NSString alloc] initWithBytes:bytes + e->nameOffset length:e->nameLength encoding:NSUTF8StringEncoding];
+			if(name)
+				[index setObject:[NSNumber numberWithUnsignedInt:i] forKey:name];
+		}
+		_entries = [index copy];
+	}
+	return self;
+}
+
+- (NSArray *)imageNames
+{
+	return [_entries allKeys];
+}
+
+- (TUIImage *)imageNamed:(NSString *)name
+{
+	NSNumber *n = [_entries objectForKey:name];
+	if(!n)
+		return nil;
+	
+	const uint8_t *bytes = [_data bytes];
+	const TUIAssetPackEntry *e = (const TUIAssetPackEntry *)(bytes + sizeof(TUIAssetPackHeader)) + [n unsignedIntValue];
+	size_t size = (size_t)e->bytesPerRow * e->height;
+	
+	// the provider keeps the mapping alive for as long as the image exists. Tagged sRGB, Core Graphics
+	// colour matches the image the first time it's drawn to the screen's space and keeps that with the image
+	CGDataProviderRef provider = CGDataProviderCreateWithData((void *)CFBridgingRetain(_data), bytes + e->dataOffset, size, TUIAssetPackReleaseData);
+	CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Host | (e->opaque ? kCGImageAlphaNoneSkipFirst : kCGImageAlphaPremultipliedFirst);
+	CGImageRef image = CGImageCreate(e->width, e->height, 8, 32, e->bytesPerRow, TUIAssetPackColorSpace(), bitmapInfo, provider, NULL, false, kCGRenderingIntentDefault);
+	CGDataProviderRelease(provider);
+	if(!image)
+		return nil;
+	
+	TUIImage *i = [TUIImage imageWithCGImage:image];
+	CGImageRelease(image);
+	return i;
+}
+
++ (BOOL)writePackToURL:(NSURL *)url withImagesAtURLs:(NSArray *)imageURLs
+{
+	NSMutableArray *names = [NSMutableArray array];
+	NSMutableArray *images = [NSMutableArray array];
+	for(NSURL *imageURL in imageURLs) {
+		NSData *data = [NSData dataWithContentsOfURL:imageURL];
+		TUIImage *image = data ? [TUIImage imageWithData:data] : nil;
+		if(!image.CGImage) {
+			NSLog(@"could not decode %@", imageURL);
+			return NO;
+		}
+		[names addObject:[imageURL lastPathComponent]];
+		[images addObject:image];
+	}
+	
+	uint32_t count = (uint32_t)[images count];
+	NSMutableData *nameTable = [NSMutableData data];
+	size_t nameTableOffset = sizeof(TUIAssetPackHeader) + count * sizeof(TUIAssetPackEntry);
+	for(NSString *name in names)
+		[nameTable appendData:[name dataUsingEncoding:NSUTF8StringEncoding]];
+	
+	CGColorSpaceRef colorSpace = TUIAssetPackColorSpace();
+	NSMutableData *pack = [NSMutableData dataWithLength:TUIAssetPackAlign(nameTableOffset + [nameTable length], TUIAssetPackPageSize)];
+	TUIAssetPackHeader header = {TUIAssetPackMagic, TUIAssetPackVersion, 0x01020304, count};
+	[pack replaceBytesInRange:NSMakeRange(0, sizeof(header)) withBytes:&header];
+	[pack replaceBytesInRange:NSMakeRange(nameTableOffset, [nameTable length]) withBytes:[nameTable bytes]];
+	
+	size_t nameOffset = nameTableOffset;
+	for(uint32_t i = 0; i < count; ++i) {
+		CGImageRef image = [[images objectAtIndex:i] CGImage];
+		NSData *nameData = [[names objectAtIndex:i] dataUsingEncoding:NSUTF8StringEncoding];
+		size_t width = CGImageGetWidth(image);
+		size_t height = CGImageGetHeight(image);
+		size_t bytesPerRow = TUIAssetPackAlign(width * 4, TUIAssetPackRowAlignment);
+		CGImageAlphaInfo alpha = CGImageGetAlphaInfo(image);
+		BOOL opaque = (alpha == kCGImageAlphaNone || alpha == kCGImageAlphaNoneSkipFirst || alpha == kCGImageAlphaNoneSkipLast);
+		
+		TUIAssetPackEntry e;
+		memset(&e, 0, sizeof(e));
+		e.nameOffset = nameOffset;
+		e.nameLength = (uint32_t)[nameData length];
+		e.dataOffset = [pack length];
+		e.width = (uint32_t)width;
+		e.height = (uint32_t)height;
+		e.bytesPerRow = (uint32_t)bytesPerRow;
+		e.opaque = opaque;
+		[pack replaceBytesInRange:NSMakeRange(sizeof(header) + i * sizeof(e), sizeof(e)) withBytes:&e];
+		nameOffset += e.nameLength;
+		
+		// draw into the pack's own layout rather than trusting the layout of whatever the decoder produced
+		NSMutableData *dst = [NSMutableData dataWithLength:TUIAssetPackAlign(bytesPerRow * height, TUIAssetPackPageSize)];
+		CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Host | (opaque ? kCGImageAlphaNoneSkipFirst : kCGImageAlphaPremultipliedFirst);
+		CGContextRef ctx = CGBitmapContextCreate([dst mutableBytes], width, height, 8, bytesPerRow, colorSpace, bitmapInfo);
+		if(!ctx) {
+			NSLog(@"could not draw %@", [names objectAtIndex:i]);
+			return NO;
+		}
+		CGContextSetBlendMode(ctx, kCGBlendModeCopy);
+		CGContextDrawImage(ctx, CGRectMake(0, 0, width, height), image);
+		CGContextRelease(ctx);
+		[pack appendData:dst];
+	}
+	
+	if(![pack writeToURL:url atomically:YES]) {
+		NSLog(@"could not write asset pack to %@", url);
+		return NO;
+	}
+	return YES;
+}
+
+@end
@@ -16,6 +16,27 @@
 
 #import <Foundation/Foundation.h>
 
+/**
+ Colour space backing stores are created in and images are decoded into, so
+ drawing one into the other is a copy rather than a colour conversion.
+ Follows the main screen (updated when display settings change) unless set
+ explicitly; NULL goes back to following the screen. Posts
+ TUIBackingColorSpaceDidChangeNotification when it changes. Thread safe, the
+ returned colour space is never released.
+ */
+extern CGColorSpaceRef TUIGetBackingColorSpace(void);
+extern void TUISetBackingColorSpace(CGColorSpaceRef colorSpace);
+extern NSString *const TUIBackingColorSpaceDidChangeNotification;
+
+/**
+ Number of images drawn into a bitmap context of a different colour space
+ (each one converted by CoreGraphics at draw time) since the last reset. Only
+ TUIImage drawing is counted. Should stay at zero while scrolling.
+ */
+extern NSUInteger TUIGetDrawTimeColorConversionCount(void);
+extern void TUIResetDrawTimeColorConversionCount(void);
+extern void TUINoteImageDrawnInContext(CGImageRef image, CGContextRef context); // called by TUIImage drawing
+
 extern CGContextRef TUICreateOpaqueGraphicsContext(CGSize size);
 extern CGContextRef TUICreateGraphicsContext(CGSize size);
 extern CGContextRef TUICreateGraphicsContextWithOptions(CGSize size, BOOL opaque);
@@ -15,6 +15,124 @@
  */
 
 #import "TUICGAdditions.h"
+#import "TUIShapeCache.h"
+#import <libkern/OSAtomic.h>
+#import <pthread.h>
+
+NSString *const TUIBackingColorSpaceDidChangeNotification = @"TUIBackingColorSpaceDidChangeNotification";
+
+static pthread_mutex_t TUIBackingColorSpaceLock = PTHREAD_MUTEX_INITIALIZER;
+static CGColorSpaceRef TUIBackingColorSpace = NULL; // replaced ones are leaked on purpose, other threads may still be drawing with them
+static BOOL TUIBackingColorSpaceIsExplicit = NO;
+static volatile int32_t TUIDrawTimeColorConversionCount = 0;
+
+static void TUIUpdateBackingColorSpace(CGColorSpaceRef colorSpace, BOOL isExplicit)
+{
+	BOOL changed = NO;
+	pthread_mutex_lock(&TUIBackingColorSpaceLock);
+	if(isExplicit || !TUIBackingColorSpaceIsExplicit) {
+		TUIBackingColorSpaceIsExplicit = isExplicit;
+		if(!TUIBackingColorSpace || !CFEqual(TUIBackingColorSpace, colorSpace)) {
+			TUIBackingColorSpace = CGColorSpaceRetain(colorSpace);
+			changed = YES;
+		}
+	}
+	pthread_mutex_unlock(&TUIBackingColorSpaceLock);
+	
+	if(changed) {
+		dispatch_async(dispatch_get_main_queue(), ^{
+			[[NSNotificationCenter defaultCenter] postNotificationName:TUIBackingColorSpaceDidChangeNotification object:nil];
+		});
+	}
+}
+
+static CGColorSpaceRef TUICopyMainScreenColorSpace(void)
+{
+	CGColorSpaceRef colorSpace = [[[NSScreen mainScreen] colorSpace] CGColorSpace];
+	if(colorSpace && CGColorSpaceGetModel(colorSpace) == kCGColorSpaceModelRGB)
+		return CGColorSpaceRetain(colorSpace);
+	return CGColorSpaceCreateDeviceRGB();
+}
+
+static void TUIFollowMainScreenColorSpace(void)
+{
+	CGColorSpaceRef colorSpace = TUICopyMainScreenColorSpace();
+	TUIUpdateBackingColorSpace(colorSpace, NO);
+	CGColorSpaceRelease(colorSpace);
+}
+
+CGColorSpaceRef TUIGetBackingColorSpace(void)
+{
+	pthread_mutex_lock(&TUIBackingColorSpaceLock);
+	CGColorSpaceRef colorSpace = TUIBackingColorSpace;
+	pthread_mutex_unlock(&TUIBackingColorSpaceLock);
+	if(colorSpace)
+		return colorSpace;
+	
+	if(![NSThread isMainThread]) {
+		// NSScreen is main thread only; TUINSView looks this up early on the main thread, so this is rare
+		static CGColorSpaceRef deviceRGB = NULL;
+		static dispatch_once_t onceToken;
+		dispatch_once(&onceToken, ^{
+			deviceRGB = CGColorSpaceCreateDeviceRGB();
+		});
+		return deviceRGB;
+	}
+	
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		[[NSNotificationCenter defaultCenter] addObserverForName:NSApplicationDidChangeScreenParametersNotification object:nil queue:nil usingBlock:^(NSNotification *note) {
+			TUIFollowMainScreenColorSpace();
+		}];
+		// TUINSView asks its window to post this
+		[[NSNotificationCenter defaultCenter] addObserverForName:NSWindowDidChangeScreenProfileNotification object:nil queue:nil usingBlock:^(NSNotification *note) {
+			TUIFollowMainScreenColorSpace();
+		}];
+	});
+	TUIFollowMainScreenColorSpace();
+	
+	pthread_mutex_lock(&TUIBackingColorSpaceLock);
+	colorSpace = TUIBackingColorSpace;
+	pthread_mutex_unlock(&TUIBackingColorSpaceLock);
+	return colorSpace;
+}
+
+void TUISetBackingColorSpace(CGColorSpaceRef colorSpace)
+{
+	if(colorSpace) {
+		TUIUpdateBackingColorSpace(colorSpace, YES);
+	} else {
+		pthread_mutex_lock(&TUIBackingColorSpaceLock);
+		TUIBackingColorSpaceIsExplicit = NO;
+		pthread_mutex_unlock(&TUIBackingColorSpaceLock);
+		if([NSThread isMainThread])
+			TUIFollowMainScreenColorSpace();
+		else
+			dispatch_async(dispatch_get_main_queue(), ^{ TUIFollowMainScreenColorSpace(); });
+	}
+}
+
+NSUInteger TUIGetDrawTimeColorConversionCount(void)
+{
+	return (NSUInteger)TUIDrawTimeColorConversionCount;
+}
+
+void TUIResetDrawTimeColorConversionCount(void)
+{
+	OSAtomicAnd32Barrier(0, (volatile uint32_t *)&TUIDrawTimeColorConversionCount);
+}
+
+void TUINoteImageDrawnInContext(CGImageRef image, CGContextRef context)
+{
+	if(!image || !context)
+		return;
+	CGColorSpaceRef contextSpace = CGBitmapContextGetColorSpace(context); // NULL for PDF and window contexts, which we can't judge
+	CGColorSpaceRef imageSpace = CGImageGetColorSpace(image);
+	if(!contextSpace || !imageSpace || CGImageIsMask(image))
+		return;
+	if(contextSpace != imageSpace && !CFEqual(contextSpace, imageSpace))
+		OSAtomicIncrement32Barrier(&TUIDrawTimeColorConversionCount);
+}
 
 CGContextRef TUICreateOpaqueGraphicsContext(CGSize size)
 {
@@ -22,10 +140,8 @@ CGContextRef TUICreateOpaqueGraphicsContext(CGSize size)
 	size_t height = size.height;
 	size_t bitsPerComponent = 8;
 	size_t bytesPerRow = 4 * width;
-	CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
 	CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Host | kCGImageAlphaNoneSkipFirst;
-	CGContextRef ctx = CGBitmapContextCreate(NULL, width, height, bitsPerComponent, bytesPerRow, colorSpace, bitmapInfo);
-	CGColorSpaceRelease(colorSpace);
+	CGContextRef ctx = CGBitmapContextCreate(NULL, width, height, bitsPerComponent, bytesPerRow, TUIGetBackingColorSpace(), bitmapInfo);
 	return ctx;
 }
 
@@ -35,12 +151,10 @@ CGContextRef TUICreateGraphicsContext(CGSize size)
 	size_t height = size.height;
 	size_t bitsPerComponent = 8;
 	size_t bytesPerRow = 4 * width;
-	CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
 	// http://www.cocoTUIlder.com/archive/cocoa/228931-sub-pixel-font-smoothing-with-cgbitmapcontext.html
 	// http://developer.apple.com/mac/library/qa/qa2001/qa1037.html
 	CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Host | kCGImageAlphaPremultipliedFirst;
-	CGContextRef ctx = CGBitmapContextCreate(NULL, width, height, bitsPerComponent, bytesPerRow, colorSpace, bitmapInfo);
-	CGColorSpaceRelease(colorSpace);
+	CGContextRef ctx = CGBitmapContextCreate(NULL, width, height, bitsPerComponent, bytesPerRow, TUIGetBackingColorSpace(), bitmapInfo);
 	return ctx;
 }
 
@@ -135,10 +249,8 @@ void CGContextFillRoundRect(CGContextRef context, CGRect rect, CGFloat radius)
 
 void CGContextDrawLinearGradientBetweenPoints(CGContextRef context, CGPoint a, CGFloat color_a[4], CGPoint b, CGFloat color_b[4])
 {
-	CGColorSpaceRef colorspace = CGColorSpaceCreateDeviceRGB();
 	CGFloat components[] = { color_a[0], color_a[1], color_a[2], color_a[3], color_b[0], color_b[1], color_b[2], color_b[3] };
-	CGGradientRef gradient = CGGradientCreateWithColorComponents(colorspace, components, NULL, 2);
+	CGGradientRef gradient = TUICreateCachedGradient(components, NULL, 2);
 	CGContextDrawLinearGradient(context, gradient, a, b, 0);
-	CGColorSpaceRelease(colorspace);
 	CGGradientRelease(gradient);
 }
@@ -0,0 +1,141 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Cocoa/Cocoa.h>
+#include <mach/mach_time.h>
+
+@class TUIView;
+
+enum {
+	TUIDebugOverlayNone              = 0,
+	TUIDebugOverlayRedraw            = 1 << 0, // flash the rect each draw covered
+	TUIDebugOverlayBlending          = 1 << 1, // tint opaque views green, blended views red
+	TUIDebugOverlayDrawTime          = 1 << 2, // tint by how long drawRect took, yellow (fast) to red (slow)
+	TUIDebugOverlayLargeBackingStore = 1 << 3, // outline views whose backing store is over the threshold
+	TUIDebugOverlayBackgroundDrawing = 1 << 4, // mark views drawn off the main thread
+	TUIDebugOverlayAll               = 0x1f
+};
+typedef NSUInteger TUIDebugOverlayOptions;
+
+/**
+ Runtime replacement for the old compile time CA_COLOR_OVERLAY_DEBUG.
+ 
+ Overlays are painted over what a view drew, after -drawRect: returns, and
+ are part of its contents until it next draws. Views pick up a change of
+ options the next time they draw. The redraw flash is a short lived layer
+ above the view instead, so it goes away without drawing the view again.
+ 
+ Enable with +setOptions:, or launch with TUIDebugOverlays set to a comma
+ separated list of redraw, blending, drawtime, backingstore, background, or
+ all.
+ */
+@interface TUIDebugOverlay : NSObject
+
++ (TUIDebugOverlayOptions)options;
++ (void)setOptions:(TUIDebugOverlayOptions)options;
+
+/**
+ Parses the format of the TUIDebugOverlays environment variable. Unknown
+ names are ignored.
+ */
++ (TUIDebugOverlayOptions)optionsFromString:(NSString *)string;
+
+/**
+ Bytes of backing store above which TUIDebugOverlayLargeBackingStore
+ outlines a view. Default is 4MB, e.g. about 1024x1024 pixels.
+ */
++ (size_t)largeBackingStoreThreshold;
++ (void)setLargeBackingStoreThreshold:(size_t)bytes;
+
+/**
+ Draw time that TUIDebugOverlayDrawTime shows at full red. Default is one
+ frame at 60Hz.
+ */
++ (NSTimeInterval)drawTimeHeatMapMaximum;
++ (void)setDrawTimeHeatMapMaximum:(NSTimeInterval)seconds;
+
+@end
+
+/*
+ The overlay decisions are a pure function of the draw being decorated, so
+ they can be checked without a window, and so nothing measured depends on
+ how the overlays are painted.
+ */
+
+typedef struct {
+	CGRect bounds;          // points
+	CGRect dirtyRect;       // what this draw covered, in the same space as bounds
+	CGFloat scale;          // contentsScale
+	BOOL opaque;
+	BOOL drawnInBackground;
+	NSTimeInterval drawTime; // -drawRect: alone
+} TUIDebugOverlayDraw;
+
+typedef enum {
+	TUIDebugOverlayItemFill,
+	TUIDebugOverlayItemStroke,
+	TUIDebugOverlayItemFlash, // shown above the view for a moment, not painted into it
+} TUIDebugOverlayItemKind;
+
+typedef struct {
+	TUIDebugOverlayItemKind kind;
+	CGRect rect;
+	CGFloat lineWidth; // strokes only
+	CGFloat color[4];  // rgba
+} TUIDebugOverlayItem;
+
+#define TUIDebugOverlayMaximumItems 5
+
+typedef struct {
+	NSUInteger count;
+	TUIDebugOverlayItem items[TUIDebugOverlayMaximumItems]; // bottom to top
+} TUIDebugOverlayPlan;
+
+extern TUIDebugOverlayOptions TUIDebugOverlays;
+
+/**
+ Which overlays to show for 'draw'.
+ */
+extern TUIDebugOverlayPlan TUIDebugOverlayPlanForDraw(TUIDebugOverlayOptions options, TUIDebugOverlayDraw draw, size_t largeBackingStoreThreshold, NSTimeInterval drawTimeHeatMapMaximum);
+
+/**
+ Bytes of backing store for a view of 'bounds' at 'scale'.
+ */
+extern size_t TUIDebugOverlayBackingStoreSize(CGRect bounds, CGFloat scale);
+
+/**
+ Paints the fills and strokes of the plan into 'context' and schedules any
+ flashes over 'view'. Used by -[TUIView displayLayer:]. With a NULL 'context'
+ (contents set without drawing) only the flashes are shown.
+ */
+extern void TUIDebugOverlayApplyPlan(TUIDebugOverlayPlan plan, TUIView *view, CGContextRef context);
+
+extern void _TUIDebugOverlayDecorateDraw(TUIView *view, CGContextRef context, CGRect bounds, CGRect dirtyRect, CGFloat scale, uint64_t drawStart);
+
+/*
+ Used by -[TUIView displayLayer:]. Begin returns 0 while no overlay is on,
+ End paints the overlays for the draw started at 'drawStart' (unless 0).
+ */
+static inline uint64_t TUIDebugOverlayBeginDraw(void)
+{
+	return TUIDebugOverlays ? mach_absolute_time() : 0;
+}
+
+static inline void TUIDebugOverlayEndDraw(uint64_t drawStart, TUIView *view, CGContextRef context, CGRect bounds, CGRect dirtyRect, CGFloat scale)
+{
+	if(drawStart)
+		_TUIDebugOverlayDecorateDraw(view, context, bounds, dirtyRect, scale, drawStart);
+}
@@ -0,0 +1,225 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIDebugOverlay.h"
+#import "TUIKit.h"
+#import "TUIView.h"
+#import "TUINSView.h"
+#include <mach/mach_time.h>
+
+#define TUIDebugOverlayFlashDuration 0.25
+#define TUIDebugOverlayMarkerSize 6.0
+
+TUIDebugOverlayOptions TUIDebugOverlays = TUIDebugOverlayNone;
+
+static size_t TUIDebugOverlayLargeBackingStoreThreshold = 4 * 1024 * 1024;
+static NSTimeInterval TUIDebugOverlayDrawTimeHeatMapMaximum = 1.0 / 60.0;
+
+size_t TUIDebugOverlayBackingStoreSize(CGRect bounds, CGFloat scale)
+{
+	size_t width = (size_t)ceil(bounds.size.width * scale);
+	size_t height = (size_t)ceil(bounds.size.height * scale);
+	return width * height * 4;
+}
+
+static void TUIDebugOverlayPlanAdd(TUIDebugOverlayPlan *plan, TUIDebugOverlayItemKind kind, CGRect rect, CGFloat lineWidth, CGFloat r, CGFloat g, CGFloat b, CGFloat a)
+{
+	if(plan->count >= TUIDebugOverlayMaximumItems)
+		return;
+	TUIDebugOverlayItem *item = &plan->items[plan->count++];
+	item->kind = kind;
+	item->rect = rect;
+	item->lineWidth = lineWidth;
+	item->color[0] = r;
+	item->color[1] = g;
+	item->color[2] = b;
+	item->color[3] = a;
+}
+
+TUIDebugOverlayPlan TUIDebugOverlayPlanForDraw(TUIDebugOverlayOptions options, TUIDebugOverlayDraw draw, size_t largeBackingStoreThreshold, NSTimeInterval drawTimeHeatMapMaximum)
+{
+	TUIDebugOverlayPlan plan;
+	memset(&plan, 0, sizeof(plan));
+	if(CGRectIsEmpty(draw.bounds))
+		return plan;
+	
+	if(options & TUIDebugOverlayBlending) {
+		if(draw.opaque)
+			TUIDebugOverlayPlanAdd(&plan, TUIDebugOverlayItemFill, draw.bounds, 0.0, 0, 1, 0, 0.3);
+		else
+			TUIDebugOverlayPlanAdd(&plan, TUIDebugOverlayItemFill, draw.bounds, 0.0, 1, 0, 0, 0.3);
+	}
+	
+	if(options & TUIDebugOverlayDrawTime) {
+		CGFloat t = drawTimeHeatMapMaximum > 0.0 ? draw.drawTime / drawTimeHeatMapMaximum : 1.0;
+		t = MAX(0.0, MIN(t, 1.0));
+		TUIDebugOverlayPlanAdd(&plan, TUIDebugOverlayItemFill, draw.bounds, 0.0, 1, 1 - t, 0, 0.15 + 0.35 * t);
+	}
+	
+	if((options & TUIDebugOverlayLargeBackingStore) && TUIDebugOverlayBackingStoreSize(draw.bounds, draw.scale) > largeBackingStoreThreshold) {
+		// stroke is centered on the path, inset so it isn't half clipped
+		TUIDebugOverlayPlanAdd(&plan, TUIDebugOverlayItemStroke, CGRectInset(draw.bounds, 1.0, 1.0), 2.0, 1, 0, 1, 0.9);
+	}
+	
+	if((options & TUIDebugOverlayBackgroundDrawing) && draw.drawnInBackground) {
+		CGFloat size = MIN(TUIDebugOverlayMarkerSize, MIN(draw.bounds.size.width, draw.bounds.size.height));
+		CGRect marker = CGRectMake(CGRectGetMinX(draw.bounds), CGRectGetMaxY(draw.bounds) - size, size, size);
+		TUIDebugOverlayPlanAdd(&plan, TUIDebugOverlayItemFill, marker, 0.0, 0, 0.4, 1, 0.9);
+	}
+	
+	if(options & TUIDebugOverlayRedraw) {
+		CGRect dirty = CGRectIntersection(draw.dirtyRect, draw.bounds);
+		if(!CGRectIsEmpty(dirty))
+			TUIDebugOverlayPlanAdd(&plan, TUIDebugOverlayItemFlash, dirty, 0.0, 1, 0.8, 0, 0.5);
+	}
+	
+	return plan;
+}
+
+static void TUIDebugOverlayFlash(TUIView *view, TUIDebugOverlayItem item)
+{
+	// the TUINSView layer has no TUIView layout attached, adding to it doesn't relayout anything
+	CALayer *hostLayer = view.nsView.layer;
+	if(!hostLayer)
+		return;
+	
+	[CATransaction begin];
+	[CATransaction setDisableActions:YES];
+	CALayer *flash = [CALayer layer];
+	flash.frame = [hostLayer convertRect:item.rect fromLayer:view.layer];
+	CGColorRef color = CGColorCreateGenericRGB(item.color[0], item.color[1], item.color[2], item.color[3]);
+	flash.backgroundColor = color;
+	CGColorRelease(color);
+	flash.opacity = 0.0;
+	[hostLayer addSublayer:flash];
+	[CATransaction commit];
+	
+	CABasicAnimation *fade = [CABasicAnimation animationWithKeyPath:@"opacity"];
+	fade.fromValue = [NSNumber numberWithFloat:1.0f];
+	fade.toValue = [NSNumber numberWithFloat:0.0f];
+	fade.duration = TUIDebugOverlayFlashDuration;
+	[flash addAnimation:fade forKey:@"flash"];
+	[flash performSelector:@selector(removeFromSuperlayer) withObject:nil afterDelay:TUIDebugOverlayFlashDuration];
+}
+
+void TUIDebugOverlayApplyPlan(TUIDebugOverlayPlan plan, TUIView *view, CGContextRef context)
+{
+	if(context)
+		CGContextSaveGState(context);
+	for(NSUInteger i = 0; i < plan.count; ++i) {
+		TUIDebugOverlayItem item = plan.items[i];
+		if(!context && item.kind != TUIDebugOverlayItemFlash)
+			continue;
+		switch(item.kind) {
+			case TUIDebugOverlayItemFill:
+				CGContextSetRGBFillColor(context, item.color[0], item.color[1], item.color[2], item.color[3]);
+				CGContextFillRect(context, item.rect);
+				break;
+			case TUIDebugOverlayItemStroke:
+				CGContextSetRGBStrokeColor(context, item.color[0], item.color[1], item.color[2], item.color[3]);
+				CGContextStrokeRectWithWidth(context, item.rect, item.lineWidth);
+				break;
+			case TUIDebugOverlayItemFlash:
+				// may be drawing in the background, layers in the window belong to the main thread
+				dispatch_async(dispatch_get_main_queue(), ^{
+					TUIDebugOverlayFlash(view, item);
+				});
+				break;
+		}
+	}
+	if(context)
+		CGContextRestoreGState(context);
+}
+
+void _TUIDebugOverlayDecorateDraw(TUIView *view, CGContextRef context, CGRect bounds, CGRect dirtyRect, CGFloat scale, uint64_t drawStart)
+{
+	uint64_t drawEnd = mach_absolute_time();
+	static mach_timebase_info_data_t timebase;
+	if(timebase.denom == 0)
+		mach_timebase_info(&timebase);
+	
+	TUIDebugOverlayDraw draw;
+	draw.bounds = bounds;
+	draw.dirtyRect = dirtyRect;
+	draw.scale = scale;
+	draw.opaque = view.opaque;
+	draw.drawnInBackground = ![NSThread isMainThread];
+	draw.drawTime = (double)(drawEnd - drawStart) * timebase.numer / timebase.denom / NSEC_PER_SEC;
+	
+	TUIDebugOverlayPlan plan = TUIDebugOverlayPlanForDraw(TUIDebugOverlays, draw, TUIDebugOverlayLargeBackingStoreThreshold, TUIDebugOverlayDrawTimeHeatMapMaximum);
+	TUIDebugOverlayApplyPlan(plan, view, context);
+}
+
+@implementation TUIDebugOverlay
+
++ (void)load
+{
+	@autoreleasepool {
+		NSString *options = TUIEnvironmentValue(@"TUIDebugOverlays");
+		if(options)
+			[self setOptions:[self optionsFromString:options]];
+	}
+}
+
++ (TUIDebugOverlayOptions)options
+{
+	return TUIDebugOverlays;
+}
+
++ (void)setOptions:(TUIDebugOverlayOptions)options
+{
+	TUIDebugOverlays = options & TUIDebugOverlayAll;
+}
+
++ (TUIDebugOverlayOptions)optionsFromString:(NSString *)string
+{
+	NSDictionary *names = [NSDictionary dictionaryWithObjectsAndKeys:
+						   [NSNumber numberWithUnsignedInteger:TUIDebugOverlayRedraw], @"redraw",
+						   [NSNumber numberWithUnsignedInteger:TUIDebugOverlayBlending], @"blending",
+						   [NSNumber numberWithUnsignedInteger:TUIDebugOverlayDrawTime], @"drawtime",
+						   [NSNumber numberWithUnsignedInteger:TUIDebugOverlayLargeBackingStore], @"backingstore",
+						   [NSNumber numberWithUnsignedInteger:TUIDebugOverlayBackgroundDrawing], @"background",
+						   [NSNumber numberWithUnsignedInteger:TUIDebugOverlayAll], @"all",
+						   nil];
+	TUIDebugOverlayOptions options = TUIDebugOverlayNone;
+	for(NSString *name in [string componentsSeparatedByString:@","]) {
+		name = [[name stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]] lowercaseString];
+		options |= [[names objectForKey:name] unsignedIntegerValue];
+	}
+	return options;
+}
+
++ (size_t)largeBackingStoreThreshold
+{
+	return TUIDebugOverlayLargeBackingStoreThreshold;
+}
+
++ (void)setLargeBackingStoreThreshold:(size_t)bytes
+{
+	TUIDebugOverlayLargeBackingStoreThreshold = bytes;
+}
+
++ (NSTimeInterval)drawTimeHeatMapMaximum
+{
+	return TUIDebugOverlayDrawTimeHeatMapMaximum;
+}
+
++ (void)setDrawTimeHeatMapMaximum:(NSTimeInterval)seconds
+{
+	TUIDebugOverlayDrawTimeHeatMapMaximum = seconds;
+}
+
+@end
@@ -0,0 +1,82 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class TUIView;
+@class TUIImage;
+
+/**
+ A recording of what a view subtree draws, kept as vector drawing operations
+ (a PDF page) rather than pixels. Replaying it (into a PDF, or rasterizing at
+ any scale) doesn't touch the views and is thread safe, so exports can be
+ finished in the background while the UI keeps going.
+ 
+ Recording is not free: it is a second, synchronous redraw of the whole
+ subtree on the main thread, calling every view's -drawRect: (or drawRect
+ block) again rather than reusing what the last display pass drew into the
+ layers. Budget for it like a full redraw of the views being recorded.
+ 
+ Views are drawn back to front honouring position, bounds, the affine part
+ of their transform, alpha, hidden and clipsToBounds. Layer-only content
+ (animations, 3D transforms, sublayers added directly, layer masks) isn't
+ recorded.
+ */
+@interface TUIDisplayList : NSObject
+
++ (TUIDisplayList *)displayListWithView:(TUIView *)view; // main thread
+- (id)initWithPDFData:(NSData *)data;
+
+@property (nonatomic, readonly) NSData *PDFData;
+@property (nonatomic, readonly) NSUInteger pageCount;
+
+- (CGRect)boundsOfPage:(NSUInteger)index;
+
+/**
+ Replay a page with its bounds' origin at the context's origin.
+ */
+- (void)drawPage:(NSUInteger)index inContext:(CGContextRef)context; // thread safe
+- (TUIImage *)imageOfPage:(NSUInteger)index scale:(CGFloat)scale; // thread safe
+- (void)renderImageOfPage:(NSUInteger)index scale:(CGFloat)scale completion:(void(^)(TUIImage *image))completion; // on a background queue, completion on the main queue
+
+@end
+
+/**
+ Writes views into a paginated PDF as they are appended, stacking them top to
+ bottom and starting a new page when the next one doesn't fit. Finished
+ pages go straight to the file, so exporting many views (e.g. every row of
+ a table, see TUITableView (Export)) keeps only one page in memory.
+ */
+@interface TUIDisplayListRecorder : NSObject
+
+- (id)initWithURL:(NSURL *)url pageSize:(CGSize)pageSize;
+- (id)initWithMutableData:(NSMutableData *)data pageSize:(CGSize)pageSize;
+
+/**
+ Record 'view' (main thread, redraws the whole subtree). A view taller than a page gets a page of its own, as tall as the view.
+ */
+- (void)appendView:(TUIView *)view;
+
+- (void)finish; // called by dealloc if you don't
+
+@end
+
+/**
+ Draw 'view' and its subviews into 'context' with the view's bounds at the
+ current origin, ignoring the root's own transform. This is what recording
+ does, redrawing every view in the subtree; main thread.
+ */
+extern void TUIDisplayListDrawView(TUIView *view, CGContextRef context);
@@ -0,0 +1,275 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIDisplayList.h"
+#import "TUIKit.h"
+
+static BOOL TUIViewOverridesDrawRect(TUIView *view)
+{
+	return [view methodForSelector:@selector(drawRect:)] != [TUIView instanceMethodForSelector:@selector(drawRect:)];
+}
+
+static void TUIDisplayListDrawSubtree(TUIView *view, CGContextRef context, BOOL isRoot)
+{
+	if(view.hidden || view.alpha <= 0.0)
+		return;
+	
+	CGRect b = view.bounds;
+	CGContextSaveGState(context);
+	if(!isRoot) {
+		// the layer's geometry rather than frame, which is meaningless once the view is transformed:
+		// position in the superview, the transform about the anchor point, then bounds from there
+		CALayer *layer = view.layer;
+		CGPoint position = layer.position;
+		CGPoint anchor = layer.anchorPoint;
+		CGContextTranslateCTM(context, position.x, position.y);
+		CGContextConcatCTM(context, view.transform);
+		CGContextTranslateCTM(context, -anchor.x * b.size.width, -anchor.y * b.size.height);
+	}
+	
+	BOOL transparencyLayer = view.alpha < 1.0;
+	if(transparencyLayer) {
+		CGContextSetAlpha(context, view.alpha);
+		CGContextBeginTransparencyLayer(context, NULL); // so overlapping subviews don't show through each other
+	}
+	if(view.clipsToBounds)
+		CGContextClipToRect(context, CGRectMake(0, 0, b.size.width, b.size.height));
+	
+	// same choice -displayLayer: makes, drawn vector rather than into the backing store
+	TUIGraphicsPushContext(context);
+	CGContextSaveGState(context);
+	CGContextTranslateCTM(context, -b.origin.x, -b.origin.y);
+	if(view.drawRect) {
+		view.drawRect(view, b);
+	} else if(TUIViewOverridesDrawRect(view)) {
+		[view drawRect:b];
+	} else if(view.layer.backgroundColor) {
+		CGContextSetFillColorWithColor(context, view.layer.backgroundColor);
+		CGContextFillRect(context, b);
+	}
+	CGContextRestoreGState(context);
+	TUIGraphicsPopContext();
+	
+	CGContextTranslateCTM(context, -b.origin.x, -b.origin.y); // subview frames are in bounds coordinates
+	for(TUIView *subview in view.subviews)
+		TUIDisplayListDrawSubtree(subview, context, NO);
+	
+	if(transparencyLayer)
+		CGContextEndTransparencyLayer(context);
+	CGContextRestoreGState(context);
+}
+
+void TUIDisplayListDrawView(TUIView *view, CGContextRef context)
+{
+	TUIDisplayListDrawSubtree(view, context, YES);
+}
+
+@interface TUIDisplayList ()
+{
+	NSData *_data;
+	CGPDFDocumentRef _document;
+}
+@end
+
+@implementation TUIDisplayList
+
++ (TUIDisplayList *)displayListWithView:(TUIView *)view
+{
+	NSMutableData *data = [NSMutableData data];
+	TUIDisplayListRecorder *recorder = [[TUIDisplayListRecorder alloc] initWithMutableData:data pageSize:view.bounds.size];
+	[recorder appendView:view];
+	[recorder finish];
+	return [[self alloc] initWithPDFData:data];
+}
+
+- (id)initWithPDFData:(NSData *)data
+{
+	if(!data)
+		return nil;
+	
+	CGDataProviderRef provider = CGDataProviderCreateWithCFData((__bridge CFDataRef)data);
+	CGPDFDocumentRef document = provider ? CGPDFDocumentCreateWithProvider(provider) : NULL;
+	CGDataProviderRelease(provider);
+	if(!document)
+		return nil;
+	
+	if((self = [super init])) {
+		_data = [data copy];
+		_document = document;
+	} else {
+		CGPDFDocumentRelease(document);
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	CGPDFDocumentRelease(_document);
+}
+
+- (NSData *)PDFData
+{
+	return _data;
+}
+
+- (NSUInteger)pageCount
+{
+	return CGPDFDocumentGetNumberOfPages(_document);
+}
+
+- (CGPDFPageRef)_page:(NSUInteger)index
+{
+	return CGPDFDocumentGetPage(_document, index + 1); // pages are numbered from 1
+}
+
+- (CGRect)boundsOfPage:(NSUInteger)index
+{
+	CGPDFPageRef page = [self _page:index];
+	return page ? CGPDFPageGetBoxRect(page, kCGPDFMediaBox) : CGRectZero;
+}
+
+- (void)drawPage:(NSUInteger)index inContext:(CGContextRef)context
+{
+	CGPDFPageRef page = [self _page:index];
+	if(!page)
+		return;
+	CGRect box = CGPDFPageGetBoxRect(page, kCGPDFMediaBox);
+	CGContextSaveGState(context);
+	CGContextTranslateCTM(context, -box.origin.x, -box.origin.y);
+	CGContextDrawPDFPage(context, page);
+	CGContextRestoreGState(context);
+}
+
+- (TUIImage *)imageOfPage:(NSUInteger)index scale:(CGFloat)scale
+{
+	CGRect box = [self boundsOfPage:index];
+	CGContextRef ctx = TUICreateGraphicsContext(CGSizeMake(ceil(box.size.width * scale), ceil(box.size.height * scale)));
+	if(!ctx)
+		return nil;
+	CGContextScaleCTM(ctx, scale, scale);
+	[self drawPage:index inContext:ctx];
+	CGImageRef cgImage = CGBitmapContextCreateImage(ctx);
+	CGContextRelease(ctx);
+	TUIImage *image = [TUIImage imageWithCGImage:cgImage];
+	CGImageRelease(cgImage);
+	return image;
+}
+
+- (void)renderImageOfPage:(NSUInteger)index scale:(CGFloat)scale completion:(void(^)(TUIImage *image))completion
+{
+	completion = [completion copy];
+	dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0), ^{
+		TUIImage *image = [self imageOfPage:index scale:scale];
+		dispatch_async(dispatch_get_main_queue(), ^{
+			if(completion)
+				completion(image);
+		});
+	});
+}
+
+@end
+
+@interface TUIDisplayListRecorder ()
+{
+	CGContextRef _context;
+	CGSize _pageSize;
+	CGFloat _pageHeight; // of the current page
+	CGFloat _cursor; // top of the free space on the current page, from the bottom
+	BOOL _pageOpen;
+}
+@end
+
+@implementation TUIDisplayListRecorder
+
+- (id)_initWithContext:(CGContextRef)context pageSize:(CGSize)pageSize
+{
+	if(!context)
+		return nil;
+	if((self = [super init])) {
+		_context = context;
+		_pageSize = pageSize;
+	} else {
+		CGContextRelease(context);
+	}
+	return self;
+}
+
+- (id)initWithURL:(NSURL *)url pageSize:(CGSize)pageSize
+{
+	CGRect mediaBox = CGRectMake(0, 0, pageSize.width, pageSize.height);
+	return [self _initWithContext:CGPDFContextCreateWithURL((__bridge CFURLRef)url, &mediaBox, NULL) pageSize:pageSize];
+}
+
+- (id)initWithMutableData:(NSMutableData *)data pageSize:(CGSize)pageSize
+{
+	CGRect mediaBox = CGRectMake(0, 0, pageSize.width, pageSize.height);
+	CGDataConsumerRef consumer = CGDataConsumerCreateWithCFData((__bridge CFMutableDataRef)data);
+	CGContextRef context = CGPDFContextCreate(consumer, &mediaBox, NULL);
+	CGDataConsumerRelease(consumer);
+	return [self _initWithContext:context pageSize:pageSize];
+}
+
+- (void)dealloc
+{
+	[self finish];
+}
+
+- (void)_endPage
+{
+	if(_pageOpen) {
+		CGPDFContextEndPage(_context);
+		_pageOpen = NO;
+	}
+}
+
+- (void)_beginPageWithHeight:(CGFloat)height
+{
+	[self _endPage];
+	CGRect mediaBox = CGRectMake(0, 0, _pageSize.width, height);
+	NSDictionary *info = [NSDictionary dictionaryWithObject:[NSData dataWithBytes:&mediaBox length:sizeof(mediaBox)] forKey:(__bridge NSString *)kCGPDFContextMediaBox];
+	CGPDFContextBeginPage(_context, (__bridge CFDictionaryRef)info);
+	_pageOpen = YES;
+	_pageHeight = height;
+	_cursor = height;
+}
+
+- (void)appendView:(TUIView *)view
+{
+	if(!_context)
+		return;
+	
+	CGFloat height = view.bounds.size.height;
+	if(!_pageOpen || height > _cursor)
+		[self _beginPageWithHeight:MAX(height, _pageSize.height)];
+	
+	_cursor -= height;
+	CGContextSaveGState(_context);
+	CGContextTranslateCTM(_context, 0, _cursor);
+	TUIDisplayListDrawView(view, _context);
+	CGContextRestoreGState(_context);
+}
+
+- (void)finish
+{
+	if(!_context)
+		return;
+	[self _endPage];
+	CGPDFContextClose(_context);
+	CGContextRelease(_context);
+	_context = NULL;
+}
+
+@end
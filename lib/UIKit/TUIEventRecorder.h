@@ -0,0 +1,118 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Cocoa/Cocoa.h>
+#import "TUIEventTrace.h"
+
+@class TUINSView;
+
+/**
+ Records the mouse, scroll, key and gesture events delivered to a window
+ hosting a TUINSView.
+ */
+@interface TUIEventRecorder : NSObject
+{
+	__unsafe_unretained TUINSView *_view; // weak
+	id _monitor;
+	NSMutableArray *_events;
+	NSTimeInterval _firstTimestamp;
+}
+
+@property (nonatomic, readonly) NSArray *events;
+@property (nonatomic, readonly, getter=isRecording) BOOL recording;
+
+- (void)startRecordingInView:(TUINSView *)view; // clears previously recorded events
+- (void)stopRecording;
+
+- (TUIEventTrace *)trace;
+- (NSData *)traceData;
+- (BOOL)writeTraceToURL:(NSURL *)url;
+
+@end
+
+/**
+ Timings gathered by a replay. Handling times are wall clock, everything
+ else is on the replay's virtual clock.
+ */
+@interface TUIEventReplayReport : NSObject
+{
+	NSUInteger eventCount;
+	NSUInteger skippedEventCount;
+	NSUInteger frameCount;
+	NSTimeInterval duration;
+	NSTimeInterval totalHandlingTime;
+	NSTimeInterval maximumHandlingTime;
+	NSMutableDictionary *_handlingTimesByType;
+}
+
+@property (nonatomic, readonly) NSUInteger eventCount;
+@property (nonatomic, readonly) NSUInteger skippedEventCount; // recorded events that can't be recreated, see TUIEventReplayer
+/**
+ Frames in which at least one view drew, counted by +[TUIView _displayCount].
+ That includes image views that set their layer's contents directly without
+ drawing, which go through the same display hooks.
+ */
+@property (nonatomic, readonly) NSUInteger frameCount;
+@property (nonatomic, readonly) NSTimeInterval duration;
+@property (nonatomic, readonly) NSTimeInterval totalHandlingTime;
+@property (nonatomic, readonly) NSTimeInterval maximumHandlingTime;
+
+/**
+ NSNumber (NSEventType) -> NSArray of NSNumber seconds, one per event in trace order.
+ */
+@property (nonatomic, readonly) NSDictionary *handlingTimesByType;
+
+@end
+
+/**
+ Feeds a trace through a TUINSView's event handlers on a virtual clock.
+ 
+ The shared TUIFrameClock is paused for the duration and ticked once per
+ virtual frame, so anything driven by it (mouse coalescing, animated images)
+ sees the same frame boundaries on every run regardless of how long handling
+ takes. After each frame the current transaction is flushed so drawing is
+ attributed to the frame that caused it.
+ 
+ Mouse and key events are made with NSEvent's constructors and scroll events
+ from a CGEvent, so handlers see real NSEvents. Gesture events (magnify,
+ rotate, swipe) have no public constructor; they're skipped and counted in
+ the report's skippedEventCount.
+ 
+ Views that run their own tracking loops with -nextEventMatchingMask: won't
+ see replayed events, and timers (e.g. scroll view bouncing) still run on
+ real time.
+ */
+@interface TUIEventReplayer : NSObject
+{
+	TUIEventTrace *_trace;
+	NSTimeInterval frameInterval;
+	NSUInteger trailingFrameCount;
+}
+
++ (TUIEventReplayer *)replayerWithContentsOfURL:(NSURL *)url;
+- (id)initWithTrace:(NSData *)traceData; // nil if the trace can't be read
+
+@property (nonatomic, readonly) TUIEventTrace *trace;
+@property (nonatomic, readonly) NSArray *events;
+@property (nonatomic, assign) NSTimeInterval frameInterval; // default 1/60
+@property (nonatomic, assign) NSUInteger trailingFrameCount; // frames run after the last event, default 30
+
+/**
+ Synchronous, main thread only.
+ */
+- (TUIEventReplayReport *)replayInView:(TUINSView *)view;
+
+@end
@@ -0,0 +1,395 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIEventRecorder.h"
+#import "TUINSView.h"
+#import "TUIFrameClock.h"
+#import "TUIView+Private.h"
+#import "TUIInputLatency.h"
+#import <QuartzCore/QuartzCore.h>
+
+static const NSUInteger TUIEventRecorderMask = NSLeftMouseDownMask | NSLeftMouseUpMask | NSLeftMouseDraggedMask | NSMouseMovedMask | NSRightMouseDownMask | NSRightMouseUpMask | NSScrollWheelMask | NSKeyDownMask | NSKeyUpMask | NSEventMaskMagnify | NSEventMaskRotate | NSEventMaskSwipe | NSEventMaskBeginGesture | NSEventMaskEndGesture;
+
+static NSString *TUIEventString(NSString *s)
+{
+	return s ? s : @"";
+}
+
+static NSUInteger TUIEventIntegerValue(NSEvent *event, SEL s) // 10.7+ accessors
+{
+	if(![event respondsToSelector:s])
+		return 0;
+	NSUInteger (*imp)(id,SEL) = (NSUInteger(*)(id,SEL))[event methodForSelector:s];
+	return imp(event, s);
+}
+
+// NSEventPhase, 10.7+
+enum {
+	TUIEventPhaseBegan = 0x1 << 0,
+	TUIEventPhaseStationary = 0x1 << 1,
+	TUIEventPhaseChanged = 0x1 << 2,
+	TUIEventPhaseEnded = 0x1 << 3,
+	TUIEventPhaseCancelled = 0x1 << 4,
+	TUIEventPhaseMayBegin = 0x1 << 5,
+};
+
+// CGEventField, 10.7+
+#define TUIScrollWheelEventScrollPhase ((CGEventField)99)
+#define TUIScrollWheelEventMomentumPhase ((CGEventField)123)
+
+// CGScrollPhase numbers the phases differently from NSEventPhase
+static int64_t TUIScrollPhaseFromEventPhase(NSUInteger phase)
+{
+	if(phase & TUIEventPhaseBegan)
+		return 1;
+	if(phase & (TUIEventPhaseChanged | TUIEventPhaseStationary))
+		return 2;
+	if(phase & TUIEventPhaseEnded)
+		return 4;
+	if(phase & TUIEventPhaseCancelled)
+		return 8;
+	if(phase & TUIEventPhaseMayBegin)
+		return 128;
+	return 0;
+}
+
+// and CGMomentumScrollPhase is a sequence rather than bits
+static int64_t TUIMomentumPhaseFromEventPhase(NSUInteger phase)
+{
+	if(phase & TUIEventPhaseBegan)
+		return 1;
+	if(phase & (TUIEventPhaseChanged | TUIEventPhaseStationary))
+		return 2;
+	if(phase & (TUIEventPhaseEnded | TUIEventPhaseCancelled))
+		return 3;
+	return 0;
+}
+
+@implementation TUIEventRecorder
+
+- (void)dealloc
+{
+	[self stopRecording];
+}
+
+- (NSArray *)events
+{
+	return [_events copy];
+}
+
+- (BOOL)isRecording
+{
+	return _monitor != nil;
+}
+
+- (NSDictionary *)_recordForEvent:(NSEvent *)event
+{
+	if(!_events.count)
+		_firstTimestamp = [event timestamp];
+	
+	NSEventType type = [event type];
+	NSPoint p = [_view convertPoint:[event locationInWindow] fromView:nil];
+	NSMutableDictionary *r = [NSMutableDictionary dictionaryWithObjectsAndKeys:
+							  [NSNumber numberWithDouble:[event timestamp] - _firstTimestamp], @"t",
+							  [NSNumber numberWithUnsignedInteger:type], @"type",
+							  [NSNumber numberWithDouble:p.x], @"x",
+							  [NSNumber numberWithDouble:p.y], @"y",
+							  [NSNumber numberWithUnsignedInteger:[event modifierFlags]], @"modifierFlags",
+							  nil];
+	
+	switch(type) {
+		case NSLeftMouseDown:
+		case NSLeftMouseUp:
+		case NSRightMouseDown:
+		case NSRightMouseUp:
+			[r setObject:[NSNumber numberWithInteger:[event clickCount]] forKey:@"clickCount"];
+			break;
+		case NSKeyDown:
+		case NSKeyUp:
+			[r setObject:[NSNumber numberWithUnsignedShort:[event keyCode]] forKey:@"keyCode"];
+			[r setObject:[event characters] forKey:@"characters"];
+			[r setObject:[event charactersIgnoringModifiers] forKey:@"charactersIgnoringModifiers"];
+			[r setObject:[NSNumber numberWithBool:[event isARepeat]] forKey:@"isARepeat"];
+			break;
+		case NSScrollWheel: {
+			CGEventRef cgEvent = [event CGEvent];
+			BOOL continuous = CGEventGetIntegerValueField(cgEvent, kCGScrollWheelEventIsContinuous) != 0;
+			[r setObject:[NSNumber numberWithBool:continuous] forKey:@"continuous"];
+			[r setObject:[NSNumber numberWithDouble:[event deltaX]] forKey:@"deltaX"];
+			[r setObject:[NSNumber numberWithDouble:[event deltaY]] forKey:@"deltaY"];
+			[r setObject:[NSNumber numberWithDouble:CGEventGetDoubleValueField(cgEvent, kCGScrollWheelEventPointDeltaAxis2)] forKey:@"pointDeltaX"];
+			[r setObject:[NSNumber numberWithDouble:CGEventGetDoubleValueField(cgEvent, kCGScrollWheelEventPointDeltaAxis1)] forKey:@"pointDeltaY"];
+			[r setObject:[NSNumber numberWithUnsignedInteger:TUIEventIntegerValue(event, @selector(phase))] forKey:@"phase"];
+			[r setObject:[NSNumber numberWithUnsignedInteger:TUIEventIntegerValue(event, @selector(momentumPhase))] forKey:@"momentumPhase"];
+			break;
+		}
+		case NSEventTypeMagnify:
+			[r setObject:[NSNumber numberWithDouble:[event magnification]] forKey:@"magnification"];
+			break;
+		case NSEventTypeRotate:
+			[r setObject:[NSNumber numberWithDouble:[event rotation]] forKey:@"rotation"];
+			break;
+		case NSEventTypeSwipe:
+			[r setObject:[NSNumber numberWithDouble:[event deltaX]] forKey:@"deltaX"];
+			[r setObject:[NSNumber numberWithDouble:[event deltaY]] forKey:@"deltaY"];
+			break;
+		default:
+			break;
+	}
+	return r;
+}
+
+- (void)startRecordingInView:(TUINSView *)view
+{
+	[self stopRecording];
+	
+	_view = view;
+	_events = [[NSMutableArray alloc] init];
+	
+	__unsafe_unretained TUIEventRecorder *weakSelf = self; // monitor is removed in -stopRecording
+	_monitor = [NSEvent addLocalMonitorForEventsMatchingMask:TUIEventRecorderMask handler:^NSEvent *(NSEvent *event) {
+		TUIEventRecorder *strongSelf = weakSelf;
+		if([event window] == [strongSelf->_view window])
+			[strongSelf->_events addObject:[strongSelf _recordForEvent:event]];
+		return event;
+	}];
+}
+
+- (void)stopRecording
+{
+	if(_monitor) {
+		[NSEvent removeMonitor:_monitor];
+		_monitor = nil;
+	}
+	_view = nil;
+}
+
+- (TUIEventTrace *)trace
+{
+	return [[TUIEventTrace alloc] initWithEvents:_events];
+}
+
+- (NSData *)traceData
+{
+	return [[self trace] data];
+}
+
+- (BOOL)writeTraceToURL:(NSURL *)url
+{
+	return [[self traceData] writeToURL:url atomically:YES];
+}
+
+@end
+
+@interface TUIEventReplayReport ()
+@property (nonatomic, readwrite) NSUInteger frameCount;
+@property (nonatomic, readwrite) NSTimeInterval duration;
+- (void)_addHandlingTime:(NSTimeInterval)t forType:(NSEventType)type;
+- (void)_skipEvent;
+@end
+
+@implementation TUIEventReplayReport
+
+@synthesize eventCount;
+@synthesize skippedEventCount;
+@synthesize frameCount;
+@synthesize duration;
+@synthesize totalHandlingTime;
+@synthesize maximumHandlingTime;
+
+- (id)init
+{
+	if((self = [super init])) {
+		_handlingTimesByType = [[NSMutableDictionary alloc] init];
+	}
+	return self;
+}
+
+- (NSDictionary *)handlingTimesByType
+{
+	return [_handlingTimesByType copy];
+}
+
+- (void)_addHandlingTime:(NSTimeInterval)t forType:(NSEventType)type
+{
+	NSNumber *key = [NSNumber numberWithUnsignedInteger:type];
+	NSMutableArray *times = [_handlingTimesByType objectForKey:key];
+	if(!times) {
+		times = [NSMutableArray array];
+		[_handlingTimesByType setObject:times forKey:key];
+	}
+	[times addObject:[NSNumber numberWithDouble:t]];
+	
+	eventCount++;
+	totalHandlingTime += t;
+	maximumHandlingTime = MAX(maximumHandlingTime, t);
+}
+
+- (void)_skipEvent
+{
+	skippedEventCount++;
+}
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"<%@: %p; %lu events (%lu skipped), %lu frames in %.3fs, handling %.2fms total, %.2fms mean, %.2fms max>", [self class], self, (unsigned long)eventCount, (unsigned long)skippedEventCount, (unsigned long)frameCount, duration, totalHandlingTime * 1000.0, eventCount ? totalHandlingTime * 1000.0 / eventCount : 0.0, maximumHandlingTime * 1000.0];
+}
+
+@end
+
+@implementation TUIEventReplayer
+
+@synthesize frameInterval;
+@synthesize trailingFrameCount;
+
++ (TUIEventReplayer *)replayerWithContentsOfURL:(NSURL *)url
+{
+	NSData *data = [NSData dataWithContentsOfURL:url];
+	return data ? [[self alloc] initWithTrace:data] : nil;
+}
+
+- (id)initWithTrace:(NSData *)traceData
+{
+	if((self = [super init])) {
+		_trace = [[TUIEventTrace alloc] initWithData:traceData];
+		if(!_trace)
+			return nil;
+		frameInterval = 1.0 / 60.0;
+		trailingFrameCount = 30;
+	}
+	return self;
+}
+
+- (TUIEventTrace *)trace
+{
+	return _trace;
+}
+
+- (NSArray *)events
+{
+	return [_trace events];
+}
+
+- (NSEvent *)_scrollEventForRecord:(NSDictionary *)r window:(NSWindow *)window location:(NSPoint)p modifierFlags:(NSUInteger)modifierFlags timestamp:(NSTimeInterval)timestamp
+{
+	BOOL continuous = [[r objectForKey:@"continuous"] boolValue];
+	double deltaX = [[r objectForKey:@"deltaX"] doubleValue];
+	double deltaY = [[r objectForKey:@"deltaY"] doubleValue];
+	double pointDeltaX = [[r objectForKey:@"pointDeltaX"] doubleValue];
+	double pointDeltaY = [[r objectForKey:@"pointDeltaY"] doubleValue];
+	CGEventRef cgEvent = CGEventCreateScrollWheelEvent(NULL, continuous ? kCGScrollEventUnitPixel : kCGScrollEventUnitLine, 2, (int32_t)(continuous ? pointDeltaY : deltaY), (int32_t)(continuous ? pointDeltaX : deltaX));
+	if(!cgEvent)
+		return nil;
+	
+	// CG locations are global, top left origin on the primary screen
+	NSPoint screenPoint = [window convertBaseToScreen:p];
+	CGFloat primaryHeight = NSMaxY([[[NSScreen screens] objectAtIndex:0] frame]);
+	CGEventSetLocation(cgEvent, CGPointMake(screenPoint.x, primaryHeight - screenPoint.y));
+	CGEventSetTimestamp(cgEvent, (CGEventTimestamp)(timestamp * NSEC_PER_SEC));
+	CGEventSetFlags(cgEvent, (CGEventFlags)modifierFlags);
+	CGEventSetIntegerValueField(cgEvent, kCGMouseEventWindowUnderMousePointer, [window windowNumber]);
+	CGEventSetIntegerValueField(cgEvent, kCGMouseEventWindowUnderMousePointerThatCanHandleThisEvent, [window windowNumber]);
+	
+	// what TUIScrollView and TUINSView's latching read
+	CGEventSetIntegerValueField(cgEvent, kCGScrollWheelEventIsContinuous, continuous);
+	CGEventSetDoubleValueField(cgEvent, kCGScrollWheelEventPointDeltaAxis1, pointDeltaY);
+	CGEventSetDoubleValueField(cgEvent, kCGScrollWheelEventPointDeltaAxis2, pointDeltaX);
+	CGEventSetDoubleValueField(cgEvent, kCGScrollWheelEventFixedPtDeltaAxis1, deltaY);
+	CGEventSetDoubleValueField(cgEvent, kCGScrollWheelEventFixedPtDeltaAxis2, deltaX);
+	CGEventSetIntegerValueField(cgEvent, TUIScrollWheelEventScrollPhase, TUIScrollPhaseFromEventPhase([[r objectForKey:@"phase"] unsignedIntegerValue]));
+	CGEventSetIntegerValueField(cgEvent, TUIScrollWheelEventMomentumPhase, TUIMomentumPhaseFromEventPhase([[r objectForKey:@"momentumPhase"] unsignedIntegerValue]));
+	
+	NSEvent *event = [NSEvent eventWithCGEvent:cgEvent];
+	CFRelease(cgEvent);
+	return event;
+}
+
+- (NSEvent *)_eventForRecord:(NSDictionary *)r inView:(TUINSView *)view timestamp:(NSTimeInterval)timestamp
+{
+	NSEventType type = [[r objectForKey:@"type"] unsignedIntegerValue];
+	NSWindow *window = [view window];
+	NSPoint p = [view convertPoint:NSMakePoint([[r objectForKey:@"x"] doubleValue], [[r objectForKey:@"y"] doubleValue]) toView:nil];
+	NSUInteger modifierFlags = [[r objectForKey:@"modifierFlags"] unsignedIntegerValue];
+	
+	switch(type) {
+		case NSLeftMouseDown:
+		case NSLeftMouseUp:
+		case NSLeftMouseDragged:
+		case NSMouseMoved:
+		case NSRightMouseDown:
+		case NSRightMouseUp:
+			return [NSEvent mouseEventWithType:type location:p modifierFlags:modifierFlags timestamp:timestamp windowNumber:[window windowNumber] context:nil eventNumber:0 clickCount:[[r objectForKey:@"clickCount"] integerValue] pressure:(type == NSLeftMouseUp || type == NSRightMouseUp || type == NSMouseMoved) ? 0.0 : 1.0];
+		case NSKeyDown:
+		case NSKeyUp:
+			return [NSEvent keyEventWithType:type location:p modifierFlags:modifierFlags timestamp:timestamp windowNumber:[window windowNumber] context:nil characters:TUIEventString([r objectForKey:@"characters"]) charactersIgnoringModifiers:TUIEventString([r objectForKey:@"charactersIgnoringModifiers"]) isARepeat:[[r objectForKey:@"isARepeat"] boolValue] keyCode:[[r objectForKey:@"keyCode"] unsignedShortValue]];
+		case NSScrollWheel:
+			return [self _scrollEventForRecord:r window:window location:p modifierFlags:modifierFlags timestamp:timestamp];
+		default:
+			return nil;
+	}
+}
+
+- (void)_deliverEvent:(NSEvent *)event toView:(TUINSView *)view
+{
+	switch([event type]) {
+		case NSLeftMouseDown: [view mouseDown:event]; break;
+		case NSLeftMouseUp: [view mouseUp:event]; break;
+		case NSLeftMouseDragged: [view mouseDragged:event]; break;
+		case NSMouseMoved: [view mouseMoved:event]; break;
+		case NSRightMouseDown: [view rightMouseDown:event]; break;
+		case NSRightMouseUp: [view rightMouseUp:event]; break;
+		case NSScrollWheel: [view scrollWheel:event]; break;
+		default: [[view window] sendEvent:event]; break; // keys go to the first responder
+	}
+}
+
+- (TUIEventReplayReport *)replayInView:(TUINSView *)view
+{
+	TUIEventReplayReport *report = [[TUIEventReplayReport alloc] init];
+	TUIFrameClock *clock = [TUIFrameClock sharedClock];
+	BOOL wasPaused = clock.paused;
+	clock.paused = YES;
+	
+	// virtual time: frame clock ticks on the reference date, events on system uptime like real ones
+	NSTimeInterval clockBase = [NSDate timeIntervalSinceReferenceDate];
+	NSTimeInterval eventBase = [[NSProcessInfo processInfo] systemUptime];
+	
+	NSTimeInterval now = [_trace scheduleWithFrameInterval:frameInterval trailingFrameCount:trailingFrameCount frameHandler:^(NSUInteger frame, NSTimeInterval time) {
+		NSUInteger displayCount = [TUIView _displayCount];
+		[clock tickWithTimestamp:clockBase + time];
+		[CATransaction flush];
+		[[TUIInputLatencyTracker sharedTracker] noteCommitAtTime:eventBase + time];
+		if([TUIView _displayCount] != displayCount)
+			report.frameCount++;
+	} eventHandler:^(NSDictionary *r, NSTimeInterval time) {
+		@autoreleasepool {
+			NSEvent *event = [self _eventForRecord:r inView:view timestamp:eventBase + time];
+			if(!event) {
+				[report _skipEvent];
+				return;
+			}
+			NSTimeInterval start = [NSDate timeIntervalSinceReferenceDate];
+			[self _deliverEvent:event toView:view];
+			[report _addHandlingTime:[NSDate timeIntervalSinceReferenceDate] - start forType:[event type]];
+		}
+	}];
+	
+	report.duration = now;
+	clock.paused = wasPaused;
+	return report;
+}
+
+@end
@@ -0,0 +1,65 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/*
+ Trace format: a property list dictionary
+ 
+   version	1
+   events	array of dictionaries, in order, with
+     t		seconds since the first event
+     type	NSEventType
+     x, y	location in TUINSView coordinates
+     plus whichever of modifierFlags, clickCount, keyCode, characters,
+     charactersIgnoringModifiers, isARepeat, deltaX, deltaY, pointDeltaX,
+     pointDeltaY, continuous, phase, momentumPhase, magnification, rotation
+     apply to the type.
+ 
+ Locations are view relative so a trace recorded in one window replays in
+ another of the same size.
+ 
+ The trace and its schedule are plain data with no AppKit in them, so they
+ can be read, written and tested anywhere; TUIEventRecorder and
+ TUIEventReplayer turn them into real events.
+ */
+
+/**
+ A recorded sequence of events, see above for the format.
+ */
+@interface TUIEventTrace : NSObject
+{
+	NSArray *_events;
+}
+
+- (id)initWithEvents:(NSArray *)events; // dictionaries, in order
+- (id)initWithData:(NSData *)data; // nil if the trace can't be read
+
+@property (nonatomic, readonly) NSArray *events;
+@property (nonatomic, readonly) NSData *data; // XML property list
+
+/**
+ Walk the trace on a virtual clock: frames are numbered from 1 and frame n
+ is at n * frameInterval. Each event is handed to 'eventHandler' after every
+ frame that falls at or before its time, then 'trailingFrameCount' more
+ frames run after the last event. Returns the virtual time of the last frame.
+ */
+- (NSTimeInterval)scheduleWithFrameInterval:(NSTimeInterval)frameInterval
+						 trailingFrameCount:(NSUInteger)trailingFrameCount
+							   frameHandler:(void(^)(NSUInteger frame, NSTimeInterval time))frameHandler
+							   eventHandler:(void(^)(NSDictionary *event, NSTimeInterval time))eventHandler;
+
+@end
@@ -0,0 +1,91 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIEventTrace.h"
+
+#define TUIEventTraceVersion 1
+
+@implementation TUIEventTrace
+
+- (id)initWithEvents:(NSArray *)events
+{
+	if((self = [super init])) {
+		_events = events ? [events copy] : [NSArray array];
+	}
+	return self;
+}
+
+- (id)initWithData:(NSData *)data
+{
+	NSDictionary *trace = data ? [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:NULL error:NULL] : nil;
+	if(![trace isKindOfClass:[NSDictionary class]] || [[trace objectForKey:@"version"] integerValue] != TUIEventTraceVersion) {
+		NSLog(@"TUIEventTrace: unreadable trace");
+		return nil;
+	}
+	NSArray *events = [trace objectForKey:@"events"];
+	if(![events isKindOfClass:[NSArray class]]) {
+		NSLog(@"TUIEventTrace: trace has no events");
+		return nil;
+	}
+	return [self initWithEvents:events];
+}
+
+- (NSArray *)events
+{
+	return _events;
+}
+
+- (NSData *)data
+{
+	NSDictionary *trace = [NSDictionary dictionaryWithObjectsAndKeys:
+						   [NSNumber numberWithInteger:TUIEventTraceVersion], @"version",
+						   _events, @"events",
+						   nil];
+	return [NSPropertyListSerialization dataWithPropertyList:trace format:NSPropertyListXMLFormat_v1_0 options:0 error:NULL];
+}
+
+- (NSTimeInterval)scheduleWithFrameInterval:(NSTimeInterval)frameInterval
+						 trailingFrameCount:(NSUInteger)trailingFrameCount
+							   frameHandler:(void(^)(NSUInteger frame, NSTimeInterval time))frameHandler
+							   eventHandler:(void(^)(NSDictionary *event, NSTimeInterval time))eventHandler
+{
+	NSUInteger frame = 0;
+	NSTimeInterval now = 0.0;
+	
+	for(NSDictionary *r in _events) {
+		NSTimeInterval t = [[r objectForKey:@"t"] doubleValue];
+		if(frameInterval > 0.0) {
+			while(t >= (frame + 1) * frameInterval) {
+				frame++;
+				now = frame * frameInterval;
+				if(frameHandler)
+					frameHandler(frame, now);
+			}
+		}
+		if(eventHandler)
+			eventHandler(r, t);
+	}
+	
+	for(NSUInteger i = 0; i < trailingFrameCount; ++i) {
+		frame++;
+		now = frame * frameInterval;
+		if(frameHandler)
+			frameHandler(frame, now);
+	}
+	return now;
+}
+
+@end
@@ -0,0 +1,48 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+@protocol TUIFrameClockObserver <NSObject>
+- (void)frameClockDidTick:(NSTimeInterval)timestamp; // timestamp is [NSDate timeIntervalSinceReferenceDate] at the tick
+@end
+
+/**
+ One main thread timer at display rate shared by everything that needs a
+ per-frame callback, so N animations cost one wakeup per frame instead of N.
+ Runs in the common run loop modes (keeps ticking during tracking) and only
+ while there are observers. Main thread only.
+ */
+@interface TUIFrameClock : NSObject
+
++ (TUIFrameClock *)sharedClock;
+
+@property (nonatomic, assign) NSTimeInterval frameInterval; // default 1/60
+
+/**
+ While paused the timer doesn't run and observers are only ticked by
+ -tickWithTimestamp:, e.g. by TUIEventReplayer driving a virtual clock.
+ */
+@property (nonatomic, assign, getter=isPaused) BOOL paused;
+- (void)tickWithTimestamp:(NSTimeInterval)timestamp;
+
+/**
+ Observers are not retained, remove them before they go away.
+ */
+- (void)addObserver:(id<TUIFrameClockObserver>)observer;
+- (void)removeObserver:(id<TUIFrameClockObserver>)observer;
+
+@end
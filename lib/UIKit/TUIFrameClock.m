@@ -0,0 +1,120 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIFrameClock.h"
+
+@interface TUIFrameClock ()
+{
+	NSMutableArray *_observers; // NSValue nonretained
+	NSTimer *_timer;
+	NSTimeInterval _frameInterval;
+	BOOL _paused;
+}
+@end
+
+@implementation TUIFrameClock
+
++ (TUIFrameClock *)sharedClock
+{
+	static TUIFrameClock *clock = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		clock = [[TUIFrameClock alloc] init];
+	});
+	return clock;
+}
+
+- (id)init
+{
+	if((self = [super init])) {
+		_observers = [[NSMutableArray alloc] init];
+		_frameInterval = 1.0 / 60.0;
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	[_timer invalidate];
+}
+
+- (NSTimeInterval)frameInterval
+{
+	return _frameInterval;
+}
+
+- (void)setFrameInterval:(NSTimeInterval)i
+{
+	_frameInterval = i;
+	if(_timer) {
+		[_timer invalidate];
+		_timer = nil;
+		[self _updateTimer];
+	}
+}
+
+- (BOOL)isPaused
+{
+	return _paused;
+}
+
+- (void)setPaused:(BOOL)p
+{
+	_paused = p;
+	[self _updateTimer];
+}
+
+- (void)_updateTimer
+{
+	BOOL run = [_observers count] > 0 && !_paused;
+	if(run && !_timer) {
+		_timer = [NSTimer timerWithTimeInterval:_frameInterval target:self selector:@selector(_tick:) userInfo:nil repeats:YES];
+		[[NSRunLoop mainRunLoop] addTimer:_timer forMode:NSRunLoopCommonModes];
+	} else if(!run && _timer) {
+		[_timer invalidate];
+		_timer = nil;
+	}
+}
+
+- (void)tickWithTimestamp:(NSTimeInterval)timestamp
+{
+	for(NSValue *v in [_observers copy]) { // observers may remove themselves
+		if([_observers containsObject:v])
+			[(id<TUIFrameClockObserver>)[v nonretainedObjectValue] frameClockDidTick:timestamp];
+	}
+}
+
+- (void)_tick:(NSTimer *)timer
+{
+	[self tickWithTimestamp:[NSDate timeIntervalSinceReferenceDate]];
+}
+
+- (void)addObserver:(id<TUIFrameClockObserver>)observer
+{
+	NSValue *v = [NSValue valueWithNonretainedObject:observer];
+	if(![_observers containsObject:v]) {
+		[_observers addObject:v];
+		[self _updateTimer];
+	}
+}
+
+- (void)removeObserver:(id<TUIFrameClockObserver>)observer
+{
+	[_observers removeObject:[NSValue valueWithNonretainedObject:observer]];
+	[self _updateTimer];
+}
+
+@end
@@ -0,0 +1,54 @@
+/*
+ Copyright 2011 Twitter, Inc.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIImage.h"
+
+typedef void(^TUIImageDecodeCompletion)(TUIImage *image);
+
+@interface TUIImage (Decoding)
+
+/**
+ Images created with +imageWithData: are decoded lazily by CoreGraphics, on
+ first draw. These force the decode into a display ready bitmap (premultiplied,
+ host byte order, rows aligned for Core Animation) so drawing is a plain blit.
+ */
++ (TUIImage *)decodedImageWithData:(NSData *)data; // thread safe
+- (TUIImage *)decodedImage; // thread safe, returns self if already display ready, keeps stretchable caps
+
+/**
+ Decode on a background queue and call 'completion' on the main queue.
+ If 'key' is non-nil, the result is looked up in and added to
+ +[TUIImageCache sharedCache], and concurrent requests for the same key share
+ a single decode ('key' should identify 'maxPixelSize' as well as the data).
+ 'completion' gets nil if the data can't be decoded.
+ */
++ (void)decodeImageWithData:(NSData *)data key:(id<NSCopying>)key completion:(TUIImageDecodeCompletion)completion;
++ (void)decodeImageWithData:(NSData *)data maxPixelSize:(NSUInteger)maxPixelSize key:(id<NSCopying>)key completion:(TUIImageDecodeCompletion)completion;
+
+/**
+ Decode so that neither dimension exceeds 'maxPixelSize' (0 means full size).
+ The codec subsamples while decoding where it can (e.g. JPEG), so peak memory
+ scales with the output rather than the source. Aspect ratio is preserved.
+ */
++ (TUIImage *)imageWithData:(NSData *)data maxPixelSize:(NSUInteger)maxPixelSize; // thread safe
+
+/**
+ Same result as [[TUIImage imageWithData:data] thumbnail:size], without ever
+ decoding the full size image.
+ */
++ (TUIImage *)thumbnailWithData:(NSData *)data size:(CGSize)size; // thread safe
+
+@end
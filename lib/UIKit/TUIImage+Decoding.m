@@ -0,0 +1,171 @@
+/*
+ Copyright 2011 Twitter, Inc.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIImage+Decoding.h"
+#import "TUIImageCache.h"
+#import "TUIImage+Private.h"
+#import "TUICGAdditions.h"
+#import "TUIStallWatchdog.h"
+
+#define TUIImageRowAlignment 64 // Core Animation copies bitmaps whose rows aren't aligned to this
+
+static size_t TUIImageAlignedBytesPerRow(size_t width)
+{
+	size_t bytesPerRow = width * 4;
+	return (bytesPerRow + (TUIImageRowAlignment - 1)) & ~(size_t)(TUIImageRowAlignment - 1);
+}
+
+static BOOL TUIImageHasAlpha(CGImageRef image)
+{
+	CGImageAlphaInfo alpha = CGImageGetAlphaInfo(image);
+	return !(alpha == kCGImageAlphaNone || alpha == kCGImageAlphaNoneSkipFirst || alpha == kCGImageAlphaNoneSkipLast);
+}
+
+static BOOL TUIImageIsDisplayReady(CGImageRef image)
+{
+	CGBitmapInfo info = CGImageGetBitmapInfo(image);
+	CGImageAlphaInfo alpha = CGImageGetAlphaInfo(image);
+	return CGImageGetBitsPerPixel(image) == 32 &&
+	       (info & kCGBitmapByteOrderMask) == kCGBitmapByteOrder32Host &&
+	       (alpha == kCGImageAlphaPremultipliedFirst || alpha == kCGImageAlphaNoneSkipFirst) &&
+	       (CGImageGetBytesPerRow(image) % TUIImageRowAlignment) == 0 &&
+	       CGImageGetColorSpace(image) && CFEqual(CGImageGetColorSpace(image), TUIGetBackingColorSpace());
+}
+
+static CGImageRef TUICreateDecodedCGImage(CGImageRef image)
+{
+	size_t width = CGImageGetWidth(image);
+	size_t height = CGImageGetHeight(image);
+	if(width == 0 || height == 0)
+		return NULL;
+	
+	// converting into the backing colour space here means drawing it later doesn't have to, on every draw
+	CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Host | (TUIImageHasAlpha(image) ? kCGImageAlphaPremultipliedFirst : kCGImageAlphaNoneSkipFirst);
+	CGContextRef ctx = CGBitmapContextCreate(NULL, width, height, 8, TUIImageAlignedBytesPerRow(width), TUIGetBackingColorSpace(), bitmapInfo);
+	if(!ctx)
+		return NULL;
+	
+	CGContextSetBlendMode(ctx, kCGBlendModeCopy);
+	CGContextDrawImage(ctx, CGRectMake(0, 0, width, height), image); // the actual decode happens here
+	CGImageRef decoded = CGBitmapContextCreateImage(ctx);
+	CGContextRelease(ctx);
+	return decoded;
+}
+
+static CGSize TUIImageSourcePixelSize(CGImageSourceRef source)
+{
+	CGSize s = CGSizeZero;
+	CFDictionaryRef properties = CGImageSourceCopyPropertiesAtIndex(source, 0, NULL);
+	if(properties) {
+		NSNumber *w = (__bridge NSNumber *)CFDictionaryGetValue(properties, kCGImagePropertyPixelWidth);
+		NSNumber *h = (__bridge NSNumber *)CFDictionaryGetValue(properties, kCGImagePropertyPixelHeight);
+		s = CGSizeMake([w doubleValue], [h doubleValue]);
+		CFRelease(properties);
+	}
+	return s;
+}
+
+@implementation TUIImage (Decoding)
+
++ (TUIImage *)imageWithData:(NSData *)data maxPixelSize:(NSUInteger)maxPixelSize
+{
+	if(maxPixelSize == 0)
+		return [self imageWithData:data];
+	
+	CGImageSourceRef imageSource = CGImageSourceCreateWithData((__bridge CFDataRef)data, NULL);
+	if(!imageSource)
+		return nil;
+	
+	CGSize s = TUIImageSourcePixelSize(imageSource);
+	if(s.width > 0 && s.height > 0 && MAX(s.width, s.height) <= maxPixelSize) {
+		// already small enough, don't let ImageIO hand back an embedded (lower quality) thumbnail
+		CFRelease(imageSource);
+		return [self imageWithData:data];
+	}
+	
+	NSDictionary *options = [NSDictionary dictionaryWithObjectsAndKeys:
+							 (id)kCFBooleanTrue, (id)kCGImageSourceCreateThumbnailFromImageAlways,
+							 (id)kCFBooleanTrue, (id)kCGImageSourceShouldCache,
+							 [NSNumber numberWithUnsignedInteger:maxPixelSize], (id)kCGImageSourceThumbnailMaxPixelSize,
+							 nil];
+	CGImageRef image = CGImageSourceCreateThumbnailAtIndex(imageSource, 0, (__bridge CFDictionaryRef)options);
+	CFRelease(imageSource);
+	if(!image) {
+		NSLog(@"could not create thumbnail at index 0");
+		return nil;
+	}
+	
+	TUIImage *i = [TUIImage imageWithCGImage:image];
+	CGImageRelease(image);
+	return i;
+}
+
++ (TUIImage *)thumbnailWithData:(NSData *)data size:(CGSize)size
+{
+	if(size.width < 1 || size.height < 1)
+		return nil;
+	
+	CGImageSourceRef imageSource = CGImageSourceCreateWithData((__bridge CFDataRef)data, NULL);
+	if(!imageSource)
+		return nil;
+	CGSize s = TUIImageSourcePixelSize(imageSource);
+	CFRelease(imageSource);
+	if(s.width < 1 || s.height < 1)
+		return [[self imageWithData:data] thumbnail:size];
+	
+	// -thumbnail: crops to fill, so decode just big enough to cover 'size' on both axes
+	CGFloat scale = MAX(size.width / s.width, size.height / s.height);
+	NSUInteger maxPixelSize = (scale < 1.0) ? (NSUInteger)ceil(MAX(s.width, s.height) * scale) : 0;
+	return [[self imageWithData:data maxPixelSize:maxPixelSize] thumbnail:size];
+}
+
++ (TUIImage *)decodedImageWithData:(NSData *)data
+{
+	return [[self imageWithData:data] decodedImage];
+}
+
+- (TUIImage *)decodedImage
+{
+	CGImageRef image = self.CGImage;
+	if(!image || TUIImageIsDisplayReady(image))
+		return self;
+	
+	TUIPhaseBegin(TUIPhaseImageDecode, self);
+	CGImageRef decoded = TUICreateDecodedCGImage(image);
+	TUIPhaseEnd();
+	if(!decoded)
+		return self;
+	
+	TUIImage *i = [TUIImage imageWithCGImage:decoded];
+	CGImageRelease(decoded);
+	if(self.leftCapWidth != 0 || self.topCapHeight != 0)
+		i = [i stretchableImageWithLeftCapWidth:self.leftCapWidth topCapHeight:self.topCapHeight]; // keep the caps
+	return i;
+}
+
++ (void)decodeImageWithData:(NSData *)data key:(id<NSCopying>)key completion:(TUIImageDecodeCompletion)completion
+{
+	[self decodeImageWithData:data maxPixelSize:0 key:key completion:completion];
+}
+
++ (void)decodeImageWithData:(NSData *)data maxPixelSize:(NSUInteger)maxPixelSize key:(id<NSCopying>)key completion:(TUIImageDecodeCompletion)completion
+{
+	TUIImageProduceAsync([TUIImageCache sharedCache], key, ^{
+		return [[self imageWithData:data maxPixelSize:maxPixelSize] decodedImage];
+	}, completion);
+}
+
+@end
@@ -25,7 +25,7 @@
 - (TUIImage *)crop:(CGRect)cropRect;
 - (TUIImage *)upsideDownCrop:(CGRect)cropRect;
 - (TUIImage *)scale:(CGSize)size;
-- (TUIImage *)thumbnail:(CGSize)size;
+- (TUIImage *)thumbnail:(CGSize)size; // when starting from data, +thumbnailWithData:size: avoids decoding the full size image
 - (TUIImage *)pad:(CGFloat)padding; // can be negative (to crop to center)
 - (TUIImage *)roundImage:(CGFloat)radius;
 - (TUIImage *)invertedMask;
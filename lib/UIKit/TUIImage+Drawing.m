@@ -16,6 +16,39 @@
 
 #import "TUIKit.h"
 #import "TUIImage+Drawing.h"
+#import "TUIPixelKernels.h"
+
+static BOOL TUIIsIntegral(CGFloat f)
+{
+	return f == floor(f);
+}
+
+// bitmap context holding a copy of 'image', for the pixel kernels to work on
+static CGContextRef TUICreateGraphicsContextWithImage(TUIImage *image)
+{
+	CGSize s = image.size;
+	CGContextRef ctx = TUICreateGraphicsContext(s);
+	if(ctx) {
+		CGContextSetBlendMode(ctx, kCGBlendModeCopy);
+		CGContextDrawImage(ctx, CGRectMake(0, 0, s.width, s.height), image.CGImage);
+		CGContextSetBlendMode(ctx, kCGBlendModeNormal);
+	}
+	return ctx;
+}
+
+// premultiplied pixel value of 'color' as the kernels see it
+static uint32_t TUIPixelForColor(TUIColor *color)
+{
+	uint32_t pixel = 0;
+	CGContextRef ctx = TUICreateGraphicsContext(CGSizeMake(1, 1));
+	if(!ctx)
+		return 0;
+	CGContextSetFillColorWithColor(ctx, color.CGColor);
+	CGContextFillRect(ctx, CGRectMake(0, 0, 1, 1));
+	pixel = *(uint32_t *)CGBitmapContextGetData(ctx);
+	CGContextRelease(ctx);
+	return pixel;
+}
 
 @implementation TUIImage (Drawing)
 
@@ -33,6 +66,23 @@
 
 - (TUIImage *)scale:(CGSize)size
 {
+	CGSize s = self.size;
+	if(size.width >= 1 && size.height >= 1 && TUIIsIntegral(size.width) && TUIIsIntegral(size.height) &&
+	   size.width * 2 >= s.width && size.height * 2 >= s.height) { // bilinear aliases below half size, CG filters those
+		CGContextRef srcCtx = TUICreateGraphicsContextWithImage(self);
+		CGContextRef ctx = srcCtx ? TUICreateGraphicsContext(size) : NULL;
+		if(ctx && TUIPixelBufferScaleBilinear(TUIPixelBufferFromBitmapContext(ctx), TUIPixelBufferFromBitmapContext(srcCtx))) {
+			TUIImage *i = TUIGraphicsContextGetImage(ctx);
+			CGContextRelease(ctx);
+			CGContextRelease(srcCtx);
+			return i;
+		}
+		if(ctx)
+			CGContextRelease(ctx);
+		if(srcCtx)
+			CGContextRelease(srcCtx);
+	}
+	
 	return [TUIImage imageWithSize:size drawing:^(CGContextRef ctx) {
 		CGRect r;
 		r.origin = CGPointZero;
@@ -106,6 +156,18 @@
 	CGRect r;
 	r.origin = CGPointZero;
 	r.size = self.size;
+	if(r.size.width < 1 || r.size.height < 1)
+		return nil;
+	
+	// same radius rounding as CGContextAddRoundRect(), the kernel clamps to the size
+	CGContextRef ctx = TUICreateGraphicsContextWithImage(self);
+	if(ctx) {
+		TUIPixelBufferRoundCorners(TUIPixelBufferFromBitmapContext(ctx), (NSUInteger)MAX(floor(radius), 0));
+		TUIImage *i = TUIGraphicsContextGetImage(ctx);
+		CGContextRelease(ctx);
+		return i;
+	}
+	
 	return [TUIImage imageWithSize:r.size drawing:^(CGContextRef ctx) {
 		CGContextClipToRoundRect(ctx, r, radius);
 		CGContextDrawImage(ctx, r, self.CGImage);
@@ -115,6 +177,18 @@
 - (TUIImage *)invertedMask
 {
 	CGSize s = self.size;
+	if(s.width < 1 || s.height < 1)
+		return nil;
+	
+	CGContextRef ctx = TUICreateGraphicsContextWithImage(self);
+	if(ctx) {
+		TUIPixelBuffer pixels = TUIPixelBufferFromBitmapContext(ctx);
+		TUIPixelBufferInvertAlpha(pixels, pixels);
+		TUIImage *i = TUIGraphicsContextGetImage(ctx);
+		CGContextRelease(ctx);
+		return i;
+	}
+	
 	return [TUIImage imageWithSize:s drawing:^(CGContextRef ctx) {
 		CGRect rect = CGRectMake(0, 0, s.width, s.height);
 		CGContextSetRGBFillColor(ctx, 0, 0, 0, 1);
@@ -126,10 +200,47 @@
 	}];
 }
 
+// same compositing as the CoreGraphics path of -innerShadowWithOffset:..., in one pass over the pixels, nil if out of memory
+static TUIImage *TUIInnerShadowWithKernels(TUIImage *paddedImage, CGSize offset, CGFloat radius, TUIColor *color, TUIColor *backgroundColor)
+{
+	CGContextRef ctx = TUICreateGraphicsContextWithImage(paddedImage);
+	if(!ctx)
+		return nil;
+	TUIPixelBuffer pixels = TUIPixelBufferFromBitmapContext(ctx);
+	size_t planeSize = pixels.width * pixels.height;
+	uint8_t *planes = malloc(planeSize * 3);
+	if(!planes) {
+		CGContextRelease(ctx);
+		return nil;
+	}
+	TUIAlphaBuffer shape = {planes, pixels.width, pixels.height, pixels.width};
+	TUIAlphaBuffer fill = {planes + planeSize, pixels.width, pixels.height, pixels.width};
+	TUIAlphaBuffer blurred = {planes + planeSize * 2, pixels.width, pixels.height, pixels.width};
+	
+	TUIAlphaBufferFromPixelBuffer(shape, pixels, NO, 0, 0, 0);
+	TUIAlphaBufferFromPixelBuffer(fill, pixels, YES, 0, 0, 0);
+	TUIAlphaBufferFromPixelBuffer(blurred, pixels, YES, (NSInteger)offset.width, -(NSInteger)offset.height, 0);
+	TUIImage *shadowImage = nil;
+	if(TUIAlphaBufferBoxBlur(blurred, (NSUInteger)round(radius / 2), 3)) { // CG shadows are a gaussian with sigma ~= radius / 2
+		TUIPixelBufferCompositeInnerShadow(pixels, shape, fill, blurred, TUIPixelForColor(color), TUIPixelForColor(backgroundColor));
+		shadowImage = TUIGraphicsContextGetImage(ctx);
+	}
+	free(planes);
+	CGContextRelease(ctx);
+	return shadowImage;
+}
+
 - (TUIImage *)innerShadowWithOffset:(CGSize)offset radius:(CGFloat)radius color:(TUIColor *)color backgroundColor:(TUIColor *)backgroundColor
 {
 	CGFloat padding = ceil(radius);
 	TUIImage *paddedImage = [self pad:padding];
+	
+	if(paddedImage && TUIIsIntegral(offset.width) && TUIIsIntegral(offset.height)) {
+		TUIImage *shadowImage = TUIInnerShadowWithKernels(paddedImage, offset, radius, color, backgroundColor);
+		if(shadowImage)
+			return [shadowImage pad:-padding];
+	}
+	
 	TUIImage *shadowImage = [TUIImage imageWithSize:paddedImage.size drawing:^(CGContextRef ctx) {
 		CGContextSaveGState(ctx);
 		CGRect r = CGRectMake(0, 0, paddedImage.size.width, paddedImage.size.height);
@@ -153,6 +264,22 @@
 	CGFloat padding = MAX(offset.width, offset.height) + 1;
 	TUIImage *paddedImage = [self pad:padding];
 	CGSize s = paddedImage.size;
+	
+	if(paddedImage && TUIIsIntegral(offset.width) && TUIIsIntegral(offset.height)) {
+		CGContextRef srcCtx = TUICreateGraphicsContextWithImage(paddedImage);
+		CGContextRef ctx = srcCtx ? TUICreateGraphicsContext(s) : NULL;
+		if(ctx) {
+			// CG's y axis points up, rows in memory go down
+			TUIPixelBufferEmbossAlpha(TUIPixelBufferFromBitmapContext(ctx), TUIPixelBufferFromBitmapContext(srcCtx), (NSInteger)offset.width, -(NSInteger)offset.height);
+			TUIImage *embossedImage = TUIGraphicsContextGetImage(ctx);
+			CGContextRelease(ctx);
+			CGContextRelease(srcCtx);
+			return [embossedImage pad:-padding];
+		}
+		if(srcCtx)
+			CGContextRelease(srcCtx);
+	}
+	
 	TUIImage *embossedImage = [TUIImage imageWithSize:s drawing:^(CGContextRef ctx) {
 		CGContextSaveGState(ctx);
 		CGRect r = CGRectMake(0, 0, s.width, s.height);
@@ -0,0 +1,46 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIImage.h"
+
+typedef enum {
+	TUIImageEncodingDefault = 0, // baseline JPEG, PNG written as-is
+	TUIImageEncodingSmall,       // progressive JPEG, opaque images written to PNG without an alpha channel (costs a copy)
+} TUIImageEncodingOptions;
+
+typedef void(^TUIImageEncodeCompletion)(NSData *data);
+typedef void(^TUIImageWriteCompletion)(BOOL success);
+
+@interface TUIImage (Encoding)
+
+/**
+ Synchronous, on the calling thread. 'type' is a UTI (kUTTypePNG,
+ kUTTypeJPEG, ...); 'quality' is ignored by lossless formats.
+ */
+- (NSData *)encodedDataWithType:(NSString *)type quality:(CGFloat)quality options:(TUIImageEncodingOptions)options; // thread safe
+- (BOOL)writeToFileDescriptor:(int)fd type:(NSString *)type quality:(CGFloat)quality options:(TUIImageEncodingOptions)options; // thread safe
+
+/**
+ Encode on a background worker and call 'completion' on the main queue.
+ At most one encode per processor runs at a time, the rest wait their turn.
+ Writing to a file descriptor streams the encoder output as it is produced,
+ without building the whole file in memory; 'fd' must stay open until the
+ completion is called and is not closed.
+ */
+- (void)encodeWithType:(NSString *)type quality:(CGFloat)quality options:(TUIImageEncodingOptions)options completion:(TUIImageEncodeCompletion)completion;
+- (void)writeToFileDescriptor:(int)fd type:(NSString *)type quality:(CGFloat)quality options:(TUIImageEncodingOptions)options completion:(TUIImageWriteCompletion)completion;
+
+@end
@@ -0,0 +1,226 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIImage+Encoding.h"
+#import <errno.h>
+#import <unistd.h>
+
+static BOOL TUIImageIsOpaqueWithAlphaChannel(CGImageRef image)
+{
+	CGImageAlphaInfo alpha = CGImageGetAlphaInfo(image);
+	if(alpha == kCGImageAlphaNone || alpha == kCGImageAlphaNoneSkipFirst || alpha == kCGImageAlphaNoneSkipLast)
+		return NO; // no alpha to drop
+	if(CGImageGetBitsPerComponent(image) != 8 || CGImageGetBitsPerPixel(image) != 32)
+		return NO;
+	
+	CFDataRef data = CGDataProviderCopyData(CGImageGetDataProvider(image));
+	if(!data)
+		return NO;
+	const uint8_t *bytes = CFDataGetBytePtr(data);
+	size_t width = CGImageGetWidth(image);
+	size_t height = CGImageGetHeight(image);
+	size_t bytesPerRow = CGImageGetBytesPerRow(image);
+	BOOL alphaFirst = (alpha == kCGImageAlphaFirst || alpha == kCGImageAlphaPremultipliedFirst);
+	BOOL littleEndian = (CGImageGetBitmapInfo(image) & kCGBitmapByteOrderMask) == kCGBitmapByteOrder32Little;
+	size_t alphaByte = (alphaFirst != littleEndian) ? 0 : 3;
+	
+	BOOL opaque = YES;
+	for(size_t y = 0; y < height && opaque; ++y) {
+		const uint8_t *p = bytes + y * bytesPerRow + alphaByte;
+		for(size_t x = 0; x < width; ++x, p += 4) {
+			if(*p != 0xff) {
+				opaque = NO;
+				break;
+			}
+		}
+	}
+	CFRelease(data);
+	return opaque;
+}
+
+static CGImageRef TUICreateImageWithoutAlpha(CGImageRef image)
+{
+	size_t width = CGImageGetWidth(image);
+	size_t height = CGImageGetHeight(image);
+	// keep the image's own space, converting would change the pixels and the profile written out
+	CGColorSpaceRef colorSpace = CGImageGetColorSpace(image);
+	CGColorSpaceRef sRGB = NULL;
+	if(!colorSpace || CGColorSpaceGetModel(colorSpace) != kCGColorSpaceModelRGB)
+		colorSpace = sRGB = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+	CGContextRef ctx = CGBitmapContextCreate(NULL, width, height, 8, width * 4, colorSpace, kCGBitmapByteOrder32Host | kCGImageAlphaNoneSkipFirst);
+	CGColorSpaceRelease(sRGB);
+	if(!ctx)
+		return NULL;
+	CGContextSetBlendMode(ctx, kCGBlendModeCopy);
+	CGContextDrawImage(ctx, CGRectMake(0, 0, width, height), image);
+	CGImageRef result = CGBitmapContextCreateImage(ctx);
+	CGContextRelease(ctx);
+	return result;
+}
+
+static BOOL TUIImageEncode(CGImageRef image, CGImageDestinationRef destination, NSString *type, CGFloat quality, TUIImageEncodingOptions options)
+{
+	if(!image || !destination)
+		return NO;
+	
+	NSMutableDictionary *properties = [NSMutableDictionary dictionary];
+	[properties setObject:[NSNumber numberWithDouble:quality] forKey:(__bridge NSString *)kCGImageDestinationLossyCompressionQuality];
+	
+	CGImageRef encoded = CGImageRetain(image);
+	if(UTTypeConformsTo((__bridge CFStringRef)type, kUTTypeJPEG)) {
+		if(options == TUIImageEncodingSmall) {
+			NSDictionary *jfif = [NSDictionary dictionaryWithObject:[NSNumber numberWithBool:YES] forKey:(__bridge NSString *)kCGImagePropertyJFIFIsProgressive];
+			[properties setObject:jfif forKey:(__bridge NSString *)kCGImagePropertyJFIFDictionary];
+		}
+	} else if(UTTypeConformsTo((__bridge CFStringRef)type, kUTTypePNG)) {
+		if(options == TUIImageEncodingSmall && TUIImageIsOpaqueWithAlphaChannel(image)) {
+			CGImageRef withoutAlpha = TUICreateImageWithoutAlpha(image); // RGB rather than RGBA rows compress better
+			if(withoutAlpha) {
+				CGImageRelease(encoded);
+				encoded = withoutAlpha;
+			}
+		}
+	}
+	
+	CGImageDestinationAddImage(destination, encoded, (__bridge CFDictionaryRef)properties);
+	BOOL success = CGImageDestinationFinalize(destination);
+	CGImageRelease(encoded);
+	return success;
+}
+
+static size_t TUIFileDescriptorPutBytes(void *info, const void *buffer, size_t count)
+{
+	int fd = (int)(intptr_t)info;
+	size_t written = 0;
+	while(written < count) {
+		ssize_t n = write(fd, (const uint8_t *)buffer + written, count - written);
+		if(n < 0) {
+			if(errno == EINTR)
+				continue;
+			NSLog(@"TUIImage: write to fd %d failed: %s", fd, strerror(errno));
+			break;
+		}
+		written += n;
+	}
+	return written; // a short count makes the destination fail
+}
+
+/*
+ At most one encode per processor runs at a time, which bounds the decoded
+ copies and encoder buffers alive at once. Jobs over the limit wait in a list
+ instead of parking a GCD worker each (GCD would make more threads to
+ replace the blocked ones); a finishing job starts the next.
+ */
+
+static dispatch_queue_t TUIImageEncodeControlQueue = NULL; // guards the following
+static NSMutableArray *TUIImageEncodePendingJobs = nil;
+static NSUInteger TUIImageEncodeRunningJobs = 0;
+static NSUInteger TUIImageEncodeMaxRunningJobs = 0;
+
+static void TUIImageEncodeStartJobs(void) // on TUIImageEncodeControlQueue
+{
+	while(TUIImageEncodeRunningJobs < TUIImageEncodeMaxRunningJobs && [TUIImageEncodePendingJobs count] > 0) {
+		dispatch_block_t block = [TUIImageEncodePendingJobs objectAtIndex:0];
+		[TUIImageEncodePendingJobs removeObjectAtIndex:0];
+		TUIImageEncodeRunningJobs++;
+		dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0), ^{
+			block();
+			dispatch_async(TUIImageEncodeControlQueue, ^{
+				TUIImageEncodeRunningJobs--;
+				TUIImageEncodeStartJobs();
+			});
+		});
+	}
+}
+
+static void TUIImageEncodeAsync(dispatch_block_t block)
+{
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		TUIImageEncodeControlQueue = dispatch_queue_create("com.twitter.TUIImage.encode", NULL);
+		TUIImageEncodePendingJobs = [[NSMutableArray alloc] init];
+		TUIImageEncodeMaxRunningJobs = MAX([[NSProcessInfo processInfo] activeProcessorCount], 1);
+	});
+	
+	block = [block copy];
+	dispatch_async(TUIImageEncodeControlQueue, ^{
+		[TUIImageEncodePendingJobs addObject:block];
+		TUIImageEncodeStartJobs();
+	});
+}
+
+@implementation TUIImage (Encoding)
+
+- (NSData *)encodedDataWithType:(NSString *)type quality:(CGFloat)quality options:(TUIImageEncodingOptions)options
+{
+	if(!self.CGImage)
+		return nil;
+	
+	NSMutableData *data = [NSMutableData data];
+	CGImageDestinationRef destination = CGImageDestinationCreateWithData((__bridge CFMutableDataRef)data, (__bridge CFStringRef)type, 1, NULL);
+	if(!destination)
+		return nil;
+	BOOL success = TUIImageEncode(self.CGImage, destination, type, quality, options);
+	CFRelease(destination);
+	return success ? data : nil;
+}
+
+- (BOOL)writeToFileDescriptor:(int)fd type:(NSString *)type quality:(CGFloat)quality options:(TUIImageEncodingOptions)options
+{
+	if(!self.CGImage || fd < 0)
+		return NO;
+	
+	CGDataConsumerCallbacks callbacks = { TUIFileDescriptorPutBytes, NULL };
+	CGDataConsumerRef consumer = CGDataConsumerCreate((void *)(intptr_t)fd, &callbacks);
+	if(!consumer)
+		return NO;
+	CGImageDestinationRef destination = CGImageDestinationCreateWithDataConsumer(consumer, (__bridge CFStringRef)type, 1, NULL);
+	BOOL success = NO;
+	if(destination) {
+		success = TUIImageEncode(self.CGImage, destination, type, quality, options);
+		CFRelease(destination);
+	}
+	CGDataConsumerRelease(consumer);
+	return success;
+}
+
+- (void)encodeWithType:(NSString *)type quality:(CGFloat)quality options:(TUIImageEncodingOptions)options completion:(TUIImageEncodeCompletion)completion
+{
+	completion = [completion copy];
+	TUIImageEncodeAsync(^{
+		NSData *data = [self encodedDataWithType:type quality:quality options:options];
+		if(completion) {
+			dispatch_async(dispatch_get_main_queue(), ^{
+				completion(data);
+			});
+		}
+	});
+}
+
+- (void)writeToFileDescriptor:(int)fd type:(NSString *)type quality:(CGFloat)quality options:(TUIImageEncodingOptions)options completion:(TUIImageWriteCompletion)completion
+{
+	completion = [completion copy];
+	TUIImageEncodeAsync(^{
+		BOOL success = [self writeToFileDescriptor:fd type:type quality:quality options:options];
+		if(completion) {
+			dispatch_async(dispatch_get_main_queue(), ^{
+				completion(success);
+			});
+		}
+	});
+}
+
+@end
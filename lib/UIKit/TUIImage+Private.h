@@ -0,0 +1,29 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIImage.h"
+
+@class TUIImageCache;
+
+/**
+ Produces an image with 'work' on a background queue and calls 'completion'
+ on the main queue, also when the result comes straight from 'cache'.
+ 
+ If 'key' is non-nil the result is looked up in and added to 'cache', and
+ concurrent requests for the same key and cache share a single call of
+ 'work'. Used by the asynchronous decoding and effect rendering APIs.
+ */
+extern void TUIImageProduceAsync(TUIImageCache *cache, id<NSCopying> key, TUIImage *(^work)(void), void(^completion)(TUIImage *image));
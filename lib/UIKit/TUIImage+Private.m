@@ -0,0 +1,89 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIImage+Private.h"
+#import "TUIImageCache.h"
+
+void TUIImageProduceAsync(TUIImageCache *cache, id<NSCopying> key, TUIImage *(^work)(void), void(^completion)(TUIImage *image))
+{
+	static NSMutableDictionary *pendingCompletions = nil; // (cache, key) -> NSMutableArray of completions, only touched on 'pendingQueue'
+	static dispatch_queue_t pendingQueue = NULL;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		pendingCompletions = [[NSMutableDictionary alloc] init];
+		pendingQueue = dispatch_queue_create("com.twitter.TUIImage.produce", NULL);
+	});
+	
+	work = [work copy];
+	completion = [completion copy];
+	
+	id pendingKey = nil;
+	if(key) {
+		__block TUIImage *cached = [cache imageForKey:key];
+		__block BOOL alreadyProducing = NO;
+		if(!cached) {
+			// keys are only unique within a cache
+			pendingKey = [NSArray arrayWithObjects:[NSValue valueWithNonretainedObject:cache], [(id)key copy], nil];
+			dispatch_sync(pendingQueue, ^{
+				NSMutableArray *completions = [pendingCompletions objectForKey:pendingKey];
+				alreadyProducing = (completions != nil);
+				if(!completions) {
+					// a producer may have finished since the lookup above, it caches before leaving the pending set
+					cached = [cache imageForKey:key];
+					if(cached)
+						return;
+					completions = [NSMutableArray array];
+					[pendingCompletions setObject:completions forKey:pendingKey];
+				}
+				if(completion)
+					[completions addObject:completion];
+			});
+		}
+		if(cached) {
+			if(completion) {
+				dispatch_async(dispatch_get_main_queue(), ^{
+					completion(cached);
+				});
+			}
+			return;
+		}
+		if(alreadyProducing)
+			return;
+	}
+	
+	dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+		TUIImage *image = work();
+		
+		__block NSArray *completions = nil;
+		if(pendingKey) {
+			if(image)
+				[cache setImage:image forKey:key];
+			dispatch_sync(pendingQueue, ^{
+				completions = [pendingCompletions objectForKey:pendingKey];
+				[pendingCompletions removeObjectForKey:pendingKey];
+			});
+		} else if(completion) {
+			completions = [NSArray arrayWithObject:completion];
+		}
+		
+		if([completions count] > 0) {
+			dispatch_async(dispatch_get_main_queue(), ^{
+				for(void(^c)(TUIImage *) in completions)
+					c(image);
+			});
+		}
+	});
+}
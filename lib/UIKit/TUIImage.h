@@ -21,8 +21,8 @@
   CGImageRef  _imageRef;
 }
 
-+ (TUIImage *)imageNamed:(NSString *)name;
-+ (TUIImage *)imageNamed:(NSString *)name cache:(BOOL)shouldCache;
++ (TUIImage *)imageNamed:(NSString *)name; // cache = YES
++ (TUIImage *)imageNamed:(NSString *)name cache:(BOOL)shouldCache; // safe to call from any thread
 
 + (TUIImage *)imageWithData:(NSData *)data;
 + (TUIImage *)imageWithCGImage:(CGImageRef)imageRef;
@@ -55,3 +55,5 @@ extern NSData *TUIImagePNGRepresentation(TUIImage *image);
 extern NSData *TUIImageJPEGRepresentation(TUIImage *image, CGFloat compressionQuality);
 
 #import "TUIImage+Drawing.h"
+#import "TUIImage+Decoding.h"
+#import "TUIImage+Encoding.h"
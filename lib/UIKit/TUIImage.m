@@ -16,6 +16,8 @@
 
 #import "TUIImage.h"
 #import "TUIKit.h"
+#import "TUIImageCache.h"
+#import "TUIAssetPack.h"
 
 @interface TUIStretchableImage : TUIImage
 {
@@ -24,12 +26,17 @@
 	NSInteger topCapHeight;
 	@private
 	__strong TUIImage *slices[9];
+	TUIImageCache *composites; // pre-composited bitmaps of recently drawn sizes, keyed by pixel size
+	NSMutableSet *pendingComposites; // keys being composited in the background, @synchronized on itself
 	struct {
 		unsigned int haveSlices:1;
 	} _flags;
 }
 @end
 
+#define TUIStretchableImageCompositeCacheLimit (1024 * 1024)
+#define TUIStretchableImageMaxCompositeCost (TUIStretchableImageCompositeCacheLimit / 4) // don't keep huge one-off sizes around
+
 
 @implementation TUIImage
 
@@ -43,24 +50,30 @@
 	if(!name)
 		return nil;
 	
-	static NSMutableDictionary *cache = nil;
-	if(!cache) {
-		cache = [[NSMutableDictionary alloc] init];
-	}
+	// pre-decoded and memory mapped, nothing to read or cache
+	TUIImage *packedImage = [[TUIAssetPack mainBundlePack] imageNamed:name];
+	if(packedImage)
+		return packedImage;
+	
+	NSURL *url = [[[NSBundle mainBundle] resourceURL] URLByAppendingPathComponent:name];
+	if(!url)
+		return nil;
 	
-	TUIImage *image = [cache objectForKey:name];
+	// key by the full path, not just the name, so identically named resources don't collide
+	NSString *key = [url absoluteString];
+	TUIImageCache *cache = [TUIImageCache sharedCache];
+	TUIImage *image = [cache imageForKey:key];
 	if(image)
 		return image;
 	
-	NSURL *url = [[[NSBundle mainBundle] resourceURL] URLByAppendingPathComponent:name];
-	if(url) {
-		NSData *data = [NSData dataWithContentsOfURL:url];
-		if(data) {
-			image = [self imageWithData:data];
-			if(image) {
-				if(shouldCache) {
-					[cache setObject:image forKey:name];
-				}
+	NSData *data = [NSData dataWithContentsOfURL:url];
+	if(data) {
+		image = [self imageWithData:data];
+		if(image) {
+			if(shouldCache) {
+				// decode and convert to the backing colour space once, rather than on every draw of the cached image
+				image = [image decodedImage];
+				[cache setImage:image forKey:key];
 			}
 		}
 	}
@@ -70,7 +83,7 @@
 
 + (TUIImage *)imageNamed:(NSString *)name
 {
-	return [self imageNamed:name cache:NO]; // differs from default UIKit, use explicit cache: for caching
+	return [self imageNamed:name cache:YES]; // cached in +[TUIImageCache sharedCache], which is bounded and evicts on its own
 }
 
 + (TUIImage *)imageWithData:(NSData *)data
@@ -211,6 +224,7 @@
 		CGContextSaveGState(ctx);
 		CGContextSetAlpha(ctx, alpha);
 		CGContextSetBlendMode(ctx, blendMode);
+		TUINoteImageDrawnInContext(_imageRef, ctx);
 		CGContextDrawImage(ctx, rect, _imageRef);
 		CGContextRestoreGState(ctx);
 	}
@@ -231,23 +245,14 @@
 	TUIStretchableImage *i = (TUIStretchableImage *)[TUIStretchableImage imageWithCGImage:_imageRef];
 	i->leftCapWidth = leftCapWidth;
 	i->topCapHeight = topCapHeight;
+	i->composites = [[TUIImageCache alloc] initWithTotalCostLimit:TUIStretchableImageCompositeCacheLimit];
+	i->pendingComposites = [[NSMutableSet alloc] init];
 	return i;
 }
 
 - (NSData *)dataRepresentationForType:(NSString *)type compression:(CGFloat)compressionQuality
 {
-	if(_imageRef) {
-		NSMutableData *mutableData = [NSMutableData data];
-		CGImageDestinationRef destination = CGImageDestinationCreateWithData((__bridge CFMutableDataRef)mutableData, (__bridge CFStringRef)type, 1, NULL);
-		
-		NSDictionary *properties = [NSDictionary dictionaryWithObjectsAndKeys:[NSNumber numberWithFloat:compressionQuality], kCGImageDestinationLossyCompressionQuality, nil];
-		CGImageDestinationAddImage(destination, _imageRef, (__bridge CFDictionaryRef)properties);
-		
-		CGImageDestinationFinalize(destination);
-		CFRelease(destination);
-		return mutableData;
-	}
-	return nil;
+	return [self encodedDataWithType:type quality:compressionQuality options:TUIImageEncodingDefault];
 }
 
 @end
@@ -312,7 +317,7 @@
 	r[7] = CGRectMake(x1, y2, x2-x1, y3-y2); \
 	r[8] = CGRectMake(x2, y2, x3-x2, y3-y2);
 
-- (void)drawInRect:(CGRect)rect blendMode:(CGBlendMode)blendMode alpha:(CGFloat)alpha
+- (void)_getCapsTop:(CGFloat *)top left:(CGFloat *)left
 {
 	CGSize s = self.size;
 	CGFloat t = topCapHeight;
@@ -321,7 +326,17 @@
 	if(t*2 > s.height-1) t -= 1;
 	if(l*2 > s.width-1) l -= 1;
 	
-	if(_imageRef) {
+	*top = t;
+	*left = l;
+}
+
+- (void)_drawSlicesInRect:(CGRect)rect context:(CGContextRef)ctx // thread safe
+{
+	CGSize s = self.size;
+	CGFloat t, l;
+	[self _getCapsTop:&t left:&l];
+	
+	@synchronized(self) {
 		if(!_flags.haveSlices) {
 			STRETCH_COORDS(0.0, 0.0, s.width, s.height, t, l, t, l)
 			#define X(I) slices[I] = [self upsideDownCrop:r[I]];
@@ -331,18 +346,85 @@
 			#undef X
 			_flags.haveSlices = 1;
 		}
-		
+	}
+	
+	STRETCH_COORDS(rect.origin.x, rect.origin.y, rect.size.width, rect.size.height, t, l, t, l)
+	TUINoteImageDrawnInContext(_imageRef, ctx); // slices share the source's colour space, count once
+	#define X(I) CGContextDrawImage(ctx, r[I], slices[I].CGImage);
+	X(0) X(1) X(2)
+	X(3) X(4) X(5)
+	X(6) X(7) X(8)
+	#undef X
+}
+
+- (TUIImage *)_compositeForPixelSize:(CGSize)pixelSize scale:(CGFloat)scale
+{
+	return [TUIImage imageWithSize:pixelSize drawing:^(CGContextRef ctx) {
+		CGContextScaleCTM(ctx, scale, scale);
+		[self _drawSlicesInRect:CGRectMake(0, 0, pixelSize.width / scale, pixelSize.height / scale) context:ctx];
+	}];
+}
+
+- (void)_prepareCompositeForPixelSize:(CGSize)pixelSize scale:(CGFloat)scale key:(NSString *)key
+{
+	if(pixelSize.width * pixelSize.height * 4 > TUIStretchableImageMaxCompositeCost)
+		return;
+	
+	@synchronized(pendingComposites) {
+		if([pendingComposites containsObject:key])
+			return;
+		[pendingComposites addObject:key];
+	}
+	
+	dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0), ^{
+		TUIImage *composite = [self _compositeForPixelSize:pixelSize scale:scale];
+		[composites setImage:composite forKey:key];
+		@synchronized(pendingComposites) {
+			[pendingComposites removeObject:key];
+		}
+	});
+}
+
+/**
+ Target sizes repeat a lot (row widths, fixed button sizes), so the first draw
+ at a size does the nine slice draw and composites that size in the
+ background; later draws at the same pixel size are a single blit.
+ */
+- (void)drawInRect:(CGRect)rect blendMode:(CGBlendMode)blendMode alpha:(CGFloat)alpha
+{
+	if(_imageRef) {
 		CGContextRef ctx = TUIGraphicsGetCurrentContext();
+		
+		// only cache when the destination is whole device pixels, at a whole pixel origin, without rotation, otherwise the blit would resample
+		TUIImage *composite = nil;
+		NSString *key = nil;
+		CGFloat scale = 0.0;
+		CGSize pixelSize = CGSizeZero;
+		CGAffineTransform m = CGContextGetUserSpaceToDeviceSpaceTransform(ctx);
+		if(m.b == 0.0 && m.c == 0.0 && m.a > 0.0 && m.a == fabs(m.d)) {
+			scale = m.a;
+			pixelSize = CGSizeMake(rect.size.width * scale, rect.size.height * scale);
+			CGPoint pixelOrigin = CGPointApplyAffineTransform(rect.origin, m);
+			if(pixelSize.width >= 1 && pixelSize.height >= 1 && pixelSize.width == floor(pixelSize.width) && pixelSize.height == floor(pixelSize.height) &&
+			   pixelOrigin.x == floor(pixelOrigin.x) && pixelOrigin.y == floor(pixelOrigin.y)) {
+				key = [NSString stringWithFormat:@"%gx%g@%g", pixelSize.width, pixelSize.height, scale];
+				composite = [composites imageForKey:key];
+			}
+		}
+		
 		CGContextSaveGState(ctx);
 		CGContextSetAlpha(ctx, alpha);
 		CGContextSetBlendMode(ctx, blendMode);
-		STRETCH_COORDS(rect.origin.x, rect.origin.y, rect.size.width, rect.size.height, t, l, t, l)
-		#define X(I) CGContextDrawImage(ctx, r[I], slices[I].CGImage);
-		X(0) X(1) X(2)
-		X(3) X(4) X(5)
-		X(6) X(7) X(8)
-		#undef X
+		if(composite) {
+			TUINoteImageDrawnInContext(composite.CGImage, ctx);
+			CGContextDrawImage(ctx, rect, composite.CGImage);
+		} else {
+			[self _drawSlicesInRect:rect context:ctx];
+		}
 		CGContextRestoreGState(ctx);
+		
+		if(key && !composite)
+			[self _prepareCompositeForPixelSize:pixelSize scale:scale key:key];
 	}
 }
 
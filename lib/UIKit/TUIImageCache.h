@@ -0,0 +1,77 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class TUIImage;
+
+/**
+ Thread safe LRU cache of decoded images, bounded by the number of bytes the
+ decoded bitmaps occupy rather than by the number of entries.
+ */
+@interface TUIImageCache : NSObject
+
+/**
+ Cache used by +[TUIImage imageNamed:]. Trims itself on memory pressure, and
+ empties itself when the backing colour space changes.
+ */
++ (TUIImageCache *)sharedCache;
+
+/**
+ Default is 32MB. Setting a lower limit evicts immediately.
+ */
+@property (nonatomic, assign) NSUInteger totalCostLimit;
+@property (nonatomic, readonly) NSUInteger totalCost;
+@property (nonatomic, readonly) NSUInteger count;
+
+@property (nonatomic, readonly) NSUInteger hitCount;
+@property (nonatomic, readonly) NSUInteger missCount;
+
+- (id)initWithTotalCostLimit:(NSUInteger)limit;
+
+- (TUIImage *)imageForKey:(id<NSCopying>)key;
+- (void)setImage:(TUIImage *)image forKey:(id<NSCopying>)key; // cost is the decoded size of the image
+- (void)setImage:(TUIImage *)image forKey:(id<NSCopying>)key cost:(NSUInteger)cost;
+- (void)removeImageForKey:(id<NSCopying>)key;
+- (void)removeAllImages;
+
+/**
+ The same cache for objects other than images (e.g. TUIShapeCache's gradients and nine-slices),
+ with the cost in whatever unit the owner chooses. Don't mix these with the
+ image methods on one cache.
+ */
+- (id)objectForKey:(id<NSCopying>)key;
+- (void)setObject:(id)object forKey:(id<NSCopying>)key cost:(NSUInteger)cost;
+
+/**
+ Evict least recently used images until totalCost <= cost.
+ */
+- (void)trimToCost:(NSUInteger)cost;
+
+/**
+ Called automatically for the shared cache on systems that report memory
+ pressure. Drops everything but the most recently used half of the budget.
+ */
+- (void)trimForMemoryPressure;
+
+- (void)resetStatistics;
+
+@end
+
+/**
+ Bytes occupied by the decoded bitmap of an image.
+ */
+extern NSUInteger TUIImageDecodedByteCount(TUIImage *image);
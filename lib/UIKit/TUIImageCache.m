@@ -0,0 +1,308 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIImageCache.h"
+#import "TUIImage.h"
+#import "TUICGAdditions.h"
+#import <pthread.h>
+
+#define TUIImageCacheDefaultCostLimit (32 * 1024 * 1024)
+
+NSUInteger TUIImageDecodedByteCount(TUIImage *image)
+{
+	CGImageRef i = image.CGImage;
+	if(!i)
+		return 0;
+	return CGImageGetBytesPerRow(i) * CGImageGetHeight(i);
+}
+
+@interface TUIImageCacheEntry : NSObject
+{
+	@public
+	id key;
+	id object;
+	NSUInteger cost;
+	__unsafe_unretained TUIImageCacheEntry *prev; // list is owned by the dictionary
+	__unsafe_unretained TUIImageCacheEntry *next;
+}
+@end
+
+@implementation TUIImageCacheEntry
+@end
+
+@interface TUIImageCache ()
+{
+	pthread_mutex_t _lock;
+	NSMutableDictionary *_entries;
+	__unsafe_unretained TUIImageCacheEntry *_head; // most recently used
+	__unsafe_unretained TUIImageCacheEntry *_tail; // least recently used
+	NSUInteger _totalCost;
+	NSUInteger _totalCostLimit;
+	NSUInteger _hitCount;
+	NSUInteger _missCount;
+}
+- (void)_installMemoryPressureHandler;
+@end
+
+@implementation TUIImageCache
+
++ (TUIImageCache *)sharedCache
+{
+	static TUIImageCache *sharedCache = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		sharedCache = [[TUIImageCache alloc] init];
+		[sharedCache _installMemoryPressureHandler];
+		// cached images were converted to the old colour space, drawing them now would convert every time
+		[[NSNotificationCenter defaultCenter] addObserver:sharedCache selector:@selector(removeAllImages) name:TUIBackingColorSpaceDidChangeNotification object:nil];
+	});
+	return sharedCache;
+}
+
+- (id)initWithTotalCostLimit:(NSUInteger)limit
+{
+	if((self = [super init])) {
+		pthread_mutex_init(&_lock, NULL);
+		_entries = [[NSMutableDictionary alloc] init];
+		_totalCostLimit = limit;
+	}
+	return self;
+}
+
+- (id)init
+{
+	return [self initWithTotalCostLimit:TUIImageCacheDefaultCostLimit];
+}
+
+- (void)dealloc
+{
+	pthread_mutex_destroy(&_lock);
+}
+
+- (void)_installMemoryPressureHandler
+{
+#ifdef DISPATCH_SOURCE_TYPE_MEMORYPRESSURE
+	// weak linked on systems before 10.9
+	if(&_dispatch_source_type_memorypressure == NULL)
+		return;
+	dispatch_source_t source = dispatch_source_create(DISPATCH_SOURCE_TYPE_MEMORYPRESSURE, 0, DISPATCH_MEMORYPRESSURE_WARN | DISPATCH_MEMORYPRESSURE_CRITICAL, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0));
+	if(!source)
+		return;
+	dispatch_source_set_event_handler(source, ^{
+		[self trimForMemoryPressure];
+	});
+	dispatch_resume(source); // lives as long as the shared cache
+#endif
+}
+
+/*
+ * The following must be called with _lock held.
+ */
+
+- (void)_unlink:(TUIImageCacheEntry *)e
+{
+	if(e->prev) e->prev->next = e->next;
+	else _head = e->next;
+	if(e->next) e->next->prev = e->prev;
+	else _tail = e->prev;
+	e->prev = e->next = nil;
+}
+
+- (void)_pushFront:(TUIImageCacheEntry *)e
+{
+	e->prev = nil;
+	e->next = _head;
+	if(_head) _head->prev = e;
+	_head = e;
+	if(!_tail) _tail = e;
+}
+
+- (void)_remove:(TUIImageCacheEntry *)e
+{
+	id key = e->key; // keep alive across the removal below
+	[self _unlink:e];
+	_totalCost -= e->cost;
+	[_entries removeObjectForKey:key]; // releases e
+}
+
+- (void)_trimToCost:(NSUInteger)cost
+{
+	while(_totalCost > cost && _tail)
+		[self _remove:_tail];
+}
+
+/*
+ * Public
+ */
+
+- (id)objectForKey:(id<NSCopying>)key
+{
+	if(!key)
+		return nil;
+
+	id object = nil;
+	pthread_mutex_lock(&_lock);
+	TUIImageCacheEntry *e = [_entries objectForKey:key];
+	if(e) {
+		if(e != _head) {
+			[self _unlink:e];
+			[self _pushFront:e];
+		}
+		object = e->object;
+		_hitCount++;
+	} else {
+		_missCount++;
+	}
+	pthread_mutex_unlock(&_lock);
+	return object;
+}
+
+- (void)setObject:(id)object forKey:(id<NSCopying>)key cost:(NSUInteger)cost
+{
+	if(!key)
+		return;
+	if(!object) {
+		[self removeImageForKey:key];
+		return;
+	}
+
+	TUIImageCacheEntry *e = [[TUIImageCacheEntry alloc] init];
+	e->key = [(id)key copy];
+	e->object = object;
+	e->cost = cost;
+
+	pthread_mutex_lock(&_lock);
+	TUIImageCacheEntry *old = [_entries objectForKey:e->key];
+	if(old)
+		[self _remove:old];
+	if(cost <= _totalCostLimit) { // an entry bigger than the whole budget would just flush everything else
+		[_entries setObject:e forKey:e->key];
+		[self _pushFront:e];
+		_totalCost += cost;
+		[self _trimToCost:_totalCostLimit];
+	}
+	pthread_mutex_unlock(&_lock);
+}
+
+- (TUIImage *)imageForKey:(id<NSCopying>)key
+{
+	return [self objectForKey:key];
+}
+
+- (void)setImage:(TUIImage *)image forKey:(id<NSCopying>)key
+{
+	[self setImage:image forKey:key cost:TUIImageDecodedByteCount(image)];
+}
+
+- (void)setImage:(TUIImage *)image forKey:(id<NSCopying>)key cost:(NSUInteger)cost
+{
+	[self setObject:image forKey:key cost:cost];
+}
+
+- (void)removeImageForKey:(id<NSCopying>)key
+{
+	if(!key)
+		return;
+
+	pthread_mutex_lock(&_lock);
+	TUIImageCacheEntry *e = [_entries objectForKey:key];
+	if(e)
+		[self _remove:e];
+	pthread_mutex_unlock(&_lock);
+}
+
+- (void)removeAllImages
+{
+	pthread_mutex_lock(&_lock);
+	_head = _tail = nil;
+	_totalCost = 0;
+	[_entries removeAllObjects];
+	pthread_mutex_unlock(&_lock);
+}
+
+- (void)trimToCost:(NSUInteger)cost
+{
+	pthread_mutex_lock(&_lock);
+	[self _trimToCost:cost];
+	pthread_mutex_unlock(&_lock);
+}
+
+- (void)trimForMemoryPressure
+{
+	[self trimToCost:self.totalCostLimit / 2];
+}
+
+- (NSUInteger)totalCostLimit
+{
+	pthread_mutex_lock(&_lock);
+	NSUInteger l = _totalCostLimit;
+	pthread_mutex_unlock(&_lock);
+	return l;
+}
+
+- (void)setTotalCostLimit:(NSUInteger)limit
+{
+	pthread_mutex_lock(&_lock);
+	_totalCostLimit = limit;
+	[self _trimToCost:limit];
+	pthread_mutex_unlock(&_lock);
+}
+
+- (NSUInteger)totalCost
+{
+	pthread_mutex_lock(&_lock);
+	NSUInteger c = _totalCost;
+	pthread_mutex_unlock(&_lock);
+	return c;
+}
+
+- (NSUInteger)count
+{
+	pthread_mutex_lock(&_lock);
+	NSUInteger c = [_entries count];
+	pthread_mutex_unlock(&_lock);
+	return c;
+}
+
+- (NSUInteger)hitCount
+{
+	pthread_mutex_lock(&_lock);
+	NSUInteger c = _hitCount;
+	pthread_mutex_unlock(&_lock);
+	return c;
+}
+
+- (NSUInteger)missCount
+{
+	pthread_mutex_lock(&_lock);
+	NSUInteger c = _missCount;
+	pthread_mutex_unlock(&_lock);
+	return c;
+}
+
+- (void)resetStatistics
+{
+	pthread_mutex_lock(&_lock);
+	_hitCount = _missCount = 0;
+	pthread_mutex_unlock(&_lock);
+}
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"<%@: %p; %lu images, %lu/%lu bytes, %lu hits, %lu misses>", [self class], self, (unsigned long)self.count, (unsigned long)self.totalCost, (unsigned long)self.totalCostLimit, (unsigned long)self.hitCount, (unsigned long)self.missCount];
+}
+
+@end
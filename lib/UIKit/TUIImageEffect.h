@@ -0,0 +1,80 @@
+/*
+ Copyright 2011 Twitter, Inc.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class TUIImage;
+@class TUIColor;
+@class TUIImageCache;
+
+/**
+ Lazy description of a chain of TUIImage (Drawing) operations on a source image.
+ 
+ Effects are immutable, each operation returns a new effect. The source key,
+ the operations with their parameters and the scale make up -cacheKey, so
+ rendering the same chain on the same source twice does the work once:
+ 
+	TUIImageEffect *e = [[[TUIImageEffect effectWithImage:avatar key:userID] roundImage:4] innerShadowWithOffset:CGSizeMake(0, -1) radius:2 color:shadowColor backgroundColor:bgColor];
+	[e renderWithCompletion:^(TUIImage *image) { imageView.image = image; }];
+ 
+ Geometry parameters are in points and are multiplied by 'scale' when rendering.
+ */
+@interface TUIImageEffect : NSObject
+
+/**
+ 'key' identifies the source image's pixels (e.g. a URL). If nil, results aren't cached.
+ */
++ (TUIImageEffect *)effectWithImage:(TUIImage *)image key:(NSString *)key;
+
+/**
+ Shared by all effects. Default budget is 16MB.
+ */
++ (TUIImageCache *)cache;
+
+@property (nonatomic, readonly) TUIImage *sourceImage;
+@property (nonatomic, readonly) NSString *sourceKey;
+@property (nonatomic, readonly) CGFloat scale;
+@property (nonatomic, readonly) NSString *cacheKey; // nil if sourceKey is nil
+
+- (TUIImageEffect *)effectWithScale:(CGFloat)scale; // default 1.0
+
+- (TUIImageEffect *)crop:(CGRect)cropRect;
+- (TUIImageEffect *)scale:(CGSize)size;
+- (TUIImageEffect *)thumbnail:(CGSize)size;
+- (TUIImageEffect *)pad:(CGFloat)padding;
+- (TUIImageEffect *)roundImage:(CGFloat)radius;
+- (TUIImageEffect *)invertedMask;
+- (TUIImageEffect *)embossMaskWithOffset:(CGSize)offset;
+- (TUIImageEffect *)innerShadowWithOffset:(CGSize)offset radius:(CGFloat)radius color:(TUIColor *)color backgroundColor:(TUIColor *)backgroundColor;
+
+/**
+ Returns nil unless the result is already in the cache. Thread safe, cheap enough for -drawRect:.
+ */
+- (TUIImage *)cachedImage;
+
+/**
+ Render synchronously on the calling thread (or return the cached result). Thread safe.
+ */
+- (TUIImage *)render;
+
+/**
+ Render on a background queue, 'completion' is called on the main queue.
+ Concurrent requests for the same cacheKey share one render. If the result
+ is already cached 'completion' is still called asynchronously.
+ */
+- (void)renderWithCompletion:(void(^)(TUIImage *image))completion;
+
+@end
@@ -0,0 +1,254 @@
+/*
+ Copyright 2011 Twitter, Inc.
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIImageEffect.h"
+#import "TUIKit.h"
+#import "TUIImage+Private.h"
+
+typedef TUIImage *(^TUIImageEffectApply)(TUIImage *image, CGFloat scale);
+
+@interface TUIImageEffectOperation : NSObject
+@property (nonatomic, copy) NSString *key;
+@property (nonatomic, copy) TUIImageEffectApply apply;
+@end
+
+@implementation TUIImageEffectOperation
+@synthesize key;
+@synthesize apply;
+@end
+
+// the same components mean different colours in different spaces of one model, e.g. sRGB and Display P3
+static NSString *TUIColorSpaceKey(CGColorSpaceRef space)
+{
+	CFStringRef name = CGColorSpaceCopyName(space);
+	if(name) {
+		NSString *key = [NSString stringWithString:(__bridge NSString *)name];
+		CFRelease(name);
+		return key;
+	}
+	CFDataRef icc = CGColorSpaceCopyICCProfile(space);
+	if(icc) {
+		NSString *key = [NSString stringWithFormat:@"icc%lx.%ld", (unsigned long)CFHash(icc), (long)CFDataGetLength(icc)];
+		CFRelease(icc);
+		return key;
+	}
+	return [NSString stringWithFormat:@"model%d", (int)CGColorSpaceGetModel(space)]; // device spaces
+}
+
+static NSString *TUIColorKey(TUIColor *color)
+{
+	CGColorRef c = color.CGColor;
+	if(!c)
+		return @"nil";
+	size_t n = CGColorGetNumberOfComponents(c);
+	const CGFloat *components = CGColorGetComponents(c);
+	NSMutableString *s = [NSMutableString stringWithString:TUIColorSpaceKey(CGColorGetColorSpace(c))];
+	for(size_t i = 0; i < n; ++i)
+		[s appendFormat:@":%.4f", components[i]];
+	return s;
+}
+
+static CGSize TUISizeScale(CGSize s, CGFloat scale)
+{
+	return CGSizeMake(s.width * scale, s.height * scale);
+}
+
+@interface TUIImageEffect ()
+{
+	TUIImage *_sourceImage;
+	NSString *_sourceKey;
+	CGFloat _scale;
+	NSArray *_operations;
+	NSString *_cacheKey; // set once when the effect is made, effects are immutable
+}
+- (TUIImageEffect *)_effectWithScale:(CGFloat)scale operations:(NSArray *)operations;
+@end
+
+@implementation TUIImageEffect
+
+@synthesize sourceImage = _sourceImage;
+@synthesize sourceKey = _sourceKey;
+@synthesize scale = _scale;
+@synthesize cacheKey = _cacheKey;
+
++ (TUIImageCache *)cache
+{
+	static TUIImageCache *cache = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		cache = [[TUIImageCache alloc] initWithTotalCostLimit:16 * 1024 * 1024];
+		// results were rendered in the old colour space, like +[TUIImageCache sharedCache]
+		[[NSNotificationCenter defaultCenter] addObserver:cache selector:@selector(removeAllImages) name:TUIBackingColorSpaceDidChangeNotification object:nil];
+	});
+	return cache;
+}
+
++ (TUIImageEffect *)effectWithImage:(TUIImage *)image key:(NSString *)key
+{
+	TUIImageEffect *e = [[self alloc] init];
+	e->_sourceImage = image;
+	e->_sourceKey = [key copy];
+	return [e _effectWithScale:1.0 operations:[NSArray array]];
+}
+
+- (TUIImageEffect *)_effectWithScale:(CGFloat)scale operations:(NSArray *)operations
+{
+	TUIImageEffect *e = [[[self class] alloc] init];
+	e->_sourceImage = _sourceImage;
+	e->_sourceKey = _sourceKey;
+	e->_scale = scale;
+	e->_operations = operations;
+	if(_sourceKey) {
+		NSMutableString *s = [NSMutableString stringWithFormat:@"%@@%.2f", _sourceKey, scale];
+		for(TUIImageEffectOperation *o in operations)
+			[s appendFormat:@"|%@", o.key];
+		e->_cacheKey = [s copy];
+	}
+	return e;
+}
+
+- (TUIImageEffect *)_effectByAddingOperationWithKey:(NSString *)key apply:(TUIImageEffectApply)apply
+{
+	TUIImageEffectOperation *o = [[TUIImageEffectOperation alloc] init];
+	o.key = key;
+	o.apply = apply;
+	return [self _effectWithScale:_scale operations:[_operations arrayByAddingObject:o]];
+}
+
+- (TUIImageEffect *)effectWithScale:(CGFloat)scale
+{
+	return [self _effectWithScale:scale operations:_operations];
+}
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"<%@: %p; %@>", [self class], self, self.cacheKey];
+}
+
+/*
+ * Operations
+ */
+
+- (TUIImageEffect *)crop:(CGRect)cropRect
+{
+	return [self _effectByAddingOperationWithKey:[NSString stringWithFormat:@"crop(%@)", NSStringFromRect(cropRect)] apply:^(TUIImage *i, CGFloat scale) {
+		return [i crop:CGRectMake(cropRect.origin.x * scale, cropRect.origin.y * scale, cropRect.size.width * scale, cropRect.size.height * scale)];
+	}];
+}
+
+- (TUIImageEffect *)scale:(CGSize)size
+{
+	return [self _effectByAddingOperationWithKey:[NSString stringWithFormat:@"scale(%@)", NSStringFromSize(size)] apply:^(TUIImage *i, CGFloat scale) {
+		return [i scale:TUISizeScale(size, scale)];
+	}];
+}
+
+- (TUIImageEffect *)thumbnail:(CGSize)size
+{
+	return [self _effectByAddingOperationWithKey:[NSString stringWithFormat:@"thumbnail(%@)", NSStringFromSize(size)] apply:^(TUIImage *i, CGFloat scale) {
+		return [i thumbnail:TUISizeScale(size, scale)];
+	}];
+}
+
+- (TUIImageEffect *)pad:(CGFloat)padding
+{
+	return [self _effectByAddingOperationWithKey:[NSString stringWithFormat:@"pad(%g)", padding] apply:^(TUIImage *i, CGFloat scale) {
+		return [i pad:padding * scale];
+	}];
+}
+
+- (TUIImageEffect *)roundImage:(CGFloat)radius
+{
+	return [self _effectByAddingOperationWithKey:[NSString stringWithFormat:@"round(%g)", radius] apply:^(TUIImage *i, CGFloat scale) {
+		return [i roundImage:radius * scale];
+	}];
+}
+
+- (TUIImageEffect *)invertedMask
+{
+	return [self _effectByAddingOperationWithKey:@"invert" apply:^(TUIImage *i, CGFloat scale) {
+		return [i invertedMask];
+	}];
+}
+
+- (TUIImageEffect *)embossMaskWithOffset:(CGSize)offset
+{
+	return [self _effectByAddingOperationWithKey:[NSString stringWithFormat:@"emboss(%@)", NSStringFromSize(offset)] apply:^(TUIImage *i, CGFloat scale) {
+		return [i embossMaskWithOffset:TUISizeScale(offset, scale)];
+	}];
+}
+
+- (TUIImageEffect *)innerShadowWithOffset:(CGSize)offset radius:(CGFloat)radius color:(TUIColor *)color backgroundColor:(TUIColor *)backgroundColor
+{
+	NSString *key = [NSString stringWithFormat:@"innerShadow(%@,%g,%@,%@)", NSStringFromSize(offset), radius, TUIColorKey(color), TUIColorKey(backgroundColor)];
+	return [self _effectByAddingOperationWithKey:key apply:^(TUIImage *i, CGFloat scale) {
+		return [i innerShadowWithOffset:TUISizeScale(offset, scale) radius:radius * scale color:color backgroundColor:backgroundColor];
+	}];
+}
+
+/*
+ * Rendering
+ */
+
+- (TUIImage *)cachedImage
+{
+	if([_operations count] == 0)
+		return _sourceImage;
+	return [[[self class] cache] imageForKey:self.cacheKey];
+}
+
+- (TUIImage *)_render
+{
+	TUIImage *image = _sourceImage;
+	for(TUIImageEffectOperation *o in _operations) {
+		image = o.apply(image, _scale);
+		if(!image)
+			break;
+	}
+	return image;
+}
+
+- (TUIImage *)render
+{
+	TUIImage *image = [self cachedImage];
+	if(image)
+		return image;
+	
+	image = [self _render];
+	if(image && self.cacheKey)
+		[[[self class] cache] setImage:image forKey:self.cacheKey];
+	return image;
+}
+
+- (void)renderWithCompletion:(void(^)(TUIImage *image))completion
+{
+	if([_operations count] == 0) {
+		TUIImage *image = _sourceImage;
+		if(completion) {
+			completion = [completion copy];
+			dispatch_async(dispatch_get_main_queue(), ^{
+				completion(image);
+			});
+		}
+		return;
+	}
+	
+	TUIImageProduceAsync([[self class] cache], _cacheKey, ^{
+		return [self _render];
+	}, completion);
+}
+
+@end
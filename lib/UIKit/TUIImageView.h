@@ -15,16 +15,42 @@
  */
 
 #import "TUIView.h"
+#import "TUIFrameClock.h"
 
 @class TUIImage;
 
-@interface TUIImageView : TUIView
+/**
+ With the default content mode (or either aspect mode), the image is set as
+ the layer's contents directly instead of being drawn into a backing store.
+ 
+ A TUIAnimatedImage plays while the view is in a window and not hidden, and
+ stops (along with its decoding) otherwise.
+ */
+@interface TUIImageView : TUIView <TUIFrameClockObserver>
 {
 	TUIImage *_image;
+	BOOL _usesLayerContentsCenter;
+	
+	BOOL _animating;
+	BOOL _animationFinished;
+	NSTimeInterval _animationStart;
+	NSTimeInterval _animationElapsed; // playback position while stopped
+	NSUInteger _animationFrame;
+	TUIImage *_animationFrameImage; // currently shown frame of an animated image
 }
 
 - (id)initWithImage:(TUIImage *)image;
 
 @property(nonatomic,strong) TUIImage *image;
 
+/**
+ If YES, stretchable images are published as the layer's contents with
+ contentsCenter set from the caps, and Core Animation does the stretching.
+ Caps are then shown at (image pixels / contentsScale) points, so use images
+ whose pixel size matches the display scale. Default is NO (draw the image).
+ */
+@property(nonatomic,assign) BOOL usesLayerContentsCenter;
+
+@property(nonatomic,readonly,getter=isAnimating) BOOL animating;
+
 @end
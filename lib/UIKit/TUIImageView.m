@@ -17,6 +17,8 @@
 #import "TUIKit.h"
 #import "TUIImageView.h"
 #import "TUIImage.h"
+#import "TUIAnimatedImage.h"
+#import "TUIView+Private.h"
 
 @implementation TUIImageView
 
@@ -30,6 +32,11 @@
 	return self;
 }
 
+- (void)dealloc
+{
+	if(_animating)
+		[[TUIFrameClock sharedClock] removeObserver:self];
+}
 
 - (TUIImage *)image
 {
@@ -38,17 +45,180 @@
 
 - (void)setImage:(TUIImage *)i
 {
+	if(i != _image) {
+		_animationStart = [NSDate timeIntervalSinceReferenceDate];
+		_animationElapsed = 0.0;
+		_animationFrame = 0;
+		_animationFrameImage = nil;
+		_animationFinished = NO;
+	}
 	_image = i;
+	[self _updateAnimation];
+	[self setNeedsDisplay];
+}
+
+/*
+ * Animated images
+ */
+
+- (BOOL)isAnimating
+{
+	return _animating;
+}
+
+- (BOOL)_shouldAnimate
+{
+	if(![_image isKindOfClass:[TUIAnimatedImage class]] || !self.nsView.window || self.hidden)
+		return NO;
+	return !_animationFinished;
+}
+
+- (void)_updateAnimation
+{
+	BOOL animate = [self _shouldAnimate];
+	if(animate == _animating)
+		return;
+	
+	_animating = animate;
+	NSTimeInterval now = [NSDate timeIntervalSinceReferenceDate];
+	if(animate) {
+		// resume where we stopped rather than jumping ahead by the time spent off screen
+		_animationStart = now - _animationElapsed;
+		[[TUIFrameClock sharedClock] addObserver:self];
+	} else {
+		_animationElapsed = now - _animationStart;
+		[[TUIFrameClock sharedClock] removeObserver:self];
+	}
+}
+
+- (void)frameClockDidTick:(NSTimeInterval)timestamp
+{
+	TUIAnimatedImage *image = (TUIAnimatedImage *)_image;
+	NSTimeInterval elapsed = timestamp - _animationStart;
+	NSUInteger index;
+	if(image.loopCount != 0 && elapsed >= image.duration * image.loopCount) {
+		index = image.frameCount - 1; // hold the last frame
+		_animationFinished = YES;
+		[self _updateAnimation];
+	} else {
+		index = [image frameIndexForTime:elapsed];
+	}
+	
+	if(index == _animationFrame && _animationFrameImage)
+		return;
+	
+	TUIImage *frame = [image bufferedFrameAtIndex:index];
+	if(!frame)
+		return; // decoder is behind, keep showing the current frame
+	
+	_animationFrame = index;
+	_animationFrameImage = frame;
+	if([self _canSetLayerContentsDirectly])
+		self.layer.contents = (__bridge id)frame.CGImage; // no redraw, just swap the bitmap
+	else
+		[self setNeedsDisplay];
+}
+
+- (TUIImage *)_displayedImage
+{
+	return _animationFrameImage ? _animationFrameImage : _image;
+}
+
+- (void)didMoveToWindow
+{
+	[super didMoveToWindow];
+	[self _updateAnimation];
+}
+
+- (void)setHidden:(BOOL)h
+{
+	[super setHidden:h];
+	[self _updateAnimation];
+}
+
+- (BOOL)usesLayerContentsCenter
+{
+	return _usesLayerContentsCenter;
+}
+
+- (void)setUsesLayerContentsCenter:(BOOL)b
+{
+	_usesLayerContentsCenter = b;
 	[self setNeedsDisplay];
 }
 
+// unit rect of the stretched middle slice, matching TUIStretchableImage's caps
+- (CGRect)_contentsCenterForImage:(TUIImage *)image
+{
+	CGSize s = image.size;
+	CGFloat t = image.topCapHeight;
+	CGFloat l = image.leftCapWidth;
+	if(t*2 > s.height-1) t -= 1;
+	if(l*2 > s.width-1) l -= 1;
+	if(s.width < 1 || s.height < 1)
+		return CGRectMake(0, 0, 1, 1);
+	return CGRectMake(l / s.width, t / s.height, MAX(s.width - l*2, 0) / s.width, MAX(s.height - t*2, 0) / s.height);
+}
+
+/**
+ Plain images scaled into the bounds don't need a backing store, the layer can
+ show the CGImage itself. Anything that composites (stretchable images unless
+ usesLayerContentsCenter is set, a drawRect block or subclass drawing,
+ gravities that depend on contentsScale) goes through the normal -drawRect: path.
+ */
+- (BOOL)_canSetLayerContentsDirectly
+{
+	if(!_image.CGImage || self.drawRect)
+		return NO;
+	if((_image.leftCapWidth != 0 || _image.topCapHeight != 0) && !_usesLayerContentsCenter)
+		return NO;
+	if([self methodForSelector:@selector(drawRect:)] != [TUIImageView instanceMethodForSelector:@selector(drawRect:)])
+		return NO;
+	
+	NSString *gravity = self.layer.contentsGravity;
+	return [gravity isEqualToString:kCAGravityResize] || [gravity isEqualToString:kCAGravityResizeAspect] || [gravity isEqualToString:kCAGravityResizeAspectFill];
+}
+
+- (void)displayLayer:(CALayer *)layer
+{
+	if(![self _canSetLayerContentsDirectly]) {
+		layer.needsDisplayOnBoundsChange = YES;
+		layer.contentsCenter = CGRectMake(0, 0, 1, 1);
+		[super displayLayer:layer];
+		return;
+	}
+	
+	[self _willDisplayLayer];
+	
+	// drop the backing store from a previous drawn display, the layer shows the image's own pixels
+	if(_context.context) {
+		CGContextRelease(_context.context);
+		_context.context = NULL;
+	}
+	
+	layer.needsDisplayOnBoundsChange = NO; // Core Animation scales the contents
+	if(_image.leftCapWidth != 0 || _image.topCapHeight != 0)
+		layer.contentsCenter = [self _contentsCenterForImage:_image];
+	else
+		layer.contentsCenter = CGRectMake(0, 0, 1, 1);
+	[self _setLayerContentsWithoutDrawing:(__bridge id)[self _displayedImage].CGImage];
+	
+	[self _didDisplayLayer];
+}
+
+- (void)setContentMode:(TUIViewContentMode)contentMode
+{
+	[super setContentMode:contentMode];
+	[self setNeedsDisplay]; // may switch between direct contents and drawing
+}
+
 - (void)drawRect:(CGRect)rect
 {
 	[super drawRect:rect];
 	if (_image == nil)
 		return;
     
-    [_image drawInRect:rect];
+    [[self _displayedImage] drawInRect:rect];
 }
 
 @end
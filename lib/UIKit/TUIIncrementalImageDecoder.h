@@ -0,0 +1,49 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class TUIImage;
+
+typedef void(^TUIIncrementalImageHandler)(TUIImage *image, BOOL finished);
+
+/**
+ Builds an image from data as it arrives (e.g. from a network connection).
+ Progressive JPEGs and interlaced PNGs/GIFs refine in passes, everything
+ else fills in top down.
+ 
+ Appending is cheap; decoding happens on a private serial queue at most once
+ per minimumUpdateInterval, and each update is a display ready bitmap (see
+ -[TUIImage decodedImage]) so it can be set on a view without further work.
+ */
+@interface TUIIncrementalImageDecoder : NSObject
+
+/**
+ Called on the decoder's queue (not the main thread) with each refinement,
+ and once with finished = YES after -finish (image is nil if the data turned
+ out not to be an image). Set before appending data.
+ */
+@property (nonatomic, copy) TUIIncrementalImageHandler updateHandler;
+
+@property (nonatomic, assign) NSTimeInterval minimumUpdateInterval; // default 0.1s
+
+@property (nonatomic, readonly) TUIImage *currentImage; // latest update, thread safe
+
+- (void)appendData:(NSData *)data; // thread safe
+- (void)finish; // no more data, decodes the final image right away
+- (void)cancel; // stop decoding, no further updates are delivered
+
+@end
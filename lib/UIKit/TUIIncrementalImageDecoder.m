@@ -0,0 +1,150 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIIncrementalImageDecoder.h"
+#import "TUIImage.h"
+
+#define TUIIncrementalImageDefaultUpdateInterval 0.1
+
+@interface TUIIncrementalImageDecoder ()
+{
+	dispatch_queue_t _queue;
+	
+	// only touched on _queue
+	CGImageSourceRef _source;
+	NSMutableData *_data;
+	NSUInteger _decodedLength;
+	NSTimeInterval _lastUpdate;
+	BOOL _updateScheduled;
+	BOOL _finished;
+	BOOL _done;
+	
+	TUIImage *_currentImage; // @synchronized(self)
+}
+- (void)_update;
+@end
+
+@implementation TUIIncrementalImageDecoder
+
+@synthesize updateHandler;
+@synthesize minimumUpdateInterval;
+
+- (id)init
+{
+	if((self = [super init])) {
+		_queue = dispatch_queue_create("com.twitter.TUIIncrementalImageDecoder", NULL);
+		dispatch_set_target_queue(_queue, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0));
+		_source = CGImageSourceCreateIncremental(NULL);
+		_data = [[NSMutableData alloc] init];
+		minimumUpdateInterval = TUIIncrementalImageDefaultUpdateInterval;
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	if(_source)
+		CFRelease(_source);
+	dispatch_release(_queue);
+}
+
+- (TUIImage *)currentImage
+{
+	@synchronized(self) {
+		return _currentImage;
+	}
+}
+
+- (void)appendData:(NSData *)data
+{
+	if([data length] == 0)
+		return;
+	
+	data = [data copy]; // caller may reuse a mutable buffer
+	dispatch_async(_queue, ^{
+		if(_done)
+			return;
+		[_data appendData:data];
+		
+		if(_updateScheduled)
+			return;
+		_updateScheduled = YES;
+		NSTimeInterval wait = _lastUpdate + self.minimumUpdateInterval - [NSDate timeIntervalSinceReferenceDate];
+		dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(MAX(wait, 0.0) * NSEC_PER_SEC)), _queue, ^{
+			_updateScheduled = NO;
+			[self _update];
+		});
+	});
+}
+
+- (void)finish
+{
+	dispatch_async(_queue, ^{
+		_finished = YES;
+		[self _update];
+	});
+}
+
+- (void)cancel
+{
+	dispatch_async(_queue, ^{
+		_done = YES;
+		_data = nil;
+	});
+}
+
+// on _queue
+- (void)_update
+{
+	if(_done || !_source)
+		return;
+	if(!_finished && [_data length] == _decodedLength)
+		return; // nothing new since the last pass
+	
+	_lastUpdate = [NSDate timeIntervalSinceReferenceDate];
+	_decodedLength = [_data length];
+	
+	// ImageIO wants everything received so far each time. Copying here rather than on every
+	// append keeps the cost proportional to the number of (throttled) updates.
+	NSData *snapshot = [_data copy];
+	CGImageSourceUpdateData(_source, (__bridge CFDataRef)snapshot, _finished);
+	
+	TUIImage *image = nil;
+	CGImageSourceStatus status = CGImageSourceGetStatusAtIndex(_source, 0);
+	if(status == kCGImageStatusIncomplete || status == kCGImageStatusComplete) {
+		CGImageRef cgImage = CGImageSourceCreateImageAtIndex(_source, 0, NULL);
+		if(cgImage) {
+			image = [[TUIImage imageWithCGImage:cgImage] decodedImage]; // the partial bitmap, with rows not yet received left blank
+			CGImageRelease(cgImage);
+		}
+	}
+	
+	if(_finished) {
+		_done = YES;
+		_data = nil;
+	} else if(!image) {
+		return; // header not in yet
+	}
+	
+	@synchronized(self) {
+		_currentImage = image;
+	}
+	TUIIncrementalImageHandler handler = self.updateHandler;
+	if(handler)
+		handler(image, _finished);
+}
+
+@end
@@ -0,0 +1,95 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Cocoa/Cocoa.h>
+
+/**
+ Distribution of latencies in log spaced buckets (about 9% wide), from 10us
+ to a minute. Percentiles are accurate to a bucket, min/max/mean are exact.
+ */
+@interface TUILatencyHistogram : NSObject <NSCopying>
+
+@property (nonatomic, readonly) NSUInteger count;
+@property (nonatomic, readonly) NSTimeInterval minimum;
+@property (nonatomic, readonly) NSTimeInterval maximum;
+@property (nonatomic, readonly) NSTimeInterval mean;
+
+- (void)addValue:(NSTimeInterval)seconds;
+- (void)reset;
+
+/**
+ @param percentile 0 - 100
+ @returns the smallest latency at least 'percentile' percent of samples are under, 0 if empty
+ */
+- (NSTimeInterval)valueAtPercentile:(double)percentile;
+
+@end
+
+/**
+ Measures how long it takes for input to show up on screen.
+ 
+ Each event TUINSView handles is tagged with its timestamp. If handling it
+ invalidates anything (-setNeedsDisplay, -setNeedsLayout, a scroll view
+ offset change), the event is held until the next Core Animation commit on
+ the main run loop, and the time from the event to that commit is added to
+ the histogram for its type. Events that don't change anything aren't
+ counted. Coalesced mouse events are measured from the oldest event merged.
+ 
+ Off by default; set enabled, or launch with TUIInputLatencyTracking=1 in
+ the environment.
+ */
+@interface TUIInputLatencyTracker : NSObject
+
++ (TUIInputLatencyTracker *)sharedTracker;
+
+@property (nonatomic, assign, getter=isEnabled) BOOL enabled;
+
+- (TUILatencyHistogram *)histogramForEventType:(NSEventType)type; // copy, nil if nothing was measured
+- (NSDictionary *)histograms; // NSNumber (NSEventType) -> TUILatencyHistogram copies
+- (void)reset;
+
+/**
+ Ends the frame for every event waiting on one. Called automatically after
+ each run loop commit; callers that commit with +[CATransaction flush]
+ outside the run loop (e.g. TUIEventReplayer) call it themselves, passing
+ a time on the same clock as event timestamps.
+ */
+- (void)noteCommitAtTime:(NSTimeInterval)timestamp;
+
+@end
+
+/*
+ Hooks called by TUIKit; TUIInputLatencyTracking mirrors the tracker's enabled flag.
+ */
+extern BOOL TUIInputLatencyTracking;
+extern void _TUIInputLatencyBeginEvent(NSEventType type, NSTimeInterval timestamp);
+extern void _TUIInputLatencyEndEvent(void);
+extern void _TUIInputLatencyNoteInvalidation(void);
+
+static inline void TUIInputLatencyBeginEvent(NSEvent *event)
+{
+	if(TUIInputLatencyTracking) _TUIInputLatencyBeginEvent([event type], [event timestamp]);
+}
+
+static inline void TUIInputLatencyEndEvent(void)
+{
+	if(TUIInputLatencyTracking) _TUIInputLatencyEndEvent();
+}
+
+static inline void TUIInputLatencyNoteInvalidation(void)
+{
+	if(TUIInputLatencyTracking) _TUIInputLatencyNoteInvalidation();
+}
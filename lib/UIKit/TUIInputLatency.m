@@ -0,0 +1,285 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIInputLatency.h"
+#import "TUIKit.h"
+#include <math.h>
+#include <pthread.h>
+
+#define TUILatencyHistogramMinimum 0.00001 // 10us
+#define TUILatencyHistogramBucketsPerDoubling 8
+#define TUILatencyHistogramBucketCount 192 // 24 doublings, up to ~168s
+#define TUIInputLatencyMaxEventDepth 8
+
+// after Core Animation's commit observer (2000000)
+#define TUIInputLatencyObserverOrder 2000001
+
+BOOL TUIInputLatencyTracking = NO;
+
+static NSUInteger TUILatencyBucketForValue(NSTimeInterval v)
+{
+	if(v <= TUILatencyHistogramMinimum)
+		return 0;
+	double b = floor(log2(v / TUILatencyHistogramMinimum) * TUILatencyHistogramBucketsPerDoubling);
+	return (NSUInteger)MIN(b, TUILatencyHistogramBucketCount - 1);
+}
+
+static NSTimeInterval TUILatencyUpperBoundOfBucket(NSUInteger b)
+{
+	return TUILatencyHistogramMinimum * exp2((double)(b + 1) / TUILatencyHistogramBucketsPerDoubling);
+}
+
+@interface TUILatencyHistogram ()
+{
+	@public
+	NSUInteger _buckets[TUILatencyHistogramBucketCount];
+	NSUInteger _count;
+	NSTimeInterval _minimum;
+	NSTimeInterval _maximum;
+	NSTimeInterval _total;
+}
+@end
+
+@implementation TUILatencyHistogram
+
+- (id)copyWithZone:(NSZone *)zone
+{
+	TUILatencyHistogram *h = [[[self class] allocWithZone:zone] init];
+	memcpy(h->_buckets, _buckets, sizeof(_buckets));
+	h->_count = _count;
+	h->_minimum = _minimum;
+	h->_maximum = _maximum;
+	h->_total = _total;
+	return h;
+}
+
+- (NSUInteger)count
+{
+	return _count;
+}
+
+- (NSTimeInterval)minimum
+{
+	return _minimum;
+}
+
+- (NSTimeInterval)maximum
+{
+	return _maximum;
+}
+
+- (NSTimeInterval)mean
+{
+	return _count ? _total / _count : 0.0;
+}
+
+- (void)addValue:(NSTimeInterval)seconds
+{
+	seconds = MAX(seconds, 0.0);
+	_buckets[TUILatencyBucketForValue(seconds)]++;
+	_minimum = _count ? MIN(_minimum, seconds) : seconds;
+	_maximum = _count ? MAX(_maximum, seconds) : seconds;
+	_total += seconds;
+	_count++;
+}
+
+- (void)reset
+{
+	memset(_buckets, 0, sizeof(_buckets));
+	_count = 0;
+	_minimum = _maximum = _total = 0.0;
+}
+
+- (NSTimeInterval)valueAtPercentile:(double)percentile
+{
+	if(!_count)
+		return 0.0;
+	
+	NSUInteger rank = (NSUInteger)ceil(MAX(0.0, MIN(percentile, 100.0)) / 100.0 * _count);
+	if(rank < 1)
+		rank = 1;
+	NSUInteger seen = 0;
+	for(NSUInteger b = 0; b < TUILatencyHistogramBucketCount; ++b) {
+		seen += _buckets[b];
+		if(seen >= rank)
+			return MAX(_minimum, MIN(TUILatencyUpperBoundOfBucket(b), _maximum));
+	}
+	return _maximum;
+}
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"<%@: %p; %lu samples, p50 %.1fms, p90 %.1fms, p99 %.1fms, max %.1fms>", [self class], self, (unsigned long)_count, [self valueAtPercentile:50] * 1000.0, [self valueAtPercentile:90] * 1000.0, [self valueAtPercentile:99] * 1000.0, _maximum * 1000.0];
+}
+
+@end
+
+typedef struct {
+	NSEventType type;
+	NSTimeInterval timestamp;
+	BOOL invalidated;
+} TUIInputLatencyEvent;
+
+@interface TUIInputLatencyTracker ()
+{
+	TUIInputLatencyEvent _eventStack[TUIInputLatencyMaxEventDepth];
+	NSUInteger _eventDepth;
+	NSMutableData *_waiting; // TUIInputLatencyEvent, invalidated something, waiting for a commit
+	NSMutableDictionary *_histograms;
+	CFRunLoopObserverRef _observer;
+}
+- (void)_beginEvent:(NSEventType)type timestamp:(NSTimeInterval)timestamp;
+- (void)_endEvent;
+- (void)_noteInvalidation;
+@end
+
+static void TUIInputLatencyRunLoopObserver(CFRunLoopObserverRef observer, CFRunLoopActivity activity, void *info)
+{
+	TUIInputLatencyTracker *tracker = (__bridge TUIInputLatencyTracker *)info;
+	[tracker noteCommitAtTime:[[NSProcessInfo processInfo] systemUptime]];
+}
+
+void _TUIInputLatencyBeginEvent(NSEventType type, NSTimeInterval timestamp)
+{
+	[[TUIInputLatencyTracker sharedTracker] _beginEvent:type timestamp:timestamp];
+}
+
+void _TUIInputLatencyEndEvent(void)
+{
+	[[TUIInputLatencyTracker sharedTracker] _endEvent];
+}
+
+void _TUIInputLatencyNoteInvalidation(void)
+{
+	if(!pthread_main_np())
+		return;
+	[[TUIInputLatencyTracker sharedTracker] _noteInvalidation];
+}
+
+@implementation TUIInputLatencyTracker
+
++ (TUIInputLatencyTracker *)sharedTracker
+{
+	static TUIInputLatencyTracker *sharedTracker = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		sharedTracker = [[TUIInputLatencyTracker alloc] init];
+	});
+	return sharedTracker;
+}
+
++ (void)load
+{
+	if(TUIEnvironmentFlag(@"TUIInputLatencyTracking"))
+		[[self sharedTracker] setEnabled:YES];
+}
+
+- (id)init
+{
+	if((self = [super init])) {
+		_waiting = [[NSMutableData alloc] init];
+		_histograms = [[NSMutableDictionary alloc] init];
+	}
+	return self;
+}
+
+- (BOOL)isEnabled
+{
+	return _observer != NULL;
+}
+
+- (void)setEnabled:(BOOL)e
+{
+	if(e == self.enabled)
+		return;
+	
+	if(e) {
+		CFRunLoopObserverContext context = {0, (__bridge void *)self, NULL, NULL, NULL}; // the shared tracker is never released
+		_observer = CFRunLoopObserverCreate(NULL, kCFRunLoopBeforeWaiting | kCFRunLoopExit, true, TUIInputLatencyObserverOrder, TUIInputLatencyRunLoopObserver, &context);
+		CFRunLoopAddObserver(CFRunLoopGetMain(), _observer, kCFRunLoopCommonModes);
+	} else {
+		CFRunLoopObserverInvalidate(_observer);
+		CFRelease(_observer);
+		_observer = NULL;
+		_eventDepth = 0;
+		[_waiting setLength:0];
+	}
+	TUIInputLatencyTracking = e;
+}
+
+- (void)_beginEvent:(NSEventType)type timestamp:(NSTimeInterval)timestamp
+{
+	if(_eventDepth < TUIInputLatencyMaxEventDepth) {
+		TUIInputLatencyEvent event = {type, timestamp, NO};
+		_eventStack[_eventDepth] = event;
+	}
+	_eventDepth++;
+}
+
+- (void)_endEvent
+{
+	if(!_eventDepth)
+		return; // tracking was turned on mid-event
+	_eventDepth--;
+	if(_eventDepth < TUIInputLatencyMaxEventDepth && _eventStack[_eventDepth].invalidated)
+		[_waiting appendBytes:&_eventStack[_eventDepth] length:sizeof(TUIInputLatencyEvent)];
+}
+
+- (void)_noteInvalidation
+{
+	if(_eventDepth && _eventDepth <= TUIInputLatencyMaxEventDepth)
+		_eventStack[_eventDepth - 1].invalidated = YES;
+}
+
+- (void)noteCommitAtTime:(NSTimeInterval)timestamp
+{
+	NSUInteger n = [_waiting length] / sizeof(TUIInputLatencyEvent);
+	if(!n)
+		return;
+	
+	const TUIInputLatencyEvent *events = [_waiting bytes];
+	for(NSUInteger i = 0; i < n; ++i) {
+		NSNumber *key = [NSNumber numberWithUnsignedInteger:events[i].type];
+		TUILatencyHistogram *h = [_histograms objectForKey:key];
+		if(!h) {
+			h = [[TUILatencyHistogram alloc] init];
+			[_histograms setObject:h forKey:key];
+		}
+		[h addValue:timestamp - events[i].timestamp];
+	}
+	[_waiting setLength:0];
+}
+
+- (TUILatencyHistogram *)histogramForEventType:(NSEventType)type
+{
+	return [[_histograms objectForKey:[NSNumber numberWithUnsignedInteger:type]] copy];
+}
+
+- (NSDictionary *)histograms
+{
+	NSMutableDictionary *d = [NSMutableDictionary dictionaryWithCapacity:[_histograms count]];
+	for(NSNumber *key in _histograms)
+		[d setObject:[[_histograms objectForKey:key] copy] forKey:key];
+	return d;
+}
+
+- (void)reset
+{
+	[_histograms removeAllObjects];
+	[_waiting setLength:0];
+}
+
+@end
@@ -20,11 +20,26 @@
 #import "TUIFont.h"
 #import "TUIColor.h"
 #import "TUIImage.h"
+#import "TUIImageCache.h"
+#import "TUIImageEffect.h"
+#import "TUIAssetPack.h"
+#import "TUIAnimatedImage.h"
+#import "TUIFrameClock.h"
+#import "TUIEventTrace.h"
+#import "TUIEventRecorder.h"
+#import "TUIInputLatency.h"
+#import "TUIStallWatchdog.h"
+#import "TUIViewProfiler.h"
+#import "TUIDebugOverlay.h"
+#import "TUIIncrementalImageDecoder.h"
+#import "TUIDisplayList.h"
 #import "TUIView.h"
 #import "TUIScrollView.h"
 #import "TUIFastIndexPath.h"
 #import "TUITableView.h"
 #import "TUITableView+Additions.h"
+#import "TUITableView+Export.h"
+#import "TUITableView+Accessibility.h"
 #import "TUITableViewCell.h"
 #import "TUITableViewSectionHeader.h"
 #import "TUILabel.h"
@@ -39,6 +54,7 @@
 #import "TUIStringDrawing.h"
 #import "TUIViewController.h"
 #import "TUICGAdditions.h"
+#import "TUIShapeCache.h"
 #import "CoreText+Additions.h"
 #import "TUITextEditor.h"
 #import "TUIPopover.h"
@@ -67,3 +83,11 @@ extern TUIImage *TUIGraphicsDrawAsImage(CGSize size, void(^draw)(void));
 extern NSData *TUIGraphicsDrawAsPDF(CGRect *optionalMediaBox, void(^draw)(CGContextRef));
 
 extern BOOL AtLeastLion; // set at launch
+
+/**
+ Launch options read from the environment, e.g. TUIStallWatchdog=1.
+ TUIEnvironmentFlag is YES for values like 1 or YES and is safe in +load;
+ call TUIEnvironmentValue with an autorelease pool in place.
+ */
+extern BOOL TUIEnvironmentFlag(NSString *name);
+extern NSString *TUIEnvironmentValue(NSString *name); // nil if unset
@@ -103,3 +103,15 @@ NSData* TUIGraphicsDrawAsPDF(CGRect *optionalMediaBox, void(^draw)(CGContextRef)
 	CGDataConsumerRelease(dataConsumer);
 	return data;
 }
+
+NSString *TUIEnvironmentValue(NSString *name)
+{
+	return [[[NSProcessInfo processInfo] environment] objectForKey:name];
+}
+
+BOOL TUIEnvironmentFlag(NSString *name)
+{
+	@autoreleasepool {
+		return [TUIEnvironmentValue(name) boolValue];
+	}
+}
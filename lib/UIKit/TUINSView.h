@@ -20,7 +20,7 @@
 /**
  TUINSView is the bridge that hosts a TUIView-based interface heirarchy. You may add it as the contentView of your window if you want to build a pure TwUI-based UI, or you can use it for a small part.
  */
-@interface TUINSView : NSView <NSTextInputClient>
+@interface TUINSView : NSView <NSTextInputClient, TUIFrameClockObserver>
 {
 	TUIView *rootView;
 	TUIView *_hoverView;
@@ -39,6 +39,19 @@
 	BOOL inLiveResize;
 	
 	BOOL opaque;
+	
+	BOOL coalescesMouseEvents;
+	BOOL _coalescingFrame; // observing the frame clock
+	NSEvent *_pendingMouseEvent;
+	NSMutableArray *_pendingMouseEvents;
+	NSArray *_deliveringMouseEvents;
+	
+	TUIView *_scrollTarget; // latched for a scroll phase
+	NSTimeInterval _scrollTargetTimestamp;
+	TUIView *_gestureTarget; // latched for a magnify/rotate/swipe gesture
+	NSTimeInterval _gestureTargetTimestamp;
+	
+	NSUInteger _accessibilityGeometryGeneration; // see TUIView+Private.h
 }
 
 /**
@@ -64,6 +77,22 @@
 
 - (BOOL)isWindowKey;
 
+/**
+ Mouse moved and dragged events arriving faster than the display refreshes
+ are coalesced: the first one after an idle frame is delivered immediately,
+ later ones within the frame are merged into the newest and delivered on the
+ next +[TUIFrameClock sharedClock] tick. Any other event delivers a pending
+ one first, so ordering is kept. Default is YES.
+ */
+@property (nonatomic, assign) BOOL coalescesMouseEvents;
+
+/**
+ While a coalesced event is being delivered, every event merged into it, oldest
+ first and ending with 'event'. Views that need the full path (drawing,
+ velocity estimates) ask for this; otherwise just 'event'.
+ */
+- (NSArray *)coalescedEventsForEvent:(NSEvent *)event;
+
 @end
 
 #import "TUINSView+Hyperfocus.h"
@@ -18,23 +18,52 @@
 #import "TUIView+Private.h"
 #import "TUITextRenderer+Event.h"
 #import "TUITooltipWindow.h"
+#import "TUIInputLatency.h"
+#import "TUIStallWatchdog.h"
 #import <CoreFoundation/CoreFoundation.h>
 
 @interface TUINSView ()
 - (void)windowDidResignKey:(NSNotification *)notification;
 - (void)windowDidBecomeKey:(NSNotification *)notification;
 - (void)screenProfileOrBackingPropertiesDidChange:(NSNotification *)notification;
+- (void)backingColorSpaceDidChange:(NSNotification *)notification;
+- (void)_flushPendingMouseEvent;
+- (void)_stopCoalescing;
 @end
 
 
 @implementation TUINSView
 
 @synthesize rootView;
+@synthesize coalescesMouseEvents;
+
+#define TUINSViewMaxCoalescedEvents 64
+#define TUINSViewLatchTimeout 0.3 // a pause this long between events starts a new scroll or gesture
+
+// NSEventPhase, 10.7+
+enum {
+	TUIEventPhaseBegan = 0x1 << 0,
+	TUIEventPhaseEnded = 0x1 << 3,
+	TUIEventPhaseCancelled = 0x1 << 4,
+	TUIEventPhaseMayBegin = 0x1 << 5,
+};
+
+static NSUInteger TUIEventPhase(NSEvent *event, SEL s)
+{
+	if(![event respondsToSelector:s])
+		return 0;
+	NSUInteger (*imp)(id,SEL) = (NSUInteger(*)(id,SEL))[event methodForSelector:s];
+	return imp(event, s);
+}
 
 - (id)initWithFrame:(NSRect)frameRect
 {
 	if((self = [super initWithFrame:frameRect])) {
 		opaque = YES;
+		coalescesMouseEvents = YES;
+		_pendingMouseEvents = [[NSMutableArray alloc] init];
+		TUIGetBackingColorSpace(); // look up the screen's colour space on the main thread, before anything decodes in the background
+		[[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(backingColorSpaceDidChange:) name:TUIBackingColorSpaceDidChangeNotification object:nil];
 	}
 	return self;
 }
@@ -43,6 +72,9 @@
 {
 	[[NSNotificationCenter defaultCenter] removeObserver:self name:NSWindowDidResignKeyNotification object:nil];
 	[[NSNotificationCenter defaultCenter] removeObserver:self name:NSWindowDidBecomeKeyNotification object:nil];
+	[[NSNotificationCenter defaultCenter] removeObserver:self name:TUIBackingColorSpaceDidChangeNotification object:nil];
+	if(_coalescingFrame)
+		[[TUIFrameClock sharedClock] removeObserver:self];
 	
 	[rootView removeFromSuperview];
     rootView.nsView = nil;
@@ -95,6 +127,28 @@
 	[self addTrackingArea:_trackingArea];
 }
 
+- (NSUInteger)_accessibilityGeometryGeneration
+{
+	return _accessibilityGeometryGeneration;
+}
+
+- (void)_invalidateAccessibilityGeometry
+{
+	_accessibilityGeometryGeneration++;
+}
+
+- (void)setFrameOrigin:(NSPoint)p
+{
+	[super setFrameOrigin:p];
+	[self _invalidateAccessibilityGeometry];
+}
+
+- (void)setFrameSize:(NSSize)s
+{
+	[super setFrameSize:s];
+	[self _invalidateAccessibilityGeometry];
+}
+
 - (void)viewWillStartLiveResize
 {
 	[super viewWillStartLiveResize];
@@ -124,6 +178,7 @@
 	rootView.nsView = nil;
 	rootView = v;
 	rootView.nsView = self;
+	[self _invalidateAccessibilityGeometry];
 	
 	[rootView setNextResponder:self];
 	
@@ -164,6 +219,10 @@
 	[self.rootView willMoveToWindow:(TUINSWindow *) newWindow];
 	
 	if(newWindow == nil) {
+		[self _flushPendingMouseEvent];
+		[self _stopCoalescing];
+		_scrollTarget = nil;
+		_gestureTarget = nil;
 		[rootView removeFromSuperview];
 	}
 }
@@ -206,6 +265,11 @@
 	[self _updateLayerScaleFactor];
 }
 
+- (void)backingColorSpaceDidChange:(NSNotification *)notification
+{
+	[rootView setEverythingNeedsDisplay]; // backing stores are recreated in the new colour space
+}
+
 - (TUIView *)viewForLocalPoint:(NSPoint)p
 {
 	return [rootView hitTest:p withEvent:nil];
@@ -308,8 +372,87 @@
 	}
 }
 
+/*
+ * Mouse moved/dragged coalescing
+ */
+
+- (void)_deliverMouseEvent:(NSEvent *)event coalescedEvents:(NSArray *)events
+{
+	TUIInputLatencyBeginEvent([events count] ? [events objectAtIndex:0] : event);
+	TUIPhaseBegin(TUIPhaseEvent, nil);
+	_deliveringMouseEvents = events;
+	if([event type] == NSMouseMoved)
+		[self _updateHoverViewWithEvent:event];
+	else
+		[_trackingView mouseDragged:event];
+	_deliveringMouseEvents = nil;
+	TUIPhaseEnd();
+	TUIInputLatencyEndEvent();
+}
+
+- (void)_flushPendingMouseEvent
+{
+	if(!_pendingMouseEvent)
+		return;
+	NSEvent *event = _pendingMouseEvent;
+	NSArray *events = [_pendingMouseEvents copy];
+	_pendingMouseEvent = nil;
+	[_pendingMouseEvents removeAllObjects];
+	[self _deliverMouseEvent:event coalescedEvents:events];
+}
+
+- (void)_stopCoalescing
+{
+	if(_coalescingFrame) {
+		_coalescingFrame = NO;
+		[[TUIFrameClock sharedClock] removeObserver:self];
+	}
+}
+
+- (void)_coalesceMouseEvent:(NSEvent *)event
+{
+	if(!coalescesMouseEvents) {
+		[self _deliverMouseEvent:event coalescedEvents:nil];
+		return;
+	}
+	
+	if(!_coalescingFrame) {
+		// nothing delivered this frame, no reason to wait
+		_coalescingFrame = YES;
+		[[TUIFrameClock sharedClock] addObserver:self];
+		[self _deliverMouseEvent:event coalescedEvents:nil];
+		return;
+	}
+	
+	if(_pendingMouseEvent && [_pendingMouseEvent type] != [event type])
+		[self _flushPendingMouseEvent];
+	_pendingMouseEvent = event;
+	if([_pendingMouseEvents count] >= TUINSViewMaxCoalescedEvents)
+		[_pendingMouseEvents removeObjectAtIndex:0];
+	[_pendingMouseEvents addObject:event];
+}
+
+- (void)frameClockDidTick:(NSTimeInterval)timestamp
+{
+	if(_pendingMouseEvent)
+		[self _flushPendingMouseEvent];
+	else
+		[self _stopCoalescing]; // a frame went by without input, go back to delivering immediately
+}
+
+- (NSArray *)coalescedEventsForEvent:(NSEvent *)event
+{
+	if(event && [_deliveringMouseEvents lastObject] == event)
+		return _deliveringMouseEvents;
+	return event ? [NSArray arrayWithObject:event] : nil;
+}
+
 - (void)mouseDown:(NSEvent *)event
 {
+	[self _flushPendingMouseEvent];
+	TUIInputLatencyBeginEvent(event);
+	TUIPhaseBegin(TUIPhaseEvent, nil);
+	
 	if(_hyperFocusView) {
 		TUIView *v = [self viewForEvent:event];
 		if([v isDescendantOfView:_hyperFocusView]) {
@@ -329,10 +472,16 @@
 	}
 	
 	[TUITooltipWindow endTooltip];
+	TUIPhaseEnd();
+	TUIInputLatencyEndEvent();
 }
 
 - (void)mouseUp:(NSEvent *)event
 {
+	[self _flushPendingMouseEvent]; // the view sees the last drag before the up
+	TUIInputLatencyBeginEvent(event);
+	TUIPhaseBegin(TUIPhaseEvent, nil);
+	
 	TUIView *lastTrackingView = _trackingView;
 
 	_trackingView = nil;
@@ -340,28 +489,33 @@
 	[lastTrackingView mouseUp:event]; // after _trackingView set to nil, will call mouseUp:fromSubview:
 	
 	[self _updateHoverViewWithEvent:event];
+	TUIPhaseEnd();
+	TUIInputLatencyEndEvent();
 }
 
 - (void)mouseDragged:(NSEvent *)event
 {
-	[_trackingView mouseDragged:event];
+	[self _coalesceMouseEvent:event];
 }
 
 - (void)mouseMoved:(NSEvent *)event
 {
-	[self _updateHoverViewWithEvent:event];
+	[self _coalesceMouseEvent:event];
 }
 
 -(void)mouseEntered:(NSEvent *)event {
+  [self _flushPendingMouseEvent];
   [self _updateHoverViewWithEvent:event];
 }
 
 -(void)mouseExited:(NSEvent *)event {
+  [self _flushPendingMouseEvent];
   [self _updateHoverViewWithEvent:event];
 }
 
 - (void)rightMouseDown:(NSEvent *)event
 {
+	[self _flushPendingMouseEvent];
 	_trackingView = [self viewForEvent:event];
 	[_trackingView rightMouseDown:event];
 	[TUITooltipWindow endTooltip];
@@ -370,6 +524,7 @@
 
 - (void)rightMouseUp:(NSEvent *)event
 {
+	[self _flushPendingMouseEvent];
 	TUIView *lastTrackingView = _trackingView;
 	
 	_trackingView = nil;
@@ -377,27 +532,88 @@
 	[lastTrackingView rightMouseUp:event]; // after _trackingView set to nil, will call mouseUp:fromSubview:
 }
 
+/*
+ * Scroll and gesture events go to the view under the pointer when the
+ * phase begins, or after a pause for devices that don't report phases, and
+ * then straight to that view until the phase (for scrolls, the momentum that
+ * follows it) ends. A fling is hundreds of events, this saves a hit test for
+ * each of them and keeps the gesture on one view if content moves under the
+ * pointer. Momentum beginning doesn't re-latch: the content has moved by
+ * then, and the fling belongs to the view that was scrolled.
+ */
+
+BOOL TUIEventShouldRelatch(BOOL latched, NSUInteger phase, NSTimeInterval timestamp, NSTimeInterval lastTimestamp)
+{
+	if(!latched)
+		return YES;
+	if(phase & (TUIEventPhaseBegan | TUIEventPhaseMayBegin))
+		return YES;
+	return timestamp - lastTimestamp > TUINSViewLatchTimeout;
+}
+
+- (BOOL)_latchTarget:(TUIView * __strong *)target timestamp:(NSTimeInterval *)timestamp forEvent:(NSEvent *)event
+{
+	BOOL latched = *target && (*target).nsView == self;
+	BOOL relatch = TUIEventShouldRelatch(latched, TUIEventPhase(event, @selector(phase)), [event timestamp], *timestamp);
+	*timestamp = [event timestamp];
+	
+	if(!relatch)
+		return NO;
+	*target = [self viewForEvent:event];
+	return YES;
+}
+
 - (void)scrollWheel:(NSEvent *)event
 {
-	[[self viewForEvent:event] scrollWheel:event];
-	[self _updateHoverView:nil withEvent:event]; // don't pop in while scrolling
+	[self _flushPendingMouseEvent];
+	TUIInputLatencyBeginEvent(event);
+	TUIPhaseBegin(TUIPhaseEvent, nil);
+	
+	if([self _latchTarget:&_scrollTarget timestamp:&_scrollTargetTimestamp forEvent:event])
+		[self _updateHoverView:nil withEvent:event]; // don't pop in while scrolling
+	TUIView *target = _scrollTarget;
+	[target scrollWheel:event];
+	
+	// a phase can be followed by momentum, so only the end of momentum releases the latch
+	if(TUIEventPhase(event, @selector(momentumPhase)) & (TUIEventPhaseEnded | TUIEventPhaseCancelled))
+		_scrollTarget = nil;
+	
+	TUIPhaseEnd();
+	TUIInputLatencyEndEvent();
 }
 
 - (void)beginGestureWithEvent:(NSEvent *)event
 {
-	[[self viewForEvent:event] beginGestureWithEvent:event];
+	_gestureTarget = [self viewForEvent:event];
+	_gestureTargetTimestamp = [event timestamp];
+	[_gestureTarget beginGestureWithEvent:event];
 }
 
 - (void)endGestureWithEvent:(NSEvent *)event
 {
-	[[self viewForEvent:event] endGestureWithEvent:event];
+	TUIView *target = (_gestureTarget.nsView == self) ? _gestureTarget : [self viewForEvent:event];
+	_gestureTarget = nil;
+	[target endGestureWithEvent:event];
+}
+
+- (TUIView *)_gestureTargetForEvent:(NSEvent *)event
+{
+	[self _latchTarget:&_gestureTarget timestamp:&_gestureTargetTimestamp forEvent:event];
+	TUIView *target = _gestureTarget;
+	if(TUIEventPhase(event, @selector(phase)) & (TUIEventPhaseEnded | TUIEventPhaseCancelled))
+		_gestureTarget = nil;
+	return target;
 }
 
 - (void)magnifyWithEvent:(NSEvent *)event
 {
 	if(!deliveringEvent) {
 		deliveringEvent = YES;
-		[[self viewForEvent:event] magnifyWithEvent:event];	
+		TUIInputLatencyBeginEvent(event);
+		TUIPhaseBegin(TUIPhaseEvent, nil);
+		[[self _gestureTargetForEvent:event] magnifyWithEvent:event];	
+		TUIPhaseEnd();
+		TUIInputLatencyEndEvent();
 		deliveringEvent = NO;
 	}
 }
@@ -406,7 +622,7 @@
 {
 	if(!deliveringEvent) {
 		deliveringEvent = YES;
-		[[self viewForEvent:event] rotateWithEvent:event];
+		[[self _gestureTargetForEvent:event] rotateWithEvent:event];
 		deliveringEvent = NO;
 	}
 }
@@ -415,13 +631,17 @@
 {
 	if(!deliveringEvent) {
 		deliveringEvent = YES;
-		[[self viewForEvent:event] swipeWithEvent:event];
+		[[self _gestureTargetForEvent:event] swipeWithEvent:event];
 		deliveringEvent = NO;
 	}
 }
 
 - (void)keyDown:(NSEvent *)event
 {
+	[self _flushPendingMouseEvent];
+	TUIInputLatencyBeginEvent(event);
+	TUIPhaseBegin(TUIPhaseEvent, nil);
+	
 	BOOL consumed = NO;
 	// TUIView uses -performKeyAction: in -keyDown: to do its key equivalents. If none of our TUIViews consumed the key down as a key action, we want to give our view controller a chance to handle the key down as a key equivalent.
 	if([[self nextResponder] isKindOfClass:[NSViewController class]]) {
@@ -431,6 +651,8 @@
 	if(!consumed) {
 		[super keyDown:event];
 	}
+	TUIPhaseEnd();
+	TUIInputLatencyEndEvent();
 }
 
 - (BOOL)performKeyEquivalent:(NSEvent *)event
@@ -0,0 +1,127 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifdef __APPLE__
+#import <Foundation/Foundation.h>
+#else
+// plain C elsewhere, so extras/pixelbench can build the kernels on Linux
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+typedef signed char BOOL;
+typedef long NSInteger;
+typedef unsigned long NSUInteger;
+#define YES ((BOOL)1)
+#define NO ((BOOL)0)
+#define MIN(A, B) ((A) < (B) ? (A) : (B))
+#define MAX(A, B) ((A) > (B) ? (A) : (B))
+#endif
+
+/*
+ Pixel kernels used by TUIImage (Drawing).
+
+ Pixels are 32 bit premultiplied, in host byte order with alpha in the high
+ byte, i.e. what TUICreateGraphicsContext() creates. Alpha planes are 8 bit.
+ The per-pixel kernels have an SSE2 or NEON path and a scalar path producing
+ identical results; set TUIPixelKernelsForceScalar to compare them.
+ */
+
+typedef struct {
+	uint32_t *data;
+	size_t width;
+	size_t height;
+	size_t bytesPerRow;
+} TUIPixelBuffer;
+
+typedef struct {
+	uint8_t *data;
+	size_t width;
+	size_t height;
+	size_t bytesPerRow;
+} TUIAlphaBuffer;
+
+extern BOOL TUIPixelKernelsForceScalar;
+
+#ifdef __APPLE__
+/**
+ @returns a buffer describing the backing store of a bitmap context created by TUICreateGraphicsContext()
+ */
+extern TUIPixelBuffer TUIPixelBufferFromBitmapContext(CGContextRef ctx);
+#endif
+
+/**
+ (x * a) / 255, rounded. Exact for all 8 bit inputs, and the reference for the vector paths.
+ */
+static inline uint32_t TUIPixelMul255(uint32_t x, uint32_t a)
+{
+	uint32_t t = x * a + 128;
+	return (t + (t >> 8)) >> 8;
+}
+
+/**
+ Every channel of every pixel multiplied by the matching mask value.
+ */
+extern void TUIPixelBufferMultiplyByMask(TUIPixelBuffer dst, TUIAlphaBuffer mask);
+
+/**
+ Bilinear resample of 'src' to the size of 'dst', pixel centers aligned. Weights are 8 bit fixed point.
+ Only the vertical pass is vectorized, the horizontal pass gathers. Reductions below half size alias,
+ callers should prefilter or use CoreGraphics for those.
+ @returns NO if scratch memory couldn't be allocated, 'dst' is untouched then
+ */
+extern BOOL TUIPixelBufferScaleBilinear(TUIPixelBuffer dst, TUIPixelBuffer src);
+
+/**
+ Every channel multiplied by the coverage of a rounded rect filling the buffer, i.e. what
+ clipping to CGContextAddRoundRect() with 'radius' does. Only the four radius x radius
+ corners are touched, the coverage is computed analytically. 'radius' is clamped to half the
+ smaller side. Scalar only, it's O(radius^2).
+ */
+extern void TUIPixelBufferRoundCorners(TUIPixelBuffer dst, NSUInteger radius);
+
+/**
+ Premultiplied black, alpha = 255 - source alpha. 'dst' may be 'src'.
+ */
+extern void TUIPixelBufferInvertAlpha(TUIPixelBuffer dst, TUIPixelBuffer src);
+
+/**
+ Premultiplied black, alpha = a(x, y) * (255 - a(x - dx, y - dy)). Samples
+ outside 'src' count as uncovered by the inverted term. dy is in rows, i.e.
+ positive moves down in memory. 'dst' must not be 'src'.
+ */
+extern void TUIPixelBufferEmbossAlpha(TUIPixelBuffer dst, TUIPixelBuffer src, NSInteger dx, NSInteger dy);
+
+/**
+ Copy the alpha channel of 'src' into 'dst', optionally inverted, shifted by (dx, dy) rows/columns.
+ Samples shifted in from outside 'src' are 'outside'.
+ */
+extern void TUIAlphaBufferFromPixelBuffer(TUIAlphaBuffer dst, TUIPixelBuffer src, BOOL invert, NSInteger dx, NSInteger dy, uint8_t outside);
+
+/**
+ Box blur of an alpha plane with a (2 * radius + 1) window, edges clamped.
+ Three passes approximate a gaussian with sigma ~= radius. Scalar only, running sums don't vectorize well.
+ @returns NO if scratch memory couldn't be allocated, 'buffer' is untouched then
+ */
+extern BOOL TUIAlphaBufferBoxBlur(TUIAlphaBuffer buffer, NSUInteger radius, NSUInteger passes);
+
+/**
+ dst = shape * (background * fill + shadow * blurred * background.alpha * (1 - background.alpha * fill)), per pixel.
+ This is what drawing 'background' clipped to 'fill' with a shadow, clipped to 'shape', produces:
+ the shadow is cast by the filled layer, whose alpha is background.alpha * fill.
+ 'shadow' and 'background' are premultiplied pixels.
+ */
+extern void TUIPixelBufferCompositeInnerShadow(TUIPixelBuffer dst, TUIAlphaBuffer shape, TUIAlphaBuffer fill, TUIAlphaBuffer blurred, uint32_t shadow, uint32_t background);
@@ -0,0 +1,392 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIPixelKernels.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define TUI_PIXEL_SSE2 1
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TUI_PIXEL_NEON 1
+#endif
+
+BOOL TUIPixelKernelsForceScalar = NO;
+
+#define ROW(B, Y) ((uint32_t *)((uint8_t *)(B).data + (Y) * (B).bytesPerRow))
+#define AROW(B, Y) ((B).data + (Y) * (B).bytesPerRow)
+
+#ifdef __APPLE__
+TUIPixelBuffer TUIPixelBufferFromBitmapContext(CGContextRef ctx)
+{
+	TUIPixelBuffer b;
+	b.data = (uint32_t *)CGBitmapContextGetData(ctx);
+	b.width = CGBitmapContextGetWidth(ctx);
+	b.height = CGBitmapContextGetHeight(ctx);
+	b.bytesPerRow = CGBitmapContextGetBytesPerRow(ctx);
+	return b;
+}
+#endif
+
+#if TUI_PIXEL_SSE2
+static inline __m128i TUIDiv255_epi16(__m128i v) // same rounding as TUIPixelMul255()
+{
+	__m128i t = _mm_add_epi16(v, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+static inline __m128i TUIDiv255_epi32(__m128i v)
+{
+	__m128i t = _mm_add_epi32(v, _mm_set1_epi32(128));
+	return _mm_srli_epi32(_mm_add_epi32(t, _mm_srli_epi32(t, 8)), 8);
+}
+#endif
+
+#if TUI_PIXEL_NEON
+static inline uint8x8_t TUIDiv255_u16(uint16x8_t v) // same rounding as TUIPixelMul255()
+{
+	return vrshrn_n_u16(vrsraq_n_u16(v, v, 8), 8);
+}
+#endif
+
+void TUIPixelBufferMultiplyByMask(TUIPixelBuffer dst, TUIAlphaBuffer mask)
+{
+	size_t w = MIN(dst.width, mask.width);
+	size_t h = MIN(dst.height, mask.height);
+	
+	for(size_t y = 0; y < h; ++y) {
+		uint32_t *d = ROW(dst, y);
+		const uint8_t *m = AROW(mask, y);
+		size_t x = 0;
+		
+		if(!TUIPixelKernelsForceScalar) {
+#if TUI_PIXEL_SSE2
+			__m128i zero = _mm_setzero_si128();
+			for(; x + 4 <= w; x += 4) {
+				int32_t m4;
+				memcpy(&m4, m + x, 4);
+				__m128i mv = _mm_cvtsi32_si128(m4);
+				mv = _mm_unpacklo_epi8(mv, mv);
+				mv = _mm_unpacklo_epi16(mv, mv); // each mask byte repeated for the 4 channels of its pixel
+				__m128i px = _mm_loadu_si128((const __m128i *)(d + x));
+				__m128i lo = TUIDiv255_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(px, zero), _mm_unpacklo_epi8(mv, zero)));
+				__m128i hi = TUIDiv255_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(px, zero), _mm_unpackhi_epi8(mv, zero)));
+				_mm_storeu_si128((__m128i *)(d + x), _mm_packus_epi16(lo, hi));
+			}
+#elif TUI_PIXEL_NEON
+			for(; x + 8 <= w; x += 8) {
+				uint8x8x4_t px = vld4_u8((const uint8_t *)(d + x));
+				uint8x8_t mv = vld1_u8(m + x);
+				px.val[0] = TUIDiv255_u16(vmull_u8(px.val[0], mv));
+				px.val[1] = TUIDiv255_u16(vmull_u8(px.val[1], mv));
+				px.val[2] = TUIDiv255_u16(vmull_u8(px.val[2], mv));
+				px.val[3] = TUIDiv255_u16(vmull_u8(px.val[3], mv));
+				vst4_u8((uint8_t *)(d + x), px);
+			}
+#endif
+		}
+		
+		for(; x < w; ++x) {
+			uint32_t p = d[x];
+			uint32_t a = m[x];
+			d[x] = (TUIPixelMul255((p >> 24) & 0xff, a) << 24) |
+			       (TUIPixelMul255((p >> 16) & 0xff, a) << 16) |
+			       (TUIPixelMul255((p >> 8) & 0xff, a) << 8) |
+			       TUIPixelMul255(p & 0xff, a);
+		}
+	}
+}
+
+// source position of each destination sample in 16.16 fixed point, pixel centers aligned, clamped to the edges
+static inline void TUIScalePosition(size_t i, size_t srcSize, size_t dstSize, size_t *index, uint32_t *weight)
+{
+	int64_t step = ((int64_t)srcSize << 16) / (int64_t)dstSize;
+	int64_t f = (int64_t)i * step + step / 2 - 0x8000;
+	int64_t last = ((int64_t)srcSize - 1) << 16;
+	f = MIN(MAX(f, 0), last);
+	*index = (size_t)(f >> 16);
+	*weight = (uint32_t)((f >> 8) & 0xff); // of the next sample, out of 256
+}
+
+// (a * (256 - w) + b * w + 128) >> 8, per channel
+static inline uint32_t TUIPixelLerp(uint32_t a, uint32_t b, uint32_t w)
+{
+	uint32_t p = 0;
+	for(int c = 0; c < 32; c += 8)
+		p |= ((((a >> c) & 0xff) * (256 - w) + ((b >> c) & 0xff) * w + 128) >> 8) << c;
+	return p;
+}
+
+static void TUIPixelRowLerp(uint32_t *d, const uint32_t *a, const uint32_t *b, size_t w, uint32_t weight)
+{
+	size_t x = 0;
+	
+	if(!TUIPixelKernelsForceScalar) {
+#if TUI_PIXEL_SSE2
+		__m128i zero = _mm_setzero_si128();
+		__m128i wa = _mm_set1_epi16((short)(256 - weight));
+		__m128i wb = _mm_set1_epi16((short)weight);
+		__m128i half = _mm_set1_epi16(128);
+		for(; x + 4 <= w; x += 4) {
+			__m128i pa = _mm_loadu_si128((const __m128i *)(a + x));
+			__m128i pb = _mm_loadu_si128((const __m128i *)(b + x));
+			// at most 255 * 256 + 128, so the unsigned 16 bit lanes don't overflow
+			__m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(pa, zero), wa), _mm_mullo_epi16(_mm_unpacklo_epi8(pb, zero), wb)), half);
+			__m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(pa, zero), wa), _mm_mullo_epi16(_mm_unpackhi_epi8(pb, zero), wb)), half);
+			_mm_storeu_si128((__m128i *)(d + x), _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+		}
+#elif TUI_PIXEL_NEON
+		uint16_t wa = (uint16_t)(256 - weight);
+		uint16_t wb = (uint16_t)weight;
+		for(; x + 4 <= w; x += 4) {
+			uint8x16_t pa = vld1q_u8((const uint8_t *)(a + x));
+			uint8x16_t pb = vld1q_u8((const uint8_t *)(b + x));
+			uint16x8_t lo = vmlaq_n_u16(vmulq_n_u16(vmovl_u8(vget_low_u8(pa)), wa), vmovl_u8(vget_low_u8(pb)), wb);
+			uint16x8_t hi = vmlaq_n_u16(vmulq_n_u16(vmovl_u8(vget_high_u8(pa)), wa), vmovl_u8(vget_high_u8(pb)), wb);
+			vst1q_u8((uint8_t *)(d + x), vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)));
+		}
+#endif
+	}
+	
+	for(; x < w; ++x)
+		d[x] = TUIPixelLerp(a[x], b[x], weight);
+}
+
+BOOL TUIPixelBufferScaleBilinear(TUIPixelBuffer dst, TUIPixelBuffer src)
+{
+	if(dst.width == 0 || dst.height == 0 || src.width == 0 || src.height == 0)
+		return YES;
+	
+	// column table and one vertically blended source row
+	size_t *columns = malloc(dst.width * (sizeof(size_t) + sizeof(uint32_t)) + src.width * sizeof(uint32_t));
+	if(!columns)
+		return NO;
+	uint32_t *columnWeights = (uint32_t *)(columns + dst.width);
+	uint32_t *line = columnWeights + dst.width;
+	for(size_t x = 0; x < dst.width; ++x)
+		TUIScalePosition(x, src.width, dst.width, &columns[x], &columnWeights[x]);
+	
+	for(size_t y = 0; y < dst.height; ++y) {
+		size_t sy;
+		uint32_t wy;
+		TUIScalePosition(y, src.height, dst.height, &sy, &wy);
+		TUIPixelRowLerp(line, ROW(src, sy), ROW(src, MIN(sy + 1, src.height - 1)), src.width, wy);
+		
+		uint32_t *d = ROW(dst, y);
+		for(size_t x = 0; x < dst.width; ++x) {
+			size_t sx = columns[x];
+			d[x] = TUIPixelLerp(line[sx], line[MIN(sx + 1, src.width - 1)], columnWeights[x]);
+		}
+	}
+	
+	free(columns);
+	return YES;
+}
+
+void TUIPixelBufferRoundCorners(TUIPixelBuffer dst, NSUInteger radius)
+{
+	size_t r = MIN((size_t)radius, MIN(dst.width, dst.height) / 2);
+	
+	// (i, j) is the pixel's distance from the corner, mirrored into all four corners
+	for(size_t j = 0; j < r; ++j) {
+		uint32_t *top = ROW(dst, j);
+		uint32_t *bottom = ROW(dst, dst.height - 1 - j);
+		for(size_t i = 0; i < r; ++i) {
+			double dx = (double)r - (i + 0.5);
+			double dy = (double)r - (j + 0.5);
+			double coverage = (double)r + 0.5 - sqrt(dx * dx + dy * dy);
+			if(coverage >= 1.0)
+				break; // inside the arc from here on
+			uint32_t a = coverage <= 0.0 ? 0 : (uint32_t)(coverage * 255.0 + 0.5);
+			size_t mirrored = dst.width - 1 - i;
+			uint32_t *corners[4] = {&top[i], &top[mirrored], &bottom[i], &bottom[mirrored]};
+			for(int k = 0; k < 4; ++k) {
+				uint32_t p = *corners[k];
+				*corners[k] = (TUIPixelMul255((p >> 24) & 0xff, a) << 24) |
+				              (TUIPixelMul255((p >> 16) & 0xff, a) << 16) |
+				              (TUIPixelMul255((p >> 8) & 0xff, a) << 8) |
+				              TUIPixelMul255(p & 0xff, a);
+			}
+		}
+	}
+}
+
+void TUIPixelBufferInvertAlpha(TUIPixelBuffer dst, TUIPixelBuffer src)
+{
+	size_t w = MIN(dst.width, src.width);
+	size_t h = MIN(dst.height, src.height);
+	
+	for(size_t y = 0; y < h; ++y) {
+		uint32_t *d = ROW(dst, y);
+		const uint32_t *s = ROW(src, y);
+		size_t x = 0;
+		
+		if(!TUIPixelKernelsForceScalar) {
+#if TUI_PIXEL_SSE2
+			__m128i amask = _mm_set1_epi32(0xff000000);
+			for(; x + 4 <= w; x += 4)
+				_mm_storeu_si128((__m128i *)(d + x), _mm_andnot_si128(_mm_loadu_si128((const __m128i *)(s + x)), amask));
+#elif TUI_PIXEL_NEON
+			uint32x4_t amask = vdupq_n_u32(0xff000000);
+			for(; x + 4 <= w; x += 4)
+				vst1q_u32(d + x, vbicq_u32(amask, vld1q_u32(s + x)));
+#endif
+		}
+		
+		for(; x < w; ++x)
+			d[x] = ~s[x] & 0xff000000;
+	}
+}
+
+void TUIPixelBufferEmbossAlpha(TUIPixelBuffer dst, TUIPixelBuffer src, NSInteger dx, NSInteger dy)
+{
+	size_t w = MIN(dst.width, src.width);
+	size_t h = MIN(dst.height, src.height);
+	
+	// columns where x - dx lands inside the source
+	size_t x0 = (size_t)MIN(MAX(dx, 0), (NSInteger)w);
+	size_t x1 = (size_t)MAX(MIN((NSInteger)w + dx, (NSInteger)w), (NSInteger)x0);
+	
+	for(size_t y = 0; y < h; ++y) {
+		uint32_t *d = ROW(dst, y);
+		const uint32_t *s = ROW(src, y);
+		NSInteger sy = (NSInteger)y - dy;
+		
+		if(sy < 0 || sy >= (NSInteger)h) {
+			memset(d, 0, w * 4);
+			continue;
+		}
+		
+		const uint32_t *o = ROW(src, sy) - dx; // o[x] is the offset sample for column x, valid in [x0, x1)
+		size_t x = 0;
+		for(; x < x0; ++x)
+			d[x] = 0;
+		
+		if(!TUIPixelKernelsForceScalar) {
+#if TUI_PIXEL_SSE2
+			__m128i amask = _mm_set1_epi32(0xff000000);
+			for(; x + 4 <= x1; x += 4) {
+				__m128i a = _mm_srli_epi32(_mm_loadu_si128((const __m128i *)(s + x)), 24);
+				__m128i inv = _mm_srli_epi32(_mm_andnot_si128(_mm_loadu_si128((const __m128i *)(o + x)), amask), 24);
+				__m128i r = TUIDiv255_epi32(_mm_mullo_epi16(a, inv)); // products fit the low 16 bits of each lane
+				_mm_storeu_si128((__m128i *)(d + x), _mm_slli_epi32(r, 24));
+			}
+#elif TUI_PIXEL_NEON
+			uint32x4_t amask = vdupq_n_u32(0xff000000);
+			uint32x4_t half = vdupq_n_u32(128);
+			for(; x + 4 <= x1; x += 4) {
+				uint32x4_t a = vshrq_n_u32(vld1q_u32(s + x), 24);
+				uint32x4_t inv = vshrq_n_u32(vbicq_u32(amask, vld1q_u32(o + x)), 24);
+				uint32x4_t t = vaddq_u32(vmulq_u32(a, inv), half);
+				uint32x4_t r = vshrq_n_u32(vaddq_u32(t, vshrq_n_u32(t, 8)), 8);
+				vst1q_u32(d + x, vshlq_n_u32(r, 24));
+			}
+#endif
+		}
+		
+		for(; x < x1; ++x)
+			d[x] = TUIPixelMul255(s[x] >> 24, 255 - (o[x] >> 24)) << 24;
+		for(; x < w; ++x)
+			d[x] = 0;
+	}
+}
+
+void TUIAlphaBufferFromPixelBuffer(TUIAlphaBuffer dst, TUIPixelBuffer src, BOOL invert, NSInteger dx, NSInteger dy, uint8_t outside)
+{
+	uint8_t flip = invert ? 0xff : 0x00;
+	for(size_t y = 0; y < dst.height; ++y) {
+		uint8_t *d = AROW(dst, y);
+		NSInteger sy = (NSInteger)y - dy;
+		if(sy < 0 || sy >= (NSInteger)src.height) {
+			memset(d, outside, dst.width);
+			continue;
+		}
+		const uint32_t *s = ROW(src, sy);
+		for(size_t x = 0; x < dst.width; ++x) {
+			NSInteger sx = (NSInteger)x - dx;
+			d[x] = (sx < 0 || sx >= (NSInteger)src.width) ? outside : (uint8_t)(s[sx] >> 24) ^ flip;
+		}
+	}
+}
+
+static void TUIBoxBlurLine(const uint8_t *in, size_t inStride, uint8_t *out, size_t outStride, size_t n, NSInteger r)
+{
+	NSInteger window = 2 * r + 1;
+	NSInteger last = (NSInteger)n - 1;
+	uint32_t sum = 0;
+	
+	#define AT(I) in[MIN(MAX((I), 0), last) * inStride]
+	for(NSInteger i = -r; i <= r; ++i)
+		sum += AT(i);
+	for(NSInteger i = 0; i < (NSInteger)n; ++i) {
+		out[i * outStride] = (uint8_t)((sum + window / 2) / window);
+		sum += AT(i + r + 1);
+		sum -= AT(i - r);
+	}
+	#undef AT
+}
+
+BOOL TUIAlphaBufferBoxBlur(TUIAlphaBuffer buffer, NSUInteger radius, NSUInteger passes)
+{
+	if(radius == 0 || buffer.width == 0 || buffer.height == 0)
+		return YES;
+	
+	size_t n = MAX(buffer.width, buffer.height);
+	uint8_t *line = malloc(n);
+	if(!line)
+		return NO;
+	
+	for(NSUInteger pass = 0; pass < passes; ++pass) {
+		for(size_t y = 0; y < buffer.height; ++y) {
+			uint8_t *row = AROW(buffer, y);
+			memcpy(line, row, buffer.width);
+			TUIBoxBlurLine(line, 1, row, 1, buffer.width, radius);
+		}
+		for(size_t x = 0; x < buffer.width; ++x) {
+			for(size_t y = 0; y < buffer.height; ++y)
+				line[y] = AROW(buffer, y)[x];
+			TUIBoxBlurLine(line, 1, buffer.data + x, buffer.bytesPerRow, buffer.height, radius);
+		}
+	}
+	
+	free(line);
+	return YES;
+}
+
+void TUIPixelBufferCompositeInnerShadow(TUIPixelBuffer dst, TUIAlphaBuffer shape, TUIAlphaBuffer fill, TUIAlphaBuffer blurred, uint32_t shadow, uint32_t background)
+{
+	size_t w = MIN(MIN(dst.width, shape.width), MIN(fill.width, blurred.width));
+	size_t h = MIN(MIN(dst.height, shape.height), MIN(fill.height, blurred.height));
+	uint32_t backgroundAlpha = background >> 24;
+	
+	for(size_t y = 0; y < h; ++y) {
+		uint32_t *d = ROW(dst, y);
+		const uint8_t *sh = AROW(shape, y);
+		const uint8_t *f = AROW(fill, y);
+		const uint8_t *b = AROW(blurred, y);
+		for(size_t x = 0; x < w; ++x) {
+			uint32_t coverage = TUIPixelMul255(backgroundAlpha, f[x]);
+			// the shadow is cast by the layer's alpha, i.e. background alpha * fill
+			uint32_t shadowAlpha = TUIPixelMul255(TUIPixelMul255(b[x], backgroundAlpha), 255 - coverage);
+			uint32_t p = 0;
+			for(int c = 0; c < 32; c += 8) {
+				uint32_t v = TUIPixelMul255((background >> c) & 0xff, f[x]) + TUIPixelMul255((shadow >> c) & 0xff, shadowAlpha);
+				p |= TUIPixelMul255(MIN(v, 255), sh[x]) << c;
+			}
+			d[x] = p;
+		}
+	}
+}
@@ -17,6 +17,7 @@
 #import "TUIPopover.h"
 #import "TUINSWindow.h"
 #import "TUIViewController.h"
+#import "TUIShapeCache.h"
 
 #import "CAAnimation+TUIExtensions.h"
 
@@ -24,7 +25,23 @@
 
 //***************************************************************************
 
+// everything the default popover outline depends on
+typedef struct {
+	CGRectEdge arrowEdge;
+	CGRect contentRect;
+	CGFloat midOriginX;
+	CGFloat midOriginY;
+	CGFloat minArrowX;
+	CGFloat maxArrowX;
+	CGFloat minArrowY;
+	CGFloat maxArrowY;
+} TUIPopoverPathGeometry;
+
 @interface TUIPopoverBackgroundView ()
+{
+	CGPathRef _popoverPath; // rebuilt when the geometry changes
+	TUIPopoverPathGeometry _popoverPathGeometry;
+}
 
 @property (nonatomic, unsafe_unretained) CGRect screenOriginRect;
 @property (nonatomic, unsafe_unretained) CGRectEdge popoverEdge;
@@ -436,6 +453,19 @@ CGFloat const TUIPopoverBackgroundViewArrowWidth = 35.0;
 		}
 	}
 	
+	TUIPopoverPathGeometry geometry;
+	memset(&geometry, 0, sizeof(geometry)); // compared bytewise, padding included
+	geometry.arrowEdge = arrowEdge;
+	geometry.contentRect = contentRect;
+	geometry.midOriginX = midOriginX;
+	geometry.midOriginY = midOriginY;
+	geometry.minArrowX = minArrowX;
+	geometry.maxArrowX = maxArrowX;
+	geometry.minArrowY = minArrowY;
+	geometry.maxArrowY = maxArrowY;
+	if(_popoverPath && memcmp(&geometry, &_popoverPathGeometry, sizeof(geometry)) == 0)
+		return CGPathRetain(_popoverPath);
+	
 	CGMutablePathRef path = CGPathCreateMutable();
 	CGPathMoveToPoint(path, NULL, minX, floor(minY + TUIPopoverBackgroundViewBorderRadius));
 	if (arrowEdge == CGRectMinXEdge) {
@@ -467,8 +497,15 @@ CGFloat const TUIPopoverBackgroundViewArrowWidth = 35.0;
 	
 	CGPathAddArc(path, NULL, floor(minX + TUIPopoverBackgroundViewBorderRadius), floor(minY + TUIPopoverBackgroundViewBorderRadius), TUIPopoverBackgroundViewBorderRadius, -M_PI / 2, M_PI, 1);
 	
-	return path;
+	CGPathRelease(_popoverPath);
+	_popoverPath = path;
+	memcpy(&_popoverPathGeometry, &geometry, sizeof(geometry));
+	return CGPathRetain(path);
+}
 
+- (void)dealloc
+{
+	CGPathRelease(_popoverPath);
 }
 
 - (id)initWithFrame:(CGRect)frame popoverEdge:(CGRectEdge)popoverEdge originScreenRect:(CGRect)originScreenRect //originScreenRect is in the screen coordinate space 
@@ -570,7 +607,6 @@ CGFloat const TUIPopoverBackgroundViewArrowWidth = 35.0;
 	
     
     CGContextRef context = [[NSGraphicsContext currentContext] graphicsPort];
-    [[NSColor whiteColor] set];
 	
 	CGRect targetRect = CGRectZero;
 	switch (self.arrowEdge) {
@@ -591,7 +627,7 @@ CGFloat const TUIPopoverBackgroundViewArrowWidth = 35.0;
 			break;
 	}
 	
-	CGContextFillRoundRect(context, targetRect, TUIPopoverBackgroundViewBorderRadius);
+	CGContextFillRoundRectWithColor(context, targetRect, TUIPopoverBackgroundViewBorderRadius, CGColorGetConstantColor(kCGColorWhite));
     
     [NSGraphicsContext restoreGraphicsState];
 }
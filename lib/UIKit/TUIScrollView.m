@@ -18,6 +18,7 @@
 #import "TUIScrollKnob.h"
 #import "TUIView+Private.h"
 #import "TUINSView.h"
+#import "TUIInputLatency.h"
 
 #define KNOB_Z_POSITION 6000
 
@@ -535,6 +536,8 @@ static CGPoint PointLerp(CGPoint a, CGPoint b, CGFloat t)
 
 - (void)_setContentOffset:(CGPoint)p
 {
+	TUIInputLatencyNoteInvalidation();
+	TUIAccessibilityInvalidateGeometry(self);
 	_unroundedContentOffset = p;
 	p.x = round(-p.x - self.bounceOffset.x - self.pullOffset.x);
 	p.y = round(-p.y - self.bounceOffset.y - self.pullOffset.y);
@@ -0,0 +1,61 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+/*
+ Chrome (round rect fills, highlight glows, tooltip gradients) is drawn with
+ the same few shapes over and over. These rasterize a shape once into a
+ nine-slice at the context's device scale, so drawing it again is a few image
+ blits rather than a path fill, and intern gradients by their stops. Entries
+ are evicted least recently used first.
+ 
+ The fills fall back to a path fill when the context is rotated, skewed or
+ flipped, or the rect is smaller than the slice caps.
+ 
+ All functions are thread safe. Create functions follow the CF create rule.
+ */
+
+/**
+ Device RGB gradient, interned by its stops. 'components' holds 4 * count
+ RGBA values; 'locations' may be NULL for evenly spaced stops.
+ */
+extern CGGradientRef TUICreateCachedGradient(const CGFloat *components, const CGFloat *locations, size_t count);
+
+/**
+ Fill a round rect with 'color'. Unlike CGContextFillRoundRect() the fill
+ color, not the context's, is used and the context's shadow (if any) applies
+ per slice, so don't use this with a shadow set.
+ */
+extern void CGContextFillRoundRectWithColor(CGContextRef context, CGRect rect, CGFloat radius, CGColorRef color);
+
+/**
+ The same with an unoffset shadow of 'blur' (in device pixels, like
+ CGContextSetShadowWithColor() in a bitmap context) around it. The glow is
+ part of the cached bitmap, so it doesn't seam between slices, and it extends
+ past 'rect' by about 'blur'.
+ */
+extern void CGContextFillRoundRectWithColorAndGlow(CGContextRef context, CGRect rect, CGFloat radius, CGColorRef color, CGFloat blur, CGColorRef glowColor);
+
+/**
+ Fill a round rect with a device RGB gradient running from 'topColor' to
+ 'bottomColor'. Only the width stretches, the bitmap is as tall as the rect,
+ so this suits fixed height chrome such as tooltips.
+ */
+extern void CGContextFillRoundRectWithVerticalGradient(CGContextRef context, CGRect rect, CGFloat radius, const CGFloat topColor[4], const CGFloat bottomColor[4]);
+
+extern void TUIShapeCacheRemoveAll(void);
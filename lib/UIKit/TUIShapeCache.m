@@ -0,0 +1,298 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+
+#import "TUIShapeCache.h"
+#import "TUICGAdditions.h"
+#import "TUIImageCache.h"
+
+#define TUIShapeCacheMaxEntries 512
+
+typedef enum {
+	TUIShapeGradient,
+	TUIShapeRoundRectFill,
+	TUIShapeRoundRectGlow,
+	TUIShapeRoundRectGradient,
+} TUIShapeKind;
+
+// what a cached bitmap depends on besides its CGColors, compared bytewise
+typedef struct {
+	TUIShapeKind kind;
+	CGFloat radius; // points, clamped and floored like CGContextAddRoundRect()
+	CGFloat scale;
+	CGFloat height; // device pixels, gradient fills only
+	CGFloat blur; // glows only
+	CGFloat colors[8]; // gradient fills only
+} TUIShapeKey;
+
+static void TUIShapeKeyInit(TUIShapeKey *key, TUIShapeKind kind, CGFloat radius, CGFloat scale)
+{
+	memset(key, 0, sizeof(*key)); // padding is compared too
+	key->kind = kind;
+	key->radius = radius;
+	key->scale = scale;
+}
+
+// CGColors compare by colour space and components; constant colours also hit on identity
+static id TUIShapeKeyObject(const TUIShapeKey *key, CGColorRef color, CGColorRef otherColor)
+{
+	NSData *data = [NSData dataWithBytes:key length:sizeof(*key)];
+	if(otherColor)
+		return [NSArray arrayWithObjects:data, (__bridge id)color, (__bridge id)otherColor, nil];
+	if(color)
+		return [NSArray arrayWithObjects:data, (__bridge id)color, nil];
+	return data;
+}
+
+@interface TUINineSlice : NSObject
+{
+	@public
+	CGImageRef slices[9]; // rows top to bottom (image order), columns left to right, NULL where empty
+	CGFloat capX; // in points
+	CGFloat capY;
+	CGFloat outset; // how far the bitmap extends past the filled rect, in points
+}
+@end
+
+@implementation TUINineSlice
+
+- (void)dealloc
+{
+	for(int i = 0; i < 9; ++i)
+		CGImageRelease(slices[i]);
+}
+
+@end
+
+// entries cost 1 each, sizes vary with window size, so keep the whole thing bounded
+static TUIImageCache *TUIShapeCacheEntries(void)
+{
+	static TUIImageCache *entries = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		entries = [[TUIImageCache alloc] initWithTotalCostLimit:TUIShapeCacheMaxEntries];
+	});
+	return entries;
+}
+
+static CGColorSpaceRef TUIShapeCacheRGBColorSpace(void)
+{
+	static CGColorSpaceRef space = NULL;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		space = CGColorSpaceCreateDeviceRGB();
+	});
+	return space;
+}
+
+void TUIShapeCacheRemoveAll(void)
+{
+	[TUIShapeCacheEntries() removeAllImages];
+}
+
+CGGradientRef TUICreateCachedGradient(const CGFloat *components, const CGFloat *locations, size_t count)
+{
+	// the stops themselves are the key
+	TUIShapeKind kind = TUIShapeGradient;
+	NSMutableData *key = [NSMutableData dataWithBytes:&kind length:sizeof(kind)];
+	[key appendBytes:&count length:sizeof(count)];
+	[key appendBytes:components length:count * 4 * sizeof(CGFloat)];
+	if(locations)
+		[key appendBytes:locations length:count * sizeof(CGFloat)];
+	
+	id gradient = [TUIShapeCacheEntries() objectForKey:key];
+	if(!gradient) {
+		CGGradientRef g = CGGradientCreateWithColorComponents(TUIShapeCacheRGBColorSpace(), components, locations, count);
+		if(!g)
+			return NULL;
+		gradient = CFBridgingRelease(g);
+		[TUIShapeCacheEntries() setObject:gradient forKey:key cost:1];
+	}
+	return CGGradientRetain((__bridge CGGradientRef)gradient);
+}
+
+/*
+ 'draw' paints a width x height pixel bitmap. The capX and capY pixels at its
+ edges keep their size; the stretchX x stretchY pixels at its center are
+ stretched over the rest of the rect.
+ */
+static TUINineSlice *TUINineSliceForKey(id key, size_t width, size_t height, size_t capX, size_t capY, size_t stretchX, size_t stretchY, CGFloat scale, CGFloat outset, void (^draw)(CGContextRef ctx, CGRect bounds))
+{
+	TUINineSlice *nineSlice = [TUIShapeCacheEntries() objectForKey:key];
+	if(nineSlice)
+		return nineSlice;
+	
+	CGContextRef ctx = TUICreateGraphicsContext(CGSizeMake(width, height));
+	if(!ctx)
+		return nil;
+	draw(ctx, CGRectMake(0, 0, width, height));
+	CGImageRef image = CGBitmapContextCreateImage(ctx);
+	CGContextRelease(ctx);
+	if(!image)
+		return nil;
+	
+	nineSlice = [[TUINineSlice alloc] init];
+	nineSlice->capX = capX / scale;
+	nineSlice->capY = capY / scale;
+	nineSlice->outset = outset;
+	CGFloat xs[3] = {0, (width - stretchX) / 2, width - capX};
+	CGFloat widths[3] = {capX, stretchX, capX};
+	CGFloat ys[3] = {0, (height - stretchY) / 2, height - capY};
+	CGFloat heights[3] = {capY, stretchY, capY};
+	for(int row = 0; row < 3; ++row) {
+		for(int column = 0; column < 3; ++column) {
+			if(widths[column] > 0 && heights[row] > 0)
+				nineSlice->slices[row * 3 + column] = CGImageCreateWithImageInRect(image, CGRectMake(xs[column], ys[row], widths[column], heights[row]));
+		}
+	}
+	CGImageRelease(image);
+	
+	[TUIShapeCacheEntries() setObject:nineSlice forKey:key cost:1];
+	return nineSlice;
+}
+
+static BOOL TUINineSliceFits(TUINineSlice *nineSlice, CGRect rect)
+{
+	return nineSlice && rect.size.width + nineSlice->outset * 2 >= nineSlice->capX * 2 && rect.size.height + nineSlice->outset * 2 >= nineSlice->capY * 2;
+}
+
+static void TUINineSliceDraw(CGContextRef context, CGRect rect, TUINineSlice *nineSlice)
+{
+	rect = CGRectInset(rect, -nineSlice->outset, -nineSlice->outset);
+	CGFloat capX = nineSlice->capX;
+	CGFloat capY = nineSlice->capY;
+	CGFloat xs[3] = {CGRectGetMinX(rect), CGRectGetMinX(rect) + capX, CGRectGetMaxX(rect) - capX};
+	CGFloat widths[3] = {capX, rect.size.width - capX * 2, capX};
+	CGFloat ys[3] = {CGRectGetMaxY(rect) - capY, CGRectGetMinY(rect) + capY, CGRectGetMinY(rect)}; // image rows run top down
+	CGFloat heights[3] = {capY, rect.size.height - capY * 2, capY};
+	for(int row = 0; row < 3; ++row) {
+		for(int column = 0; column < 3; ++column) {
+			CGImageRef slice = nineSlice->slices[row * 3 + column];
+			if(slice && widths[column] > 0 && heights[row] > 0)
+				CGContextDrawImage(context, CGRectMake(xs[column], ys[row], widths[column], heights[row]), slice);
+		}
+	}
+}
+
+// device pixels per point, 0 unless the context is only scaled and translated
+static CGFloat TUIContextDeviceScale(CGContextRef context)
+{
+	CGAffineTransform t = CGContextGetUserSpaceToDeviceSpaceTransform(context);
+	if(t.b != 0.0 || t.c != 0.0 || t.a <= 0.0 || t.d != t.a)
+		return 0.0;
+	return t.a;
+}
+
+static CGFloat TUIRoundRectRadius(CGRect rect, CGFloat radius) // as CGContextAddRoundRect() rounds it
+{
+	radius = MIN(radius, rect.size.width / 2);
+	radius = MIN(radius, rect.size.height / 2);
+	return floor(radius);
+}
+
+void CGContextFillRoundRectWithColor(CGContextRef context, CGRect rect, CGFloat radius, CGColorRef color)
+{
+	radius = TUIRoundRectRadius(rect, radius);
+	CGFloat scale = TUIContextDeviceScale(context);
+	
+	if(scale > 0 && radius > 0) {
+		TUIShapeKey key;
+		TUIShapeKeyInit(&key, TUIShapeRoundRectFill, radius, scale);
+		size_t corner = (size_t)ceil(radius * scale);
+		size_t side = corner * 2 + 3; // a straight stretch of edge at the center
+		TUINineSlice *nineSlice = TUINineSliceForKey(TUIShapeKeyObject(&key, color, NULL), side, side, corner, corner, 1, 1, scale, 0, ^(CGContextRef ctx, CGRect bounds) {
+			CGContextSetFillColorWithColor(ctx, color);
+			CGContextFillRoundRect(ctx, bounds, corner);
+		});
+		if(TUINineSliceFits(nineSlice, rect)) {
+			TUINineSliceDraw(context, rect, nineSlice);
+			return;
+		}
+	}
+	
+	CGContextSaveGState(context);
+	CGContextSetFillColorWithColor(context, color);
+	CGContextFillRoundRect(context, rect, radius);
+	CGContextRestoreGState(context);
+}
+
+void CGContextFillRoundRectWithColorAndGlow(CGContextRef context, CGRect rect, CGFloat radius, CGColorRef color, CGFloat blur, CGColorRef glowColor)
+{
+	radius = TUIRoundRectRadius(rect, radius);
+	CGFloat scale = TUIContextDeviceScale(context);
+	
+	if(scale > 0 && radius > 0) {
+		TUIShapeKey key;
+		TUIShapeKeyInit(&key, TUIShapeRoundRectGlow, radius, scale);
+		key.blur = blur;
+		size_t corner = (size_t)ceil(radius * scale);
+		size_t pad = (size_t)ceil(blur * 2); // CG shadows are a gaussian with sigma ~= blur / 2
+		size_t cap = corner + pad;
+		// the center column is lit by the straight edge within 'pad' of it, as along any longer edge
+		size_t side = cap * 2 + 1 + pad * 2;
+		TUINineSlice *nineSlice = TUINineSliceForKey(TUIShapeKeyObject(&key, color, glowColor), side, side, cap, cap, 1, 1, scale, pad / scale, ^(CGContextRef ctx, CGRect bounds) {
+			CGContextSetFillColorWithColor(ctx, color);
+			CGContextSetShadowWithColor(ctx, CGSizeZero, blur, glowColor);
+			CGContextFillRoundRect(ctx, CGRectInset(bounds, pad, pad), corner);
+		});
+		if(TUINineSliceFits(nineSlice, rect)) {
+			TUINineSliceDraw(context, rect, nineSlice);
+			return;
+		}
+	}
+	
+	CGContextSaveGState(context);
+	CGContextSetFillColorWithColor(context, color);
+	CGContextSetShadowWithColor(context, CGSizeZero, blur, glowColor);
+	CGContextFillRoundRect(context, rect, radius);
+	CGContextRestoreGState(context);
+}
+
+void CGContextFillRoundRectWithVerticalGradient(CGContextRef context, CGRect rect, CGFloat radius, const CGFloat topColor[4], const CGFloat bottomColor[4])
+{
+	CGFloat components[8] = {topColor[0], topColor[1], topColor[2], topColor[3], bottomColor[0], bottomColor[1], bottomColor[2], bottomColor[3]};
+	radius = TUIRoundRectRadius(rect, radius);
+	CGFloat scale = TUIContextDeviceScale(context);
+	size_t height = (size_t)round(rect.size.height * scale);
+	
+	if(scale > 0 && radius > 0 && height > 0) {
+		TUIShapeKey key;
+		TUIShapeKeyInit(&key, TUIShapeRoundRectGradient, radius, scale);
+		key.height = height;
+		memcpy(key.colors, components, sizeof(components));
+		size_t corner = (size_t)ceil(radius * scale);
+		size_t width = corner * 2 + 3;
+		const CGFloat *stops = components; // blocks can't capture arrays, this one is called before returning
+		// only the columns stretch, the rows are the gradient
+		TUINineSlice *nineSlice = TUINineSliceForKey(TUIShapeKeyObject(&key, NULL, NULL), width, height, corner, 0, 1, height, scale, 0, ^(CGContextRef ctx, CGRect bounds) {
+			CGContextClipToRoundRect(ctx, bounds, corner);
+			CGGradientRef gradient = TUICreateCachedGradient(stops, NULL, 2);
+			CGContextDrawLinearGradient(ctx, gradient, CGPointMake(0, bounds.size.height), CGPointZero, 0);
+			CGGradientRelease(gradient);
+		});
+		if(TUINineSliceFits(nineSlice, rect)) {
+			TUINineSliceDraw(context, rect, nineSlice);
+			return;
+		}
+	}
+	
+	CGContextSaveGState(context);
+	CGContextClipToRoundRect(context, rect, radius);
+	CGGradientRef gradient = TUICreateCachedGradient(components, NULL, 2);
+	CGContextDrawLinearGradient(context, gradient, CGPointMake(0, CGRectGetMaxY(rect)), CGPointMake(0, CGRectGetMinY(rect)), 0);
+	CGGradientRelease(gradient);
+	CGContextRestoreGState(context);
+}
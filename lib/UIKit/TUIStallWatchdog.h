@@ -0,0 +1,90 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/*
+ What the main thread is doing inside TUIKit, recorded by cheap markers so a
+ stall can be attributed without sampling the main thread's stack.
+ */
+typedef enum {
+	TUIPhaseEvent,        // TUINSView dispatching an event
+	TUIPhaseLayout,       // -layoutSubviews
+	TUIPhaseDisplay,      // -displayLayer: / -drawRect:
+	TUIPhaseRowHeights,   // table view asking its delegate for row heights
+	TUIPhaseReloadData,   // -[TUITableView reloadData]
+	TUIPhaseImageDecode,  // -[TUIImage decodedImage]
+	TUIPhaseTextLayout,   // Core Text frame setup in TUITextRenderer
+} TUIPhase;
+
+@interface TUIStallReport : NSObject
+{
+	NSTimeInterval duration;
+	NSArray *phases;
+}
+
+@property (nonatomic, readonly) NSTimeInterval duration; // how long the main thread had been busy when the report was made
+
+/**
+ Active phases outermost first, e.g. "event", "layout TUITableView",
+ "row heights TUITableView (1200ms)", with the time spent in each so far.
+ */
+@property (nonatomic, readonly) NSArray *phases;
+
+@end
+
+/**
+ Opt-in watchdog that notices when the main thread hasn't come back to its
+ run loop (to wait, or to service the next source or timer) for longer than
+ a threshold, and reports which TUIKit phases were
+ active at the time. One report is made per stall, while it is happening.
+ 
+ Enable with -start, or launch with TUIStallWatchdog=1 in the environment.
+ */
+@interface TUIStallWatchdog : NSObject
+
++ (TUIStallWatchdog *)sharedWatchdog;
+
+@property (nonatomic, assign) NSTimeInterval threshold; // default 0.25s, set before -start
+
+/**
+ Called on the watchdog's queue. Default logs the report.
+ */
+@property (copy) void (^reportHandler)(TUIStallReport *report);
+
+@property (nonatomic, readonly, getter=isRunning) BOOL running;
+
+- (void)start; // main thread
+- (void)stop;
+
+@end
+
+/*
+ Phase markers. Only main thread phases are recorded; Begin and End must pair.
+ */
+extern BOOL TUIStallWatchdogRunning;
+extern void _TUIPhaseBegin(TUIPhase phase, id object);
+extern void _TUIPhaseEnd(void);
+
+static inline void TUIPhaseBegin(TUIPhase phase, id object) // 'object' names the class doing the work, may be nil
+{
+	if(TUIStallWatchdogRunning) _TUIPhaseBegin(phase, object);
+}
+
+static inline void TUIPhaseEnd(void)
+{
+	if(TUIStallWatchdogRunning) _TUIPhaseEnd();
+}
@@ -0,0 +1,241 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIStallWatchdog.h"
+#import "TUIKit.h"
+#import <objc/runtime.h>
+#import <pthread.h>
+
+#define TUIPhaseMaxDepth 32
+
+typedef struct {
+	TUIPhase phase;
+	const char *className; // class names live as long as the class
+	CFAbsoluteTime start;
+} TUIPhaseRecord;
+
+BOOL TUIStallWatchdogRunning = NO;
+
+// written by the main thread only, read racily by the watchdog; a torn read costs at worst one wrong line in a report
+static TUIPhaseRecord TUIPhaseStack[TUIPhaseMaxDepth];
+static volatile NSUInteger TUIPhaseDepth = 0;
+
+// main thread run loop state
+static volatile CFAbsoluteTime TUIStallBusySince = 0.0; // last time the run loop got control back, 0 while waiting for events
+static volatile NSUInteger TUIStallBusyGeneration = 0; // bumped every time the run loop gets control back
+
+static NSString *TUIPhaseName(TUIPhase phase)
+{
+	switch(phase) {
+		case TUIPhaseEvent: return @"event";
+		case TUIPhaseLayout: return @"layout";
+		case TUIPhaseDisplay: return @"display";
+		case TUIPhaseRowHeights: return @"row heights";
+		case TUIPhaseReloadData: return @"reload data";
+		case TUIPhaseImageDecode: return @"image decode";
+		case TUIPhaseTextLayout: return @"text layout";
+	}
+	return @"?";
+}
+
+void _TUIPhaseBegin(TUIPhase phase, id object)
+{
+	if(!pthread_main_np())
+		return;
+	NSUInteger depth = TUIPhaseDepth;
+	if(depth < TUIPhaseMaxDepth) {
+		TUIPhaseStack[depth].phase = phase;
+		TUIPhaseStack[depth].className = object ? object_getClassName(object) : NULL;
+		TUIPhaseStack[depth].start = CFAbsoluteTimeGetCurrent();
+	}
+	TUIPhaseDepth = depth + 1; // published after the record
+}
+
+void _TUIPhaseEnd(void)
+{
+	if(!pthread_main_np())
+		return;
+	if(TUIPhaseDepth > 0) // the watchdog may have started mid-phase
+		TUIPhaseDepth--;
+}
+
+static void TUIStallWatchdogRunLoopObserver(CFRunLoopObserverRef observer, CFRunLoopActivity activity, void *info)
+{
+	if(activity == kCFRunLoopBeforeWaiting) {
+		TUIStallBusySince = 0.0;
+	} else {
+		TUIStallBusyGeneration++;
+		TUIStallBusySince = CFAbsoluteTimeGetCurrent();
+	}
+}
+
+@interface TUIStallReport ()
+- (id)initWithDuration:(NSTimeInterval)d phases:(NSArray *)p;
+@end
+
+@implementation TUIStallReport
+
+@synthesize duration;
+@synthesize phases;
+
+- (id)initWithDuration:(NSTimeInterval)d phases:(NSArray *)p
+{
+	if((self = [super init])) {
+		duration = d;
+		phases = p;
+	}
+	return self;
+}
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"main thread busy for %.0fms in: %@", duration * 1000.0, [phases count] ? [phases componentsJoinedByString:@" > "] : @"(no TUIKit phase)"];
+}
+
+@end
+
+@interface TUIStallWatchdog ()
+{
+	NSTimeInterval _threshold;
+	CFRunLoopObserverRef _observer;
+	dispatch_queue_t _queue;
+	dispatch_source_t _timer;
+	NSUInteger _reportedGeneration;
+}
+- (void)_check;
+@end
+
+@implementation TUIStallWatchdog
+
+@synthesize reportHandler;
+
++ (TUIStallWatchdog *)sharedWatchdog
+{
+	static TUIStallWatchdog *sharedWatchdog = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		sharedWatchdog = [[TUIStallWatchdog alloc] init];
+	});
+	return sharedWatchdog;
+}
+
++ (void)load
+{
+	if(TUIEnvironmentFlag(@"TUIStallWatchdog"))
+		[[self sharedWatchdog] start];
+}
+
+- (id)init
+{
+	if((self = [super init])) {
+		_threshold = 0.25;
+		_queue = dispatch_queue_create("com.twitter.TUIStallWatchdog", NULL);
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	[self stop];
+	dispatch_release(_queue);
+}
+
+- (NSTimeInterval)threshold
+{
+	return _threshold;
+}
+
+- (void)setThreshold:(NSTimeInterval)t
+{
+	_threshold = t;
+}
+
+- (BOOL)isRunning
+{
+	return _timer != NULL;
+}
+
+- (void)start
+{
+	if(self.running)
+		return;
+	
+	TUIPhaseDepth = 0;
+	TUIStallBusySince = CFAbsoluteTimeGetCurrent(); // we're on the main thread, and it's busy
+	TUIStallBusyGeneration++;
+	
+	_observer = CFRunLoopObserverCreate(NULL, kCFRunLoopAllActivities, true, 0, TUIStallWatchdogRunLoopObserver, NULL);
+	CFRunLoopAddObserver(CFRunLoopGetMain(), _observer, kCFRunLoopCommonModes);
+	
+	_timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _queue);
+	uint64_t interval = (uint64_t)(_threshold / 4.0 * NSEC_PER_SEC);
+	dispatch_source_set_timer(_timer, dispatch_time(DISPATCH_TIME_NOW, interval), interval, interval / 4);
+	__unsafe_unretained TUIStallWatchdog *weakSelf = self; // the timer is cancelled in -stop
+	dispatch_source_set_event_handler(_timer, ^{
+		[weakSelf _check];
+	});
+	dispatch_resume(_timer);
+	
+	TUIStallWatchdogRunning = YES;
+}
+
+- (void)stop
+{
+	if(!self.running)
+		return;
+	
+	TUIStallWatchdogRunning = NO;
+	
+	CFRunLoopObserverInvalidate(_observer);
+	CFRelease(_observer);
+	_observer = NULL;
+	
+	dispatch_source_cancel(_timer);
+	dispatch_release(_timer);
+	_timer = NULL;
+}
+
+- (void)_check // on _queue
+{
+	CFAbsoluteTime busySince = TUIStallBusySince;
+	NSUInteger generation = TUIStallBusyGeneration;
+	if(busySince == 0.0 || generation == _reportedGeneration)
+		return;
+	
+	CFAbsoluteTime now = CFAbsoluteTimeGetCurrent();
+	if(now - busySince < _threshold)
+		return;
+	_reportedGeneration = generation;
+	
+	NSUInteger depth = MIN(TUIPhaseDepth, (NSUInteger)TUIPhaseMaxDepth);
+	NSMutableArray *phases = [NSMutableArray arrayWithCapacity:depth];
+	for(NSUInteger i = 0; i < depth; ++i) {
+		TUIPhaseRecord r = TUIPhaseStack[i];
+		NSString *name = TUIPhaseName(r.phase);
+		if(r.className)
+			name = [name stringByAppendingFormat:@" %s", r.className];
+		[phases addObject:[name stringByAppendingFormat:@" (%.0fms)", (now - r.start) * 1000.0]];
+	}
+	
+	TUIStallReport *report = [[TUIStallReport alloc] initWithDuration:now - busySince phases:phases];
+	void (^handler)(TUIStallReport *) = self.reportHandler;
+	if(handler)
+		handler(report);
+	else
+		NSLog(@"TUIStallWatchdog: %@", report);
+}
+
+@end
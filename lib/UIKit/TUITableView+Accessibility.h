@@ -0,0 +1,51 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUITableView.h"
+
+/**
+ Stands in for a row of a TUITableView in the accessibility hierarchy,
+ whether or not the row has a cell. Two elements for the same row of the
+ same table are equal.
+ */
+@interface TUITableViewAccessibilityElement : NSObject
+{
+	TUITableView *_tableView; // strong, assistive apps may hold elements longer than the table lives
+	TUIFastIndexPath *_indexPath;
+}
+
+- (id)initWithTableView:(TUITableView *)tableView indexPath:(TUIFastIndexPath *)indexPath;
+
+@property (nonatomic, readonly) TUITableView *tableView;
+@property (nonatomic, readonly) TUIFastIndexPath *indexPath;
+
+@end
+
+/**
+ The table is exposed as an accessibility table whose rows are one
+ TUITableViewAccessibilityElement per row, in every section, created on
+ demand. Assistive apps can read any range of rows and their frames without
+ cells being created; a cell is only created when a row is scrolled to,
+ focused or pressed.
+ 
+ Only rows are children, so hit testing the table header, section headers
+ or the pull down view returns the table itself.
+ */
+@interface TUITableView (Accessibility)
+
+- (TUITableViewAccessibilityElement *)accessibilityElementForRowAtIndexPath:(TUIFastIndexPath *)indexPath;
+
+@end
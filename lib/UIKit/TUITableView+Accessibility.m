@@ -0,0 +1,374 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUITableView+Accessibility.h"
+#import "TUITableViewCell.h"
+#import "TUIView+Accessibility.h"
+#import "TUIView+Private.h"
+
+#define TUIAccessibilityScrollToVisibleAction @"AXScrollToVisible" // NSAccessibilityScrollToVisibleAction, 10.9+
+
+/**
+ All rows of a table, elements created as they are asked for.
+ */
+@interface TUITableViewAccessibilityRows : NSArray
+{
+	TUITableView *_tableView;
+	NSUInteger _count;
+}
+- (id)initWithTableView:(TUITableView *)tableView;
+@end
+
+@implementation TUITableViewAccessibilityRows
+
+- (id)initWithTableView:(TUITableView *)tableView
+{
+	if((self = [super init])) {
+		_tableView = tableView;
+		_count = [tableView numberOfRows];
+	}
+	return self;
+}
+
+- (NSUInteger)count
+{
+	return _count;
+}
+
+- (id)objectAtIndex:(NSUInteger)index
+{
+	if(index >= _count)
+		[NSException raise:NSRangeException format:@"index %lu beyond bounds [0 .. %lu]", (unsigned long)index, (unsigned long)_count];
+	return [_tableView accessibilityElementForRowAtIndexPath:[_tableView indexPathForRowAtIndex:index]];
+}
+
+@end
+
+@implementation TUITableViewAccessibilityElement
+
+@synthesize tableView = _tableView;
+@synthesize indexPath = _indexPath;
+
+- (id)initWithTableView:(TUITableView *)tableView indexPath:(TUIFastIndexPath *)indexPath
+{
+	if((self = [super init])) {
+		_tableView = tableView;
+		_indexPath = indexPath;
+	}
+	return self;
+}
+
+- (BOOL)isEqual:(id)object
+{
+	if(![object isKindOfClass:[TUITableViewAccessibilityElement class]])
+		return NO;
+	TUITableViewAccessibilityElement *e = object;
+	return e->_tableView == _tableView && [e->_indexPath isEqual:_indexPath];
+}
+
+- (NSUInteger)hash
+{
+	return [_indexPath hash] ^ (NSUInteger)(__bridge void *)_tableView;
+}
+
+- (BOOL)_isValid
+{
+	return [_tableView indexOfRowAtIndexPath:_indexPath] != NSNotFound; // rows go away on reload
+}
+
+- (TUITableViewCell *)_cell
+{
+	return [_tableView cellForRowAtIndexPath:_indexPath];
+}
+
+- (CGRect)_screenFrame
+{
+	// offset from the table's own (cached) screen frame, no walk up the hierarchy per row
+	CGRect tableFrame = [_tableView accessibilityFrame];
+	CGRect r = [_tableView rectForRowAtIndexPath:_indexPath];
+	CGRect b = _tableView.bounds;
+	r.origin.x += tableFrame.origin.x - b.origin.x;
+	r.origin.y += tableFrame.origin.y - b.origin.y;
+	return r;
+}
+
+- (void)_scrollToVisible
+{
+	[_tableView scrollToRowAtIndexPath:_indexPath atScrollPosition:TUITableViewScrollPositionToVisible animated:NO];
+	[_tableView layoutIfNeeded]; // so the cell exists for the next query
+}
+
+- (BOOL)accessibilityIsIgnored
+{
+	return NO;
+}
+
+- (NSArray *)accessibilityAttributeNames
+{
+	static NSArray *attributes = nil;
+	if(attributes == nil) {
+		attributes = [[NSArray alloc] initWithObjects:NSAccessibilityRoleAttribute, NSAccessibilityRoleDescriptionAttribute, NSAccessibilityFocusedAttribute, NSAccessibilityChildrenAttribute, NSAccessibilityParentAttribute, NSAccessibilityWindowAttribute, NSAccessibilityTopLevelUIElementAttribute, NSAccessibilityPositionAttribute, NSAccessibilitySizeAttribute, NSAccessibilityDescriptionAttribute, NSAccessibilityValueAttribute, NSAccessibilityTitleAttribute, NSAccessibilityEnabledAttribute, NSAccessibilitySelectedAttribute, NSAccessibilityIndexAttribute, nil];
+	}
+	return attributes;
+}
+
+- (id)accessibilityAttributeValue:(NSString *)attribute
+{
+	if(![self _isValid])
+		return nil;
+	
+	TUITableViewCell *cell = [self _cell];
+	if([attribute isEqualToString:NSAccessibilityRoleAttribute]) {
+		return NSAccessibilityRowRole;
+	} else if([attribute isEqualToString:NSAccessibilityRoleDescriptionAttribute]) {
+		return NSAccessibilityRoleDescriptionForUIElement(self);
+	} else if([attribute isEqualToString:NSAccessibilityFocusedAttribute]) {
+		id focusedElement = [NSApp accessibilityAttributeValue:NSAccessibilityFocusedUIElementAttribute];
+		return [NSNumber numberWithBool:[focusedElement isEqual:self]];
+	} else if([attribute isEqualToString:NSAccessibilityParentAttribute]) {
+		return NSAccessibilityUnignoredAncestor(_tableView);
+	} else if([attribute isEqualToString:NSAccessibilityWindowAttribute]) {
+		return [_tableView accessibilityAttributeValue:NSAccessibilityWindowAttribute];
+	} else if([attribute isEqualToString:NSAccessibilityTopLevelUIElementAttribute]) {
+		return [_tableView accessibilityAttributeValue:NSAccessibilityTopLevelUIElementAttribute];
+	} else if([attribute isEqualToString:NSAccessibilityPositionAttribute]) {
+		return [NSValue valueWithPoint:[self _screenFrame].origin];
+	} else if([attribute isEqualToString:NSAccessibilitySizeAttribute]) {
+		return [NSValue valueWithSize:[self _screenFrame].size];
+	} else if([attribute isEqualToString:NSAccessibilityChildrenAttribute]) {
+		return cell ? [cell _accessibilityChildren] : [NSArray array];
+	} else if([attribute isEqualToString:NSAccessibilityDescriptionAttribute]) {
+		return cell.accessibilityHint;
+	} else if([attribute isEqualToString:NSAccessibilityValueAttribute]) {
+		return cell.accessibilityValue;
+	} else if([attribute isEqualToString:NSAccessibilityTitleAttribute]) {
+		if(cell)
+			return cell.accessibilityLabel;
+		id<TUITableViewDataSource> dataSource = _tableView.dataSource;
+		if([dataSource respondsToSelector:@selector(tableView:accessibilityLabelForRowAtIndexPath:)])
+			return [dataSource tableView:_tableView accessibilityLabelForRowAtIndexPath:_indexPath];
+		return nil;
+	} else if([attribute isEqualToString:NSAccessibilityEnabledAttribute]) {
+		return [NSNumber numberWithBool:_tableView.userInteractionEnabled];
+	} else if([attribute isEqualToString:NSAccessibilitySelectedAttribute]) {
+		return [NSNumber numberWithBool:[[_tableView indexPathForSelectedRow] isEqual:_indexPath]];
+	} else if([attribute isEqualToString:NSAccessibilityIndexAttribute]) {
+		return [NSNumber numberWithUnsignedInteger:[_tableView indexOfRowAtIndexPath:_indexPath]];
+	} else {
+		return nil;
+	}
+}
+
+- (BOOL)accessibilityIsAttributeSettable:(NSString *)attribute
+{
+	return [attribute isEqualToString:NSAccessibilityFocusedAttribute] || [attribute isEqualToString:NSAccessibilitySelectedAttribute];
+}
+
+- (void)accessibilitySetValue:(id)value forAttribute:(NSString *)attribute
+{
+	if(![self _isValid])
+		return;
+	
+	if([attribute isEqualToString:NSAccessibilityFocusedAttribute]) {
+		if([value boolValue])
+			[self _scrollToVisible];
+	} else if([attribute isEqualToString:NSAccessibilitySelectedAttribute]) {
+		if([value boolValue])
+			[_tableView selectRowAtIndexPath:_indexPath animated:NO scrollPosition:TUITableViewScrollPositionToVisible];
+		else if([[_tableView indexPathForSelectedRow] isEqual:_indexPath])
+			[_tableView deselectRowAtIndexPath:_indexPath animated:NO];
+	}
+}
+
+- (NSArray *)accessibilityActionNames
+{
+	return [NSArray arrayWithObjects:NSAccessibilityPressAction, TUIAccessibilityScrollToVisibleAction, nil];
+}
+
+- (NSString *)accessibilityActionDescription:(NSString *)action
+{
+	return NSAccessibilityActionDescription(action);
+}
+
+- (void)accessibilityPerformAction:(NSString *)action
+{
+	if(![self _isValid])
+		return;
+	
+	if([action isEqualToString:NSAccessibilityPressAction]) {
+		[_tableView selectRowAtIndexPath:_indexPath animated:NO scrollPosition:TUITableViewScrollPositionToVisible];
+	} else if([action isEqualToString:TUIAccessibilityScrollToVisibleAction]) {
+		[self _scrollToVisible];
+	}
+}
+
+- (id)accessibilityHitTest:(NSPoint)point
+{
+	return self;
+}
+
+- (id)accessibilityFocusedUIElement
+{
+	return self;
+}
+
+@end
+
+@implementation TUITableView (Accessibility)
+
+- (TUITableViewAccessibilityElement *)accessibilityElementForRowAtIndexPath:(TUIFastIndexPath *)indexPath
+{
+	if(!indexPath)
+		return nil;
+	return [[TUITableViewAccessibilityElement alloc] initWithTableView:self indexPath:indexPath];
+}
+
+- (NSArray *)_accessibilityElementsForIndexPaths:(NSArray *)indexPaths
+{
+	NSMutableArray *elements = [NSMutableArray arrayWithCapacity:[indexPaths count]];
+	for(TUIFastIndexPath *indexPath in indexPaths)
+		[elements addObject:[self accessibilityElementForRowAtIndexPath:indexPath]];
+	return elements;
+}
+
+- (BOOL)_isAccessibilityRowsAttribute:(NSString *)attribute
+{
+	return [attribute isEqualToString:NSAccessibilityRowsAttribute] || [attribute isEqualToString:NSAccessibilityChildrenAttribute];
+}
+
+- (NSArray *)accessibilityAttributeNames
+{
+	static NSArray *attributes = nil;
+	if(attributes == nil) {
+		NSMutableArray *a = [[super accessibilityAttributeNames] mutableCopy];
+		[a addObjectsFromArray:[NSArray arrayWithObjects:NSAccessibilityRowsAttribute, NSAccessibilityVisibleRowsAttribute, NSAccessibilitySelectedRowsAttribute, NSAccessibilityVisibleChildrenAttribute, NSAccessibilityColumnsAttribute, nil]];
+		attributes = [a copy];
+	}
+	return attributes;
+}
+
+- (id)accessibilityAttributeValue:(NSString *)attribute
+{
+	if([attribute isEqualToString:NSAccessibilityRoleAttribute]) {
+		return NSAccessibilityTableRole;
+	} else if([self _isAccessibilityRowsAttribute:attribute]) {
+		return [[TUITableViewAccessibilityRows alloc] initWithTableView:self];
+	} else if([attribute isEqualToString:NSAccessibilityVisibleRowsAttribute] || [attribute isEqualToString:NSAccessibilityVisibleChildrenAttribute]) {
+		return [self _accessibilityElementsForIndexPaths:[[self indexPathsForVisibleRows] sortedArrayUsingSelector:@selector(compare:)]];
+	} else if([attribute isEqualToString:NSAccessibilitySelectedRowsAttribute]) {
+		TUIFastIndexPath *selected = [self indexPathForSelectedRow];
+		return selected ? [NSArray arrayWithObject:[self accessibilityElementForRowAtIndexPath:selected]] : [NSArray array];
+	} else if([attribute isEqualToString:NSAccessibilityColumnsAttribute]) {
+		return [NSArray array];
+	}
+	return [super accessibilityAttributeValue:attribute];
+}
+
+/*
+ Assistive apps read long arrays in ranges, answer those without building the whole array.
+ */
+
+- (NSUInteger)accessibilityArrayAttributeCount:(NSString *)attribute
+{
+	if([self _isAccessibilityRowsAttribute:attribute])
+		return [self numberOfRows];
+	return [super accessibilityArrayAttributeCount:attribute];
+}
+
+- (NSArray *)accessibilityArrayAttributeValues:(NSString *)attribute index:(NSUInteger)index maxCount:(NSUInteger)maxCount
+{
+	if([self _isAccessibilityRowsAttribute:attribute]) {
+		NSUInteger count = [self numberOfRows];
+		if(index >= count)
+			return [NSArray array];
+		NSUInteger n = MIN(maxCount, count - index);
+		NSMutableArray *elements = [NSMutableArray arrayWithCapacity:n];
+		for(NSUInteger i = 0; i < n; ++i)
+			[elements addObject:[self accessibilityElementForRowAtIndexPath:[self indexPathForRowAtIndex:index + i]]];
+		return elements;
+	}
+	return [super accessibilityArrayAttributeValues:attribute index:index maxCount:maxCount];
+}
+
+- (NSUInteger)accessibilityIndexOfChild:(id)child
+{
+	if([child isKindOfClass:[TUITableViewAccessibilityElement class]] && [child tableView] == self)
+		return [self indexOfRowAtIndexPath:[child indexPath]];
+	return [super accessibilityIndexOfChild:child];
+}
+
+- (id)accessibilityHitTest:(NSPoint)point
+{
+	id hit = [super accessibilityHitTest:point];
+	TUIView *view = [hit isKindOfClass:[TUITextRenderer class]] ? [hit view] : hit;
+	if(![view isKindOfClass:[TUIView class]] || view == self)
+		return hit;
+	
+	// the table's children are its rows, so only what's inside a row can be hit. Headers, the pull
+	// down view and the scroll knobs aren't children, report the table rather than an orphan
+	TUIView *subview = view;
+	while(subview.superview && subview.superview != self)
+		subview = subview.superview;
+	if(subview.superview != self || ![subview isKindOfClass:[TUITableViewCell class]])
+		return self;
+	
+	// a cell itself stands for its row, views inside it are reported as they are
+	if(hit == subview) {
+		TUIFastIndexPath *indexPath = [self indexPathForCell:hit];
+		if(indexPath)
+			return [self accessibilityElementForRowAtIndexPath:indexPath];
+	}
+	return hit;
+}
+
+@end
+
+@implementation TUITableViewCell (Accessibility)
+
+/*
+ While a cell is in its table the row element stands in for it: the cell is
+ ignored and reports the row as its parent, so views inside the cell walk up
+ to the same element the table lists and hit tests return.
+ */
+
+- (TUIFastIndexPath *)_accessibilityIndexPath
+{
+	if(![self.superview isKindOfClass:[TUITableView class]])
+		return nil;
+	return self.indexPath; // nil once the cell is enqueued for reuse
+}
+
+- (TUITableViewAccessibilityElement *)_accessibilityRowElement
+{
+	return [self.tableView accessibilityElementForRowAtIndexPath:[self _accessibilityIndexPath]];
+}
+
+- (BOOL)accessibilityIsIgnored
+{
+	return [self _accessibilityIndexPath] != nil;
+}
+
+- (id)accessibilityAttributeValue:(NSString *)attribute
+{
+	if([attribute isEqualToString:NSAccessibilityParentAttribute]) {
+		TUITableViewAccessibilityElement *row = [self _accessibilityRowElement];
+		if(row)
+			return row;
+	}
+	return [super accessibilityAttributeValue:attribute];
+}
+
+@end
@@ -0,0 +1,35 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUITableView.h"
+
+@class TUIDisplayListRecorder;
+
+@interface TUITableView (Export)
+
+/**
+ Append every section header and row, top to bottom, to 'recorder'. Cells
+ come from the data source one at a time and go back to the reuse queue
+ once recorded, so memory doesn't grow with the number of rows.
+ */
+- (void)appendRowsToDisplayListRecorder:(TUIDisplayListRecorder *)recorder;
+
+/**
+ Paginated PDF of all rows, streamed to 'url'. Main thread.
+ */
+- (void)writePDFOfAllRowsToURL:(NSURL *)url pageSize:(CGSize)pageSize;
+
+@end
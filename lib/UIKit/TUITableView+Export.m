@@ -0,0 +1,66 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUITableView+Export.h"
+#import "TUIDisplayList.h"
+#import "TUIKit.h"
+
+@interface TUITableView ()
+- (void)_enqueueReusableCell:(TUITableViewCell *)cell;
+@end
+
+@implementation TUITableView (Export)
+
+- (void)appendRowsToDisplayListRecorder:(TUIDisplayListRecorder *)recorder
+{
+	NSInteger sections = [self numberOfSections];
+	for(NSInteger section = 0; section < sections; ++section) {
+		@autoreleasepool {
+			TUIView *header = [self headerViewForSection:section];
+			if(header)
+				[recorder appendView:header];
+		}
+		
+		NSInteger rows = [self numberOfRowsInSection:section];
+		for(NSInteger row = 0; row < rows; ++row) {
+			@autoreleasepool {
+				TUIFastIndexPath *indexPath = [TUIFastIndexPath indexPathForRow:row inSection:section];
+				TUITableViewCell *visible = [self cellForRowAtIndexPath:indexPath];
+				TUITableViewCell *cell = visible ? visible : [self.dataSource tableView:self cellForRowAtIndexPath:indexPath];
+				if(!cell)
+					continue;
+				
+				if(!visible) {
+					CGRect r = [self rectForRowAtIndexPath:indexPath];
+					cell.frame = CGRectMake(0, 0, r.size.width, r.size.height);
+					[cell layoutSubviews];
+				}
+				[recorder appendView:cell];
+				if(!visible)
+					[self _enqueueReusableCell:cell];
+			}
+		}
+	}
+}
+
+- (void)writePDFOfAllRowsToURL:(NSURL *)url pageSize:(CGSize)pageSize
+{
+	TUIDisplayListRecorder *recorder = [[TUIDisplayListRecorder alloc] initWithURL:url pageSize:pageSize];
+	[self appendRowsToDisplayListRecorder:recorder];
+	[recorder finish];
+}
+
+@end
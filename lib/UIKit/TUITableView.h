@@ -16,6 +16,7 @@
 
 #import "TUIScrollView.h"
 #import "TUIFastIndexPath.h"
+#import "TUIFrameClock.h"
 
 typedef enum {
 	TUITableViewStylePlain,              // regular table view
@@ -64,7 +65,7 @@ typedef enum {
 
 @end
 
-@interface TUITableView : TUIScrollView
+@interface TUITableView : TUIScrollView <TUIFrameClockObserver>
 {
 	TUITableViewStyle             _style;
 	__unsafe_unretained id <TUITableViewDataSource>	_dataSource; // weak
@@ -95,6 +96,12 @@ typedef enum {
   TUIFastIndexPath            * _previousDragToReorderIndexPath;
   TUITableViewInsertionMethod   _previousDragToReorderInsertionMethod;
   
+	// keyboard navigation
+	TUIFastIndexPath            * _pendingKeySelection; // net result of key repeats since the last frame
+	TUIFastIndexPath            * _lastNotifiedSelection; // what the delegate last heard while notifications are deferred
+	NSTimeInterval                _lastKeySelectionTime;
+	NSTimeInterval                _keyRepeatSelectionNotificationDelay;
+	
 	struct {
 		unsigned int animateSelectionChanges:1;
 		unsigned int forceSaveScrollPosition:1;
@@ -104,6 +111,9 @@ typedef enum {
 		unsigned int dataSourceNumberOfSectionsInTableView:1;
 		unsigned int delegateTableViewWillDisplayCellForRowAtIndexPath:1;
 		unsigned int maintainContentOffsetAfterReload:1;
+		unsigned int keySelectionThisFrame:1;
+		unsigned int selectionNotificationDeferred:1;
+		unsigned int observingFrameClock:1;
 	} _tableFlags;
 	
 }
@@ -116,6 +126,16 @@ typedef enum {
 @property (readwrite, assign) BOOL                        animateSelectionChanges;
 @property (nonatomic, assign) BOOL maintainContentOffsetAfterReload;
 
+/**
+ Up/down arrows move the selection a row, with option a page and with
+ command to the first/last row. Repeats arriving faster than the display
+ refreshes are merged, so the selection, scroll and layout change at most
+ once per frame. While a key repeats the delegate's did(De)SelectRow
+ notifications are held back until no move happened for this long, then
+ sent once for the net change. Default is 0.1s, 0 notifies on every move.
+ */
+@property (nonatomic, assign) NSTimeInterval keyRepeatSelectionNotificationDelay;
+
 - (void)reloadData;
 
 /**
@@ -128,6 +148,13 @@ typedef enum {
 
 - (NSInteger)numberOfSections;
 - (NSInteger)numberOfRowsInSection:(NSInteger)section;
+- (NSInteger)numberOfRows; // in all sections
+
+/**
+ Rows numbered across all sections, in order. Both are O(log sections).
+ */
+- (TUIFastIndexPath *)indexPathForRowAtIndex:(NSUInteger)index; // nil if out of range
+- (NSUInteger)indexOfRowAtIndexPath:(TUIFastIndexPath *)indexPath; // NSNotFound if out of range
 
 - (CGRect)rectForHeaderOfSection:(NSInteger)section;
 - (CGRect)rectForSection:(NSInteger)section;
@@ -189,6 +216,12 @@ typedef enum {
 
 - (TUIView *)tableView:(TUITableView *)tableView headerViewForSection:(NSInteger)section;
 
+/**
+ Rows that aren't on screen have no cell, their accessibility elements are
+ labelled with this. Visible rows use their cell's accessibilityLabel.
+ */
+- (NSString *)tableView:(TUITableView *)tableView accessibilityLabelForRowAtIndexPath:(TUIFastIndexPath *)indexPath;
+
 // the following are required to support row reordering
 - (BOOL)tableView:(TUITableView *)tableView canMoveRowAtIndexPath:(TUIFastIndexPath *)indexPath;
 - (void)tableView:(TUITableView *)tableView moveRowAtIndexPath:(TUIFastIndexPath *)fromIndexPath toIndexPath:(TUIFastIndexPath *)toIndexPath;
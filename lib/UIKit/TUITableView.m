@@ -18,6 +18,8 @@
 #import "TUITableView+Cell.h"
 #import "TUITableViewSectionHeader.h"
 #import "TUINSView.h"
+#import "TUIStallWatchdog.h"
+#import "TUIViewProfiler.h"
 
 // header views need to be above the cells at all times
 #define HEADER_Z_POSITION 1000 
@@ -35,11 +37,13 @@ typedef struct {
 	NSUInteger            numberOfRows;
 	CGFloat               sectionHeight;
 	CGFloat               sectionOffset;
+	NSUInteger            rowIndexOffset; // index of the first row counting across all sections
 	TUITableViewRowInfo  *rowInfo;
 }
 
 @property (strong, readonly) TUIView           *headerView;
 @property (nonatomic, assign) CGFloat   sectionOffset;
+@property (nonatomic, assign) NSUInteger rowIndexOffset;
 @property (readonly) NSInteger          sectionIndex;
 
 @end
@@ -47,6 +51,7 @@ typedef struct {
 @implementation TUITableViewSection
 
 @synthesize sectionOffset;
+@synthesize rowIndexOffset;
 @synthesize sectionIndex;
 
 - (id)initWithNumberOfRows:(NSUInteger)n sectionIndex:(NSInteger)s tableView:(TUITableView *)t
@@ -72,6 +77,7 @@ typedef struct {
 
 - (void)_setupRowHeights
 {
+	TUIPhaseBegin(TUIPhaseRowHeights, _tableView);
 	sectionHeight = 0.0;
 	
 	TUIView *header;
@@ -85,7 +91,7 @@ typedef struct {
 		rowInfo[i].height = h;
 		sectionHeight += h;
 	}
-	
+	TUIPhaseEnd();
 }
 
 - (CGFloat)rowHeight:(NSInteger)i
@@ -109,6 +115,29 @@ typedef struct {
 	return sectionOffset + [self sectionRowOffset:i];
 }
 
+/**
+ * @brief Row containing an offset from the beginning of the section
+ * 
+ * Rows are sorted by offset, so this is a binary search. A row contains
+ * both of its edges, the first row wins on a shared edge.
+ * 
+ * @return row index, or -1 if no row contains @p offset
+ */
+- (NSInteger)rowAtSectionOffset:(CGFloat)offset
+{
+	NSUInteger lo = 0, hi = numberOfRows;
+	while(lo < hi) { // first row ending at or after offset
+		NSUInteger mid = (lo + hi) / 2;
+		if(rowInfo[mid].offset + rowInfo[mid].height < offset)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if(lo < numberOfRows && rowInfo[lo].offset <= offset)
+		return lo;
+	return -1;
+}
+
 - (CGFloat)sectionHeight
 {
 	return sectionHeight;
@@ -144,6 +173,9 @@ typedef struct {
 @interface TUITableView (Private)
 - (void)_updateSectionInfo;
 - (void)_updateDerepeaterViews;
+- (void)_flushKeySelection;
+- (void)_selectRowAtIndexPath:(TUIFastIndexPath *)indexPath animated:(BOOL)animated scrollPosition:(TUITableViewScrollPosition)scrollPosition notify:(BOOL)notify;
+- (void)_deselectRowAtIndexPath:(TUIFastIndexPath *)indexPath animated:(BOOL)animated notify:(BOOL)notify;
 @end
 
 @implementation TUITableView
@@ -159,10 +191,17 @@ typedef struct {
 		_visibleSectionHeaders = [[NSMutableIndexSet alloc] init];
 		_visibleItems = [[NSMutableDictionary alloc] init];
 		_tableFlags.animateSelectionChanges = 1;
+		_keyRepeatSelectionNotificationDelay = 0.1;
 	}
 	return self;
 }
 
+- (void)dealloc
+{
+	if(_tableFlags.observingFrameClock)
+		[[TUIFrameClock sharedClock] removeObserver:self];
+}
+
 - (id)initWithFrame:(CGRect)frame
 {
 	return [self initWithFrame:frame style:TUITableViewStylePlain];
@@ -211,6 +250,42 @@ typedef struct {
 	return [[_sectionInfo objectAtIndex:section] numberOfRows];
 }
 
+- (NSInteger)numberOfRows
+{
+	TUITableViewSection *last = [_sectionInfo lastObject];
+	return [last rowIndexOffset] + [last numberOfRows];
+}
+
+- (TUIFastIndexPath *)indexPathForRowAtIndex:(NSUInteger)index
+{
+	NSUInteger lo = 0, hi = [_sectionInfo count];
+	while(lo < hi) { // first section ending after index
+		NSUInteger mid = (lo + hi) / 2;
+		TUITableViewSection *s = [_sectionInfo objectAtIndex:mid];
+		if([s rowIndexOffset] + [s numberOfRows] <= index)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if(lo >= [_sectionInfo count])
+		return nil;
+	TUITableViewSection *s = [_sectionInfo objectAtIndex:lo];
+	return [TUIFastIndexPath indexPathForRow:index - [s rowIndexOffset] inSection:lo];
+}
+
+- (NSUInteger)indexOfRowAtIndexPath:(TUIFastIndexPath *)indexPath
+{
+	if(!indexPath)
+		return NSNotFound;
+	NSInteger section = indexPath.section;
+	if(section < 0 || section >= [_sectionInfo count])
+		return NSNotFound;
+	TUITableViewSection *s = [_sectionInfo objectAtIndex:section];
+	if(indexPath.row >= [s numberOfRows])
+		return NSNotFound;
+	return [s rowIndexOffset] + indexPath.row;
+}
+
 - (CGRect)rectForHeaderOfSection:(NSInteger)section {
 	if(section >= 0 && section < [_sectionInfo count]){
 		TUITableViewSection *s = [_sectionInfo objectAtIndex:section];
@@ -254,6 +329,7 @@ typedef struct {
  * The previous section info is released and new section info is created.
  */
 - (void)_updateSectionInfo {
+	uint64_t profileTime = TUIProfileBegin();
   
   if(_sectionInfo != nil){
     
@@ -279,17 +355,21 @@ typedef struct {
 	NSMutableArray *sections = [[NSMutableArray alloc] initWithCapacity:numberOfSections];
 	
 	CGFloat offset = [_headerView bounds].size.height - self.contentInset.top*2;
+	NSUInteger rowIndex = 0;
 	for(int s = 0; s < numberOfSections; ++s) {
 		TUITableViewSection *section = [[TUITableViewSection alloc] initWithNumberOfRows:[_dataSource tableView:self numberOfRowsInSection:s] sectionIndex:s tableView:self];
 		[section _setupRowHeights];
 		section.sectionOffset = offset;
+		section.rowIndexOffset = rowIndex;
 		offset += [section sectionHeight];
+		rowIndex += [section numberOfRows];
 		[sections addObject:section];
 	}
 	
 	_contentHeight = offset - self.contentInset.bottom;
 	_sectionInfo = sections;
 	
+	TUIProfileEnd(TUIProfileTableUpdateSectionInfo, self, profileTime);
 }
 
 - (void)_enqueueReusableCell:(TUITableViewCell *)cell
@@ -478,18 +558,29 @@ static NSInteger SortCells(TUITableViewCell *a, TUITableViewCell *b, void *ctx)
  * @return index path of the row at @p offset
  */
 - (TUIFastIndexPath *)indexPathForRowAtVerticalOffset:(CGFloat)offset {
-  
-	NSInteger sectionIndex = 0;
-  for(TUITableViewSection *section in _sectionInfo){
-    for(NSInteger row = 0; row < [section numberOfRows]; row++){
-      TUIFastIndexPath *indexPath = [TUIFastIndexPath indexPathForRow:row inSection:sectionIndex];
-      CGRect cellRect = [self rectForRowAtIndexPath:indexPath];
-      if(offset >= cellRect.origin.y && offset <= (cellRect.origin.y + cellRect.size.height)){
-        return indexPath;
-      }
-    }
-		++sectionIndex;
-  }
+	
+	// rows are laid out top down from the end of the content, sections and rows are sorted by that distance
+	CGFloat tableOffset = _contentHeight - offset;
+	
+	NSUInteger lo = 0, hi = [_sectionInfo count];
+	while(lo < hi) { // first section ending at or after tableOffset
+		NSUInteger mid = (lo + hi) / 2;
+		TUITableViewSection *s = [_sectionInfo objectAtIndex:mid];
+		if([s sectionOffset] + [s sectionHeight] < tableOffset)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	
+	// a shared edge or empty sections may leave the row in a later section
+	for(NSUInteger sectionIndex = lo; sectionIndex < [_sectionInfo count]; ++sectionIndex) {
+		TUITableViewSection *s = [_sectionInfo objectAtIndex:sectionIndex];
+		if([s sectionOffset] > tableOffset)
+			break;
+		NSInteger row = [s rowAtSectionOffset:tableOffset - [s sectionOffset]];
+		if(row >= 0)
+			return [TUIFastIndexPath indexPathForRow:row inSection:sectionIndex];
+	}
 	
 	return nil;
 }
@@ -785,6 +876,7 @@ static NSInteger SortCells(TUITableViewCell *a, TUITableViewCell *b, void *ctx)
 
 - (void)_layoutCells:(BOOL)visibleCellsNeedRelayout
 {
+	uint64_t profileTime = TUIProfileBegin();
   
 	if(visibleCellsNeedRelayout) {
 		// update remaining visible cells if needed
@@ -900,6 +992,8 @@ static NSInteger SortCells(TUITableViewCell *a, TUITableViewCell *b, void *ctx)
 			}
 		}
 	}
+	
+	TUIProfileEnd(TUIProfileTableLayoutCells, self, profileTime);
 }
 
 - (BOOL)pullDownViewIsVisible
@@ -922,6 +1016,7 @@ static NSInteger SortCells(TUITableViewCell *a, TUITableViewCell *b, void *ctx)
 
 - (void)reloadData
 {
+	TUIPhaseBegin(TUIPhaseReloadData, self);
   
   // notify our delegate we're about to reload the table
   if(self.delegate != nil && [self.delegate respondsToSelector:@selector(tableViewWillReloadData:)]){
@@ -929,6 +1024,9 @@ static NSInteger SortCells(TUITableViewCell *a, TUITableViewCell *b, void *ctx)
   }
 	
 	_selectedIndexPath = nil;
+	_pendingKeySelection = nil; // index paths may not survive the reload
+	_lastNotifiedSelection = nil;
+	_tableFlags.selectionNotificationDeferred = 0;
   
 	// need to recycle all visible cells, have them be regenerated on layoutSubviews
 	// because the same cells might have different content
@@ -964,6 +1062,7 @@ static NSInteger SortCells(TUITableViewCell *a, TUITableViewCell *b, void *ctx)
     [self.delegate tableViewDidReloadData:self];
   }
   
+	TUIPhaseEnd();
 }
 
 - (void)layoutSubviews
@@ -1063,12 +1162,18 @@ static NSInteger SortCells(TUITableViewCell *a, TUITableViewCell *b, void *ctx)
 }
 
 - (void)selectRowAtIndexPath:(TUIFastIndexPath *)indexPath animated:(BOOL)animated scrollPosition:(TUITableViewScrollPosition)scrollPosition
+{
+	[self _flushKeySelection]; // keep notifications in order
+	[self _selectRowAtIndexPath:indexPath animated:animated scrollPosition:scrollPosition notify:YES];
+}
+
+- (void)_selectRowAtIndexPath:(TUIFastIndexPath *)indexPath animated:(BOOL)animated scrollPosition:(TUITableViewScrollPosition)scrollPosition notify:(BOOL)notify
 {
 	TUIFastIndexPath *oldIndexPath = [self indexPathForSelectedRow];
 //	if([indexPath isEqual:oldIndexPath]) {
 //		// just scroll to visible
 //	} else {
-		[self deselectRowAtIndexPath:[self indexPathForSelectedRow] animated:animated];
+		[self _deselectRowAtIndexPath:[self indexPathForSelectedRow] animated:animated notify:notify];
 		
 		TUITableViewCell *cell = [self cellForRowAtIndexPath:indexPath]; // may be nil
 		[cell setSelected:YES animated:animated];
@@ -1077,7 +1182,7 @@ static NSInteger SortCells(TUITableViewCell *a, TUITableViewCell *b, void *ctx)
 		[cell setNeedsDisplay];
 		
 		// only notify when the selection actually changes
-		if([self.delegate respondsToSelector:@selector(tableView:didSelectRowAtIndexPath:)]){
+		if(notify && [self.delegate respondsToSelector:@selector(tableView:didSelectRowAtIndexPath:)]){
 			[self.delegate tableView:self didSelectRowAtIndexPath:indexPath];
 		}
 //	}
@@ -1091,6 +1196,12 @@ static NSInteger SortCells(TUITableViewCell *a, TUITableViewCell *b, void *ctx)
 }
 
 - (void)deselectRowAtIndexPath:(TUIFastIndexPath *)indexPath animated:(BOOL)animated
+{
+	[self _flushKeySelection];
+	[self _deselectRowAtIndexPath:indexPath animated:animated notify:YES];
+}
+
+- (void)_deselectRowAtIndexPath:(TUIFastIndexPath *)indexPath animated:(BOOL)animated notify:(BOOL)notify
 {
   
 	if([indexPath isEqual:_selectedIndexPath]) {
@@ -1101,7 +1212,7 @@ static NSInteger SortCells(TUITableViewCell *a, TUITableViewCell *b, void *ctx)
 		[cell setNeedsDisplay];
 		
 		// only notify when the selection actually changes
-    if([self.delegate respondsToSelector:@selector(tableView:didDeselectRowAtIndexPath:)]){
+    if(notify && [self.delegate respondsToSelector:@selector(tableView:didDeselectRowAtIndexPath:)]){
       [self.delegate tableView:self didDeselectRowAtIndexPath:indexPath];
     }
     
@@ -1131,87 +1242,214 @@ static NSInteger SortCells(TUITableViewCell *a, TUITableViewCell *b, void *ctx)
 	return lastIndexPath;
 }
 
-- (BOOL)performKeyAction:(NSEvent *)event
+/*
+ * Keyboard navigation
+ */
+
+- (NSTimeInterval)keyRepeatSelectionNotificationDelay
 {
-	// no selection or selected cell not visible and this is not repeative key press
-	BOOL noCurrentSelection = (_selectedIndexPath == nil || ([self cellForRowAtIndexPath:_selectedIndexPath] == nil && ![event isARepeat]));;
-	
-	typedef TUIFastIndexPath * (^TUITableViewCalculateNextIndexPathBlock)(TUIFastIndexPath *lastIndexPath);
-	void (^selectValidIndexPath)(TUIFastIndexPath *startForNoSelection, TUITableViewCalculateNextIndexPathBlock calculateNextIndexPath) = ^(TUIFastIndexPath *startForNoSelection, TUITableViewCalculateNextIndexPathBlock calculateNextIndexPath) {
-		NSParameterAssert(calculateNextIndexPath != nil);
-		
-		BOOL foundValidNextRow = NO;
-		TUIFastIndexPath *lastIndexPath = _selectedIndexPath;
-		while(!foundValidNextRow) {
-			TUIFastIndexPath *newIndexPath;
-			if(noCurrentSelection && lastIndexPath == nil) {
-				newIndexPath = startForNoSelection;
-			} else {
-				newIndexPath = calculateNextIndexPath(lastIndexPath);
-			}
-			
-			if(![_delegate respondsToSelector:@selector(tableView:shouldSelectRowAtIndexPath:forEvent:)] || [_delegate tableView:self shouldSelectRowAtIndexPath:newIndexPath forEvent:event]){
-				[self selectRowAtIndexPath:newIndexPath animated:self.animateSelectionChanges scrollPosition:TUITableViewScrollPositionToVisible];
-				foundValidNextRow = YES;
-			}
-			
-			if([lastIndexPath isEqual:newIndexPath]) foundValidNextRow = YES;
-			
-			lastIndexPath = newIndexPath;
+	return _keyRepeatSelectionNotificationDelay;
+}
+
+- (void)setKeyRepeatSelectionNotificationDelay:(NSTimeInterval)d
+{
+	_keyRepeatSelectionNotificationDelay = d;
+}
+
+- (void)_setObservingFrameClock:(BOOL)observe
+{
+	if(observe && !_tableFlags.observingFrameClock)
+		[[TUIFrameClock sharedClock] addObserver:self];
+	else if(!observe && _tableFlags.observingFrameClock)
+		[[TUIFrameClock sharedClock] removeObserver:self];
+	_tableFlags.observingFrameClock = observe;
+}
+
+/**
+ * @brief First row from @p index, stepping by @p step, the delegate lets us select
+ * 
+ * @return index path, or nil if every row up to the end of the table was refused
+ */
+- (TUIFastIndexPath *)_selectableIndexPathFromRowIndex:(NSInteger)index step:(NSInteger)step forEvent:(NSEvent *)event
+{
+	NSInteger count = [self numberOfRows];
+	BOOL ask = [_delegate respondsToSelector:@selector(tableView:shouldSelectRowAtIndexPath:forEvent:)];
+	for(; index >= 0 && index < count; index += step) {
+		TUIFastIndexPath *indexPath = [self indexPathForRowAtIndex:index];
+		if(!ask || [_delegate tableView:self shouldSelectRowAtIndexPath:indexPath forEvent:event])
+			return indexPath;
+	}
+	return nil;
+}
+
+/**
+ * @brief Index of the first row whose bottom edge is at or below @p offset
+ * 
+ * Rows get lower as their index grows, so this is a binary search.
+ */
+- (NSUInteger)_rowIndexAtOrBelowVerticalOffset:(CGFloat)offset
+{
+	NSUInteger lo = 0, hi = [self numberOfRows];
+	while(lo < hi) {
+		NSUInteger mid = (lo + hi) / 2;
+		if([self rectForRowAtIndexPath:[self indexPathForRowAtIndex:mid]].origin.y > offset)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/**
+ * @brief Where a navigation key moves the selection from @p current
+ * 
+ * Arrows move a row, page up/down a screenful and home/end to the first or last row.
+ * 
+ * @return the new selection, @p current if it can't move, nil if nothing is selectable
+ */
+- (TUIFastIndexPath *)_indexPathForNavigationKey:(unichar)key from:(TUIFastIndexPath *)current forEvent:(NSEvent *)event
+{
+	NSInteger count = [self numberOfRows];
+	NSUInteger currentIndex = [self indexOfRowAtIndexPath:current];
+	if(currentIndex == NSNotFound) {
+		// no selection, or it went away: start from the visible rows
+		switch(key) {
+			case NSUpArrowFunctionKey:
+				currentIndex = [self indexOfRowAtIndexPath:[self indexPathForLastVisibleRow]];
+				if(currentIndex != NSNotFound)
+					return [self _selectableIndexPathFromRowIndex:currentIndex step:-1 forEvent:event];
+				break;
+			case NSDownArrowFunctionKey:
+				currentIndex = [self indexOfRowAtIndexPath:[self indexPathForFirstVisibleRow]];
+				if(currentIndex != NSNotFound)
+					return [self _selectableIndexPathFromRowIndex:currentIndex step:1 forEvent:event];
+				break;
 		}
-	};
+	}
 	
-	switch([[event charactersIgnoringModifiers] characterAtIndex:0]) {
-		case NSUpArrowFunctionKey: {
-			selectValidIndexPath([self indexPathForLastVisibleRow], ^(TUIFastIndexPath *lastIndexPath) {
-				NSUInteger section = lastIndexPath.section;
-				NSUInteger row = lastIndexPath.row;
-				if(row > 0) {
-					row--;
-				} else {
-					while(section > 0) {
-						section--;
-						NSUInteger rowsInSection = [self numberOfRowsInSection:section];
-						if(rowsInSection > 0) {
-							row = rowsInSection - 1;
-							break;
-						}
-					}
-				}
-				
-				return [TUIFastIndexPath indexPathForRow:row inSection:section];
-			});
-			
-			return YES;
+	NSInteger index;
+	NSInteger step;
+	switch(key) {
+		case NSUpArrowFunctionKey:
+			index = (currentIndex == NSNotFound) ? count - 1 : (NSInteger)currentIndex - 1;
+			step = -1;
+			break;
+		case NSDownArrowFunctionKey:
+			index = (currentIndex == NSNotFound) ? 0 : (NSInteger)currentIndex + 1;
+			step = 1;
+			break;
+		case NSPageUpFunctionKey:
+		case NSPageDownFunctionKey: {
+			CGFloat page = self.bounds.size.height;
+			CGFloat y = (currentIndex == NSNotFound) ? CGRectGetMidY(self.visibleRect) : CGRectGetMidY([self rectForRowAtIndexPath:current]);
+			step = (key == NSPageDownFunctionKey) ? 1 : -1;
+			y -= step * page;
+			index = MIN((NSInteger)[self _rowIndexAtOrBelowVerticalOffset:y], count - 1);
+			break;
 		}
+		case NSHomeFunctionKey:
+			index = 0;
+			step = 1;
+			break;
+		case NSEndFunctionKey:
+			index = count - 1;
+			step = -1;
+			break;
+		default:
+			return nil;
+	}
 	
-		case NSDownArrowFunctionKey:  {
-			selectValidIndexPath([self indexPathForFirstVisibleRow], ^(TUIFastIndexPath *lastIndexPath) {
-				NSUInteger section = lastIndexPath.section;
-				NSUInteger row = lastIndexPath.row;
-				NSUInteger rowsInSection = [self numberOfRowsInSection:section];
-				if(row + 1 < rowsInSection) {
-					row++;
-				} else {
-					NSUInteger sections = [self numberOfSections];
-					while(section + 1 < sections) {
-						section++;
-						NSUInteger rowsInSection = [self numberOfRowsInSection:section];
-						if(rowsInSection > 0) {
-							row = 0;
-							break;
-						}
-					}
-				}
-				
-				return [TUIFastIndexPath indexPathForRow:row inSection:section];
-			});
+	TUIFastIndexPath *indexPath = [self _selectableIndexPathFromRowIndex:index step:step forEvent:event];
+	return indexPath ? indexPath : current; // nowhere to go, stay put (and scroll back to it)
+}
 
-			return YES;
-		}
+- (void)_notifyDeferredSelection
+{
+	if(!_tableFlags.selectionNotificationDeferred)
+		return;
+	_tableFlags.selectionNotificationDeferred = 0;
+	
+	TUIFastIndexPath *old = _lastNotifiedSelection;
+	_lastNotifiedSelection = nil;
+	if([old isEqual:_selectedIndexPath])
+		return;
+	if(old && [self.delegate respondsToSelector:@selector(tableView:didDeselectRowAtIndexPath:)])
+		[self.delegate tableView:self didDeselectRowAtIndexPath:old];
+	if(_selectedIndexPath && [self.delegate respondsToSelector:@selector(tableView:didSelectRowAtIndexPath:)])
+		[self.delegate tableView:self didSelectRowAtIndexPath:_selectedIndexPath];
+}
+
+- (void)_applyKeySelection:(TUIFastIndexPath *)indexPath repeat:(BOOL)repeat
+{
+	_pendingKeySelection = nil; // superseded, a later tick mustn't move back to it
+	
+	BOOL defer = repeat && _keyRepeatSelectionNotificationDelay > 0.0;
+	if(defer && !_tableFlags.selectionNotificationDeferred) {
+		_tableFlags.selectionNotificationDeferred = 1;
+		_lastNotifiedSelection = _selectedIndexPath;
+	} else if(!defer) {
+		[self _notifyDeferredSelection];
+	}
+	
+	[self _selectRowAtIndexPath:indexPath animated:(!repeat && self.animateSelectionChanges) scrollPosition:TUITableViewScrollPositionToVisible notify:!defer];
+	_lastKeySelectionTime = [NSDate timeIntervalSinceReferenceDate];
+	_tableFlags.keySelectionThisFrame = 1;
+	[self _setObservingFrameClock:YES];
+}
+
+- (void)_flushKeySelection
+{
+	if(_pendingKeySelection) {
+		TUIFastIndexPath *indexPath = _pendingKeySelection;
+		[self _applyKeySelection:indexPath repeat:YES];
+	}
+	[self _notifyDeferredSelection];
+}
+
+- (void)frameClockDidTick:(NSTimeInterval)timestamp
+{
+	if(_pendingKeySelection) {
+		TUIFastIndexPath *indexPath = _pendingKeySelection; // held across the call, which clears the ivar
+		[self _applyKeySelection:indexPath repeat:YES];
+		return;
 	}
 	
-	return [super performKeyAction:event];
+	_tableFlags.keySelectionThisFrame = 0;
+	if(_tableFlags.selectionNotificationDeferred && [NSDate timeIntervalSinceReferenceDate] - _lastKeySelectionTime >= _keyRepeatSelectionNotificationDelay)
+		[self _notifyDeferredSelection];
+	if(!_tableFlags.selectionNotificationDeferred)
+		[self _setObservingFrameClock:NO];
+}
+
+- (BOOL)performKeyAction:(NSEvent *)event
+{
+	NSString *characters = [event charactersIgnoringModifiers];
+	unichar key = [characters length] ? [characters characterAtIndex:0] : 0;
+	if(key != NSUpArrowFunctionKey && key != NSDownArrowFunctionKey)
+		return [super performKeyAction:event]; // page up/down, home and end scroll without selecting
+	
+	BOOL up = (key == NSUpArrowFunctionKey);
+	if([event modifierFlags] & NSCommandKeyMask)
+		key = up ? NSHomeFunctionKey : NSEndFunctionKey; // first/last row
+	else if([event modifierFlags] & NSAlternateKeyMask)
+		key = up ? NSPageUpFunctionKey : NSPageDownFunctionKey; // a page of rows
+	
+	BOOL repeat = [event isARepeat];
+	TUIFastIndexPath *current = _pendingKeySelection ? _pendingKeySelection : _selectedIndexPath;
+	if(!repeat && !_pendingKeySelection && ![self cellForRowAtIndexPath:current])
+		current = nil; // selection scrolled away, start again from what's visible
+	
+	TUIFastIndexPath *indexPath = [self _indexPathForNavigationKey:key from:current forEvent:event];
+	if(!indexPath)
+		return YES; // nothing selectable
+	
+	if(repeat && _tableFlags.keySelectionThisFrame) {
+		// already moved this frame, the next tick applies the net result
+		_pendingKeySelection = indexPath;
+	} else {
+		[self _applyKeySelection:indexPath repeat:repeat]; // a key down can arrive after repeats this frame, this drops their pending target
+	}
+	return YES;
 }
 
 - (BOOL)maintainContentOffsetAfterReload
@@ -20,6 +20,8 @@
 #import "CoreText+Additions.h"
 #import "TUIKit.h"
 
+#define TUITextRendererMaxDragImageSize 512.0 // points, larger selections are scaled down
+
 @interface TUITextRenderer()
 - (CTFramesetterRef)ctFramesetter;
 - (CTFrameRef)ctFrame;
@@ -83,18 +85,90 @@
 	return nil;
 }
 
-- (TUIImage *)dragImageForSelection:(NSRange)selection
+// last line starting at or before 'index', lines are in string order
+static CFIndex TUILineIndexForStringIndex(NSArray *lines, CFIndex index)
+{
+	CFIndex lo = 0, hi = (CFIndex)[lines count] - 1;
+	while(lo < hi) {
+		CFIndex mid = (lo + hi + 1) / 2;
+		if(CTLineGetStringRange((__bridge CTLineRef)[lines objectAtIndex:mid]).location <= index)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	return lo;
+}
+
+/**
+ Only the lines the selection touches are measured and drawn, clipped to the
+ selection's bounding rect and scaled down to TUITextRendererMaxDragImageSize,
+ so the cost doesn't depend on the length of the text. 'imageRect' is where
+ the image should appear, in the view's coordinates.
+ */
+- (TUIImage *)dragImageForSelection:(NSRange)selection imageRect:(CGRect *)imageRect
 {
-	CGRect b = self.view.frame;
+	CTFrameRef f = [self ctFrame];
+	if(!f || selection.length == 0)
+		return nil;
+	NSArray *lines = (__bridge NSArray *)CTFrameGetLines(f);
+	if([lines count] == 0)
+		return nil;
+	
+	CFIndex firstLine = TUILineIndexForStringIndex(lines, selection.location);
+	CFIndex lastLine = TUILineIndexForStringIndex(lines, selection.location + selection.length - 1);
+	
+	// one extra line either side, line heights are measured from the neighbours
+	CFIndex first = MAX(firstLine - 1, 0);
+	CFIndex count = MIN(lastLine + 1, (CFIndex)[lines count] - 1) - first + 1;
+	NSArray *nearbyLines = [lines subarrayWithRange:NSMakeRange(first, count)];
+	CGPoint origins[count];
+	CTFrameGetLineOrigins(f, CFRangeMake(first, count), origins);
+	CGRect pathBounds = CGPathGetBoundingBox(CTFrameGetPath(f));
+	
+	CFIndex rectCount = 100;
+	CGRect rects[rectCount];
+	AB_CTLinesGetRectsForRangeWithAggregationType(nearbyLines, origins, pathBounds, CFRangeMake(selection.location, selection.length), AB_CTLineRectAggregationTypeInline, rects, &rectCount);
 	
-	_flags.drawMaskDragSelection = 1;
-	TUIImage *image = TUIGraphicsDrawAsImage(b.size, ^{
-		[self draw];
-	});
-	_flags.drawMaskDragSelection = 0;
+	CGRect b = CGRectNull;
+	for(CFIndex i = 0; i < rectCount; ++i)
+		b = CGRectUnion(b, rects[i]);
+	b = CGRectIntersection(CGRectIntegral(b), self.view.bounds);
+	if(CGRectIsEmpty(b))
+		return nil;
+	
+	CGFloat scale = MIN(1.0, TUITextRendererMaxDragImageSize / MAX(b.size.width, b.size.height));
+	CGSize size = CGSizeMake(ceil(b.size.width * scale), ceil(b.size.height * scale));
+	CGContextRef ctx = TUICreateGraphicsContext(size);
+	if(!ctx)
+		return nil;
+	
+	CGContextScaleCTM(ctx, scale, scale);
+	CGContextTranslateCTM(ctx, -b.origin.x, -b.origin.y);
+	CGContextClipToRects(ctx, rects, rectCount);
+	CGContextSetTextMatrix(ctx, CGAffineTransformIdentity);
+	if(shadowColor)
+		CGContextSetShadowWithColor(ctx, shadowOffset, shadowBlur, shadowColor.CGColor);
+	for(CFIndex i = firstLine; i <= lastLine; ++i) {
+		CGPoint o = origins[i - first];
+		CGContextSetTextPosition(ctx, pathBounds.origin.x + o.x, pathBounds.origin.y + o.y);
+		CTLineDraw((__bridge CTLineRef)[lines objectAtIndex:i], ctx);
+	}
+	
+	CGImageRef cgImage = CGBitmapContextCreateImage(ctx);
+	CGContextRelease(ctx);
+	TUIImage *image = [TUIImage imageWithCGImage:cgImage];
+	CGImageRelease(cgImage);
+	
+	if(imageRect)
+		*imageRect = ABRectCenteredInRect(CGRectMake(0, 0, size.width, size.height), b);
 	return image;
 }
 
+- (TUIImage *)dragImageForSelection:(NSRange)selection
+{
+	return [self dragImageForSelection:selection imageRect:NULL];
+}
+
 - (BOOL)beginWaitForDragInRange:(NSRange)range string:(NSString *)string
 {
 	CFAbsoluteTime downTime = CFAbsoluteTimeGetCurrent();
@@ -109,18 +183,15 @@
 		[pasteboard writeObjects:[NSArray arrayWithObject:string]];
 		NSRect f = [view frameInNSView];
 		
-		CFIndex saveStart = _selectionStart;
-		CFIndex saveEnd = _selectionEnd;
-		_selectionStart = range.location;
-		_selectionEnd = range.location + range.length;
-		TUIImage *dragImage = [self dragImageForSelection:range];
-		_selectionStart = saveStart;
-		_selectionEnd = saveEnd;
+		CGRect imageRect;
+		TUIImage *dragImage = [self dragImageForSelection:range imageRect:&imageRect];
+		if(!dragImage)
+			return NO;
 		
 		NSImage *image = [[NSImage alloc] initWithCGImage:dragImage.CGImage size:NSZeroSize];
 		
 		[view.nsView dragImage:image 
-							at:f.origin
+							at:NSMakePoint(f.origin.x + imageRect.origin.x, f.origin.y + imageRect.origin.y)
 						offset:NSZeroSize
 						 event:nextEvent 
 					pasteboard:pasteboard 
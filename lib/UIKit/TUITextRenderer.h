@@ -65,7 +65,6 @@ typedef enum {
 	TUITextVerticalAlignment verticalAlignment;
 	
 	struct {
-		unsigned int drawMaskDragSelection:1;
 		unsigned int backgroundDrawingEnabled:1;
 		unsigned int preDrawBlocksEnabled:1;
 		
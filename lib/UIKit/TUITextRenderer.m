@@ -20,6 +20,7 @@
 #import "TUIColor.h"
 #import "TUIKit.h"
 #import "CoreText+Additions.h"
+#import "TUIStallWatchdog.h"
 
 @interface TUITextRenderer ()
 @property (nonatomic, retain) NSMutableDictionary *lineRects;
@@ -100,11 +101,13 @@
 
 - (void)_buildFramesetter
 {
+	TUIPhaseBegin(TUIPhaseTextLayout, self.view);
 	if(!_ct_framesetter) {
 		_ct_framesetter = CTFramesetterCreateWithAttributedString((__bridge CFAttributedStringRef)attributedString);
 	}
 	
 	[self _buildFrame];
+	TUIPhaseEnd();
 }
 
 - (CTFramesetterRef)ctFramesetter
@@ -218,7 +221,7 @@
 		
 		CTFrameRef f = [self ctFrame];
 		
-		if(_flags.preDrawBlocksEnabled && !_flags.drawMaskDragSelection) {
+		if(_flags.preDrawBlocksEnabled) {
 			[self.attributedString enumerateAttribute:TUIAttributedStringPreDrawBlockName inRange:NSMakeRange(0, [self.attributedString length]) options:0 usingBlock:^(id value, NSRange range, BOOL *stop) {
 				if(value == NULL) return;
 				
@@ -240,7 +243,7 @@
 			}];
 		}
 		
-		if(_flags.backgroundDrawingEnabled && !_flags.drawMaskDragSelection) {
+		if(_flags.backgroundDrawingEnabled) {
 			CGContextSaveGState(context);
 			
 			[self.attributedString enumerateAttribute:TUIAttributedStringBackgroundColorAttributeName inRange:NSMakeRange(0, [self.attributedString length]) options:0 usingBlock:^(id value, NSRange range, BOOL *stop) {
@@ -270,7 +273,7 @@
 			CGContextRestoreGState(context);
 		}
 		
-		if(hitRange && !_flags.drawMaskDragSelection) {
+		if(hitRange) {
 			// draw highlight
 			CGContextSaveGState(context);
 			
@@ -284,10 +287,8 @@
 				rect = CGRectInset(rect, -2, -1);
 				rect.size.height -= 1;
 				rect = CGRectIntegral(rect);
-				TUIColor *color = [TUIColor colorWithWhite:1.0 alpha:1.0];
-				[color set];
-				CGContextSetShadowWithColor(context, CGSizeMake(0, 0), 8, color.CGColor);
-				CGContextFillRoundRect(context, rect, 10);
+				CGColorRef white = CGColorGetConstantColor(kCGColorWhite);
+				CGContextFillRoundRectWithColorAndGlow(context, rect, 10, white, 8, white);
 			}
 			
 			CGContextRestoreGState(context);
@@ -296,15 +297,11 @@
 		CFRange selectedRange = [self _selectedRange];
 		if(selectedRange.length > 0) {
 			[[NSColor selectedTextBackgroundColor] set];
-			// draw (or mask) selection
+			// draw selection
 			CFIndex rectCount = 100;
 			CGRect rects[rectCount];
 			AB_CTFrameGetRectsForRange(f, selectedRange, rects, &rectCount);
-			if(_flags.drawMaskDragSelection) {
-				CGContextClipToRects(context, rects, rectCount);
-			} else {
-				[self drawSelectionWithRects:rects count:rectCount];
-			}
+			[self drawSelectionWithRects:rects count:rectCount];
 		}
 		
 		CGContextSetTextMatrix(context, CGAffineTransformIdentity);
@@ -7,6 +7,8 @@
 //
 
 #import "TUIView+Accessibility.h"
+#import "TUIView+Private.h"
+#import "TUINSView.h"
 
 
 @implementation TUIView (Accessibility)
@@ -18,7 +20,10 @@
 
 - (void)setIsAccessibilityElement:(BOOL)isElement
 {
+	if(isElement == isAccessibilityElement) return;
+	
 	isAccessibilityElement = isElement;
+	[self.superview _invalidateAccessibilityChildren];
 }
 
 - (NSString *)accessibilityLabel
@@ -71,8 +76,15 @@
 {
 	// nothing set so use the view's frame converted to screen coordinates
 	if(CGRectEqualToRect(accessibilityFrame, CGRectNull)) {
-		CGRect frame = self.frame;
-		frame.origin = [[(NSView *) self.nsView window] convertBaseToScreen:[self frameInNSView].origin];
+		// -frameInNSView walks to the root, only redo it when something moved. The window may move without telling us, that conversion is cheap.
+		NSUInteger generation = [self.nsView _accessibilityGeometryGeneration];
+		if(!generation || _accessibilityGeometryGeneration != generation) {
+			_accessibilityNSViewFrame = self.frame;
+			_accessibilityNSViewFrame.origin = [self frameInNSView].origin;
+			_accessibilityGeometryGeneration = generation;
+		}
+		CGRect frame = _accessibilityNSViewFrame;
+		frame.origin = [[(NSView *) self.nsView window] convertBaseToScreen:frame.origin];
 		return frame;
 	} else {
 		return accessibilityFrame;
@@ -98,7 +110,15 @@
 			return textRenderer;
 		}
 		
-		NSArray *s = [self sortedSubviews];
+		// -sortedSubviews allocates and sorts, and z ordering is almost never used
+		NSArray *s = self.subviews;
+		CGFloat z = [s count] ? [[s objectAtIndex:0] layer].zPosition : 0.0;
+		for(TUIView *v in s) {
+			if(v.layer.zPosition != z) {
+				s = [self sortedSubviews];
+				break;
+			}
+		}
 		for(TUIView *v in [s reverseObjectEnumerator]) {
 			TUIView *hit = [v accessibilityHitTest:[self convertPoint:point toView:v]];
 			if(hit)
@@ -145,7 +165,7 @@
     } else if([attribute isEqualToString:NSAccessibilitySizeAttribute]) {
 		return [NSValue valueWithSize:[self accessibilityFrame].size];
     } else if([attribute isEqualToString:NSAccessibilityChildrenAttribute]) {
-		return [self accessibleSubviews];
+		return [self _accessibilityChildren];
 	} else if([attribute isEqualToString:NSAccessibilityDescriptionAttribute]) {
 		return self.accessibilityHint;
 	} else if([attribute isEqualToString:NSAccessibilityValueAttribute]) {
@@ -207,6 +227,18 @@
 	return NSAccessibilityRoleDescriptionForUIElement(self);
 }
 
+- (void)_invalidateAccessibilityChildren
+{
+	_accessibilityChildren = nil;
+}
+
+- (NSArray *)_accessibilityChildren
+{
+	if(!_accessibilityChildren)
+		_accessibilityChildren = [self accessibleSubviews];
+	return _accessibilityChildren;
+}
+
 - (NSArray *)accessibleSubviews
 {
 	NSMutableArray *accessibleSubviews = [NSMutableArray array];
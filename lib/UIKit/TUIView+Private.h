@@ -25,4 +25,40 @@
 
 - (void)_updateLayerScaleFactor;
 
++ (NSUInteger)_displayCount; // number of displays so far, drawn or not, for counting frames that showed something
+
+/*
+ Every display goes through these, including ones that don't draw, so the
+ frame count, the stall watchdog, the profiler and the debug overlays see it.
+ */
+- (void)_willDisplayLayer;
+- (void)_didDisplayLayer;
+- (void)_setLayerContentsWithoutDrawing:(id)contents; // instead of drawing, between the two above
+
+- (void)_invalidateAccessibilityChildren;
+- (NSArray *)_accessibilityChildren; // -accessibleSubviews, cached until subviews, text renderers or isAccessibilityElement change
+
 @end
+
+/*
+ Each TUINSView bumps its generation whenever a view it hosts may have
+ moved, so cached accessibility frames are recomputed on their next query.
+ Other windows' caches stay valid.
+ */
+@interface TUINSView (TUIAccessibilityGeometry)
+- (NSUInteger)_accessibilityGeometryGeneration; // 0 until there's a root view
+- (void)_invalidateAccessibilityGeometry;
+@end
+
+static inline void TUIAccessibilityInvalidateGeometry(TUIView *view)
+{
+	[view.nsView _invalidateAccessibilityGeometry];
+}
+
+/*
+ Scroll and gesture latching in TUINSView: YES if an event should hit test
+ for a new target rather than go to the latched one. Only the event's own
+ phase starting (began or may begin) or a pause longer than the latch
+ timeout starts over; momentum after a scroll phase stays with its target.
+ */
+extern BOOL TUIEventShouldRelatch(BOOL latched, NSUInteger phase, NSTimeInterval timestamp, NSTimeInterval lastTimestamp);
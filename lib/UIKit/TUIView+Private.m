@@ -35,6 +35,7 @@
 	}
 	
 	_textRenderers = renderers;
+	[self _invalidateAccessibilityChildren];
 
 	for(TUITextRenderer *renderer in _textRenderers) {
 		[renderer setNextResponder:self];
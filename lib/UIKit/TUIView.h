@@ -130,6 +130,10 @@ extern CGRect(^TUIViewCenteredLayout)(TUIView*);
 	NSString *accessibilityValue;
 	TUIAccessibilityTraits accessibilityTraits;
 	CGRect accessibilityFrame;
+	NSArray *_accessibilityChildren; // cached -accessibleSubviews, nil when the hierarchy changed
+	CGRect _accessibilityNSViewFrame; // cached, valid while _accessibilityGeometryGeneration matches the TUINSView's
+	NSUInteger _accessibilityGeometryGeneration;
+	CGSize _accessibilityLayoutSize; // bounds size at the last layout pass, subviews autoresize when it changes
 	NSOperationQueue *drawQueue;
 }
 
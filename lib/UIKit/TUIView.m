@@ -17,6 +17,10 @@
 #import "TUIView.h"
 #import "TUIKit.h"
 #import "TUIView+Private.h"
+#import "TUIInputLatency.h"
+#import "TUIStallWatchdog.h"
+#import "TUIViewProfiler.h"
+#import "TUIDebugOverlay.h"
 #import "TUIViewController.h"
 
 NSString * const TUIViewWillMoveToWindowNotification = @"TUIViewWillMoveToWindowNotification";
@@ -261,7 +265,8 @@ CGRect(^TUIViewCenteredLayout)(TUIView*) = nil;
 		if(w != _context.lastWidth || 
 		   h != _context.lastHeight ||
 		   o != _context.lastOpaque ||
-		   fabs(currentScale - _context.lastContentsScale) > 0.1f) 
+		   fabs(currentScale - _context.lastContentsScale) > 0.1f ||
+		   CGBitmapContextGetColorSpace(_context.context) != TUIGetBackingColorSpace()) 
 		{
 			CGContextRelease(_context.context);
 			_context.context = NULL;
@@ -286,43 +291,78 @@ CGRect(^TUIViewCenteredLayout)(TUIView*) = nil;
 	return _context.context;
 }
 
-- (void)displayLayer:(CALayer *)layer
+static NSUInteger TUIViewDisplayCount = 0;
+
++ (NSUInteger)_displayCount
 {
+	return TUIViewDisplayCount;
+}
+
+/*
+ Bookkeeping around every display, whether it draws (-displayLayer: below) or
+ sets the layer's contents directly (TUIImageView): the frame count, the
+ watchdog phase and the delegate. Balanced by -_didDisplayLayer.
+ */
+- (void)_willDisplayLayer
+{
+	TUIViewDisplayCount++;
+	TUIPhaseBegin(TUIPhaseDisplay, self);
+	
 	if(_viewFlags.delegateWillDisplayLayer)
 		[_viewDelegate viewWillDisplayLayer:self];
+}
+
+- (void)_didDisplayLayer
+{
+	TUIPhaseEnd();
+}
+
+- (void)_setLayerContentsWithoutDrawing:(id)contents
+{
+	uint64_t profileTime = TUIProfileBegin();
+	uint64_t overlayTime = TUIDebugOverlayBeginDraw();
+	self.layer.contents = contents;
+	CGRect b = self.bounds;
+	CGFloat scale = [self.layer respondsToSelector:@selector(contentsScale)] ? self.layer.contentsScale : 1.0f;
+	TUIDebugOverlayEndDraw(overlayTime, self, NULL, b, b, scale); // no backing store to paint into, only the redraw flash shows
+	TUIProfileEnd(TUIProfileDisplayPublish, self, profileTime);
+}
+
+- (void)displayLayer:(CALayer *)layer
+{
+	[self _willDisplayLayer];
 	
 	typedef void (*DrawRectIMP)(id,SEL,CGRect);
 	SEL drawRectSEL = @selector(drawRect:);
 	DrawRectIMP drawRectIMP = (DrawRectIMP)[self methodForSelector:drawRectSEL];
 	DrawRectIMP dontCallThisBasicDrawRectIMP = (DrawRectIMP)[TUIView instanceMethodForSelector:drawRectSEL];
 
-#if 0
-#define CA_COLOR_OVERLAY_DEBUG \
-if(self.opaque) CGContextSetRGBFillColor(context, 0, 1, 0, 0.3); \
-else CGContextSetRGBFillColor(context, 1, 0, 0, 0.3); CGContextFillRect(context, b);
-#else
-#define CA_COLOR_OVERLAY_DEBUG
-#endif
-
 #define PRE_DRAW \
+	uint64_t profileTime = TUIProfileBegin(); \
 	CGRect b = self.bounds; \
 	CGContextRef context = [self _CGContext]; \
 	TUIGraphicsPushContext(context); \
+	profileTime = TUIProfileEnd(TUIProfileDisplaySetup, self, profileTime); \
 	if(_viewFlags.clearsContextBeforeDrawing) \
 		CGContextClearRect(context, b); \
 	CGFloat scale = [self.layer respondsToSelector:@selector(contentsScale)] ? self.layer.contentsScale : 1.0f; \
 	CGContextScaleCTM(context, scale, scale); \
 	CGContextSetAllowsAntialiasing(context, true); \
 	CGContextSetShouldAntialias(context, true); \
-	CGContextSetShouldSmoothFonts(context, !_viewFlags.disableSubpixelTextRendering);
+	CGContextSetShouldSmoothFonts(context, !_viewFlags.disableSubpixelTextRendering); \
+	profileTime = TUIProfileEnd(TUIProfileDisplayClear, self, profileTime); \
+	uint64_t overlayTime = TUIDebugOverlayBeginDraw();
 	
 #define POST_DRAW \
-	CA_COLOR_OVERLAY_DEBUG \
+	profileTime = TUIProfileEnd(TUIProfileDrawRect, self, profileTime); \
+	TUIDebugOverlayEndDraw(overlayTime, self, context, b, rectToDraw, scale); \
+	if(overlayTime && profileTime) profileTime = mach_absolute_time(); /* keep overlay painting out of the publish time */ \
 	TUIImage *image = TUIGraphicsGetImageFromCurrentImageContext(); \
 	layer.contents = (id)image.CGImage; \
 	CGContextScaleCTM(context, 1.0f / scale, 1.0f / scale); \
 	TUIGraphicsPopContext(); \
-	if(self.drawInBackground) [CATransaction flush];
+	if(self.drawInBackground) [CATransaction flush]; \
+	TUIProfileEnd(TUIProfileDisplayPublish, self, profileTime);
 
 	CGRect rectToDraw = self.bounds;
 	if(!CGRectEqualToRect(_context.dirtyRect, CGRectZero)) {
@@ -357,6 +397,8 @@ else CGContextSetRGBFillColor(context, 1, 0, 0, 0.3); CGContextFillRect(context,
 	} else {
 		drawBlock();
 	}
+	
+	[self _didDisplayLayer];
 }
 
 - (void)_blockLayout
@@ -377,8 +419,19 @@ else CGContextSetRGBFillColor(context, 1, 0, 0, 0.3); CGContextFillRect(context,
 
 - (void)layoutSublayersOfLayer:(CALayer *)layer
 {
+	// autoresizing moves sublayers without going through -setFrame:, but only when this view's size changed
+	CGSize size = self.layer.bounds.size;
+	if(!CGSizeEqualToSize(size, _accessibilityLayoutSize)) {
+		_accessibilityLayoutSize = size;
+		TUIAccessibilityInvalidateGeometry(self);
+	}
+	TUIPhaseBegin(TUIPhaseLayout, self);
+	uint64_t profileTime = TUIProfileBegin();
 	[self layoutSubviews];
+	profileTime = TUIProfileEnd(TUIProfileLayoutSubviews, self, profileTime);
 	[self _blockLayout];
+	TUIProfileEnd(TUIProfileBlockLayout, self, profileTime);
+	TUIPhaseEnd();
 }
 
 - (BOOL)drawInBackground
@@ -470,6 +523,9 @@ else CGContextSetRGBFillColor(context, 1, 0, 0, 0.3); CGContextFillRect(context,
 
 - (void)setFrame:(CGRect)f
 {
+	// layout passes set the same frames over and over, don't throw away cached geometry for them
+	if(!CGRectEqualToRect(f, self.layer.frame))
+		TUIAccessibilityInvalidateGeometry(self);
 	self.layer.frame = f;
 }
 
@@ -480,6 +536,8 @@ else CGContextSetRGBFillColor(context, 1, 0, 0, 0.3); CGContextFillRect(context,
 
 - (void)setBounds:(CGRect)b
 {
+	if(!CGRectEqualToRect(b, self.layer.bounds))
+		TUIAccessibilityInvalidateGeometry(self);
 	self.layer.bounds = b;
 }
 
@@ -504,6 +562,7 @@ else CGContextSetRGBFillColor(context, 1, 0, 0, 0.3); CGContextFillRect(context,
 
 - (void)setTransform:(CGAffineTransform)t
 {
+	TUIAccessibilityInvalidateGeometry(self);
 	[self.layer setAffineTransform:t];
 }
 
@@ -625,6 +684,7 @@ else CGContextSetRGBFillColor(context, 1, 0, 0, 0.3); CGContextFillRect(context,
 		[self willMoveToSuperview:nil];
 
 		[superview.subviews removeObjectIdenticalTo:self];
+		[superview _invalidateAccessibilityChildren];
 		[self.layer removeFromSuperlayer];
 		self.nsView = nil;
 
@@ -700,6 +760,7 @@ else CGContextSetRGBFillColor(context, 1, 0, 0, 0.3); CGContextFillRect(context,
 	view.nsView = _nsView;
 
 #define POST_ADDSUBVIEW \
+	[self _invalidateAccessibilityChildren]; \
 	[self didAddSubview:view]; \
 	[view didMoveToSuperview]; \
 	[view setNextResponder:self]; \
@@ -840,6 +901,7 @@ else CGContextSetRGBFillColor(context, 1, 0, 0, 0.3); CGContextFillRect(context,
 
 - (void)setNeedsLayout
 {
+	TUIInputLatencyNoteInvalidation();
 	[self.layer setNeedsLayout];
 }
 
@@ -893,11 +955,13 @@ else CGContextSetRGBFillColor(context, 1, 0, 0, 0.3); CGContextFillRect(context,
 
 - (void)setNeedsDisplay
 {
+	TUIInputLatencyNoteInvalidation();
 	[self.layer setNeedsDisplay];
 }
 
 - (void)setNeedsDisplayInRect:(CGRect)rect
 {
+	TUIInputLatencyNoteInvalidation();
 	_context.dirtyRect = rect;
 	[self.layer setNeedsDisplayInRect:rect];
 }
@@ -977,6 +1041,7 @@ else CGContextSetRGBFillColor(context, 1, 0, 0, 0.3); CGContextFillRect(context,
 		[self willMoveToWindow:(TUINSWindow *)[n window]];
 		[[NSNotificationCenter defaultCenter] postNotificationName:TUIViewWillMoveToWindowNotification object:self userInfo:[n window] ? [NSDictionary dictionaryWithObject:[n window] forKey:TUIViewWindow] : nil];
 		_nsView = n;
+		_accessibilityGeometryGeneration = 0; // the cached frame was in the old TUINSView's coordinates
 		[self.subviews makeObjectsPerformSelector:@selector(setNSView:) withObject:n];
 		[self didMoveToWindow];
 		[[NSNotificationCenter defaultCenter] postNotificationName:TUIViewDidMoveToWindowNotification object:self userInfo:[n window] ? [NSDictionary dictionaryWithObject:[n window] forKey:TUIViewWindow] : nil];
@@ -0,0 +1,90 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+#include <mach/mach_time.h>
+
+typedef enum {
+	TUIProfileDisplaySetup,   // -displayLayer: getting and pushing the context
+	TUIProfileDisplayClear,   // clearing and configuring it
+	TUIProfileDrawRect,       // -drawRect: or the drawRect block
+	TUIProfileDisplayPublish, // making the image and setting layer contents
+	TUIProfileLayoutSubviews, // -layoutSubviews
+	TUIProfileBlockLayout,    // layout blocks of subviews
+	TUIProfileTableLayoutCells,
+	TUIProfileTableUpdateSectionInfo,
+	TUIProfileKindCount
+} TUIProfileKind;
+
+/**
+ Opt-in timing of what each TUIView subclass costs to draw and lay out.
+ 
+ Timed intervals go into a fixed size ring buffer (the newest 64k are kept)
+ that any thread appends to without locking. Export it as a Chrome trace
+ (chrome://tracing, or any viewer of the Trace Event format), or as a table
+ of totals per class.
+ 
+ Enable with +setEnabled:, or launch with TUIViewProfiler=1 in the
+ environment.
+ */
+@interface TUIViewProfiler : NSObject
+
++ (BOOL)isEnabled;
++ (void)setEnabled:(BOOL)enabled;
+
++ (void)reset; // drop recorded events
+
+/**
+ Trace Event format JSON of the recorded events, oldest first.
+ */
++ (NSData *)chromeTraceData;
++ (BOOL)writeChromeTraceToURL:(NSURL *)url;
+
+/**
+ Class name -> kind name -> dictionary of count, total and max (seconds).
+ */
++ (NSDictionary *)aggregates;
+
+/**
+ The aggregates as a text table, most expensive class first.
+ */
++ (NSString *)aggregateDescription;
+
+@end
+
+extern BOOL TUIViewProfilerEnabled;
+extern uint64_t _TUIProfileRecord(TUIProfileKind kind, id object, uint64_t start);
+
+/*
+ Timing points. Begin returns 0 when disabled, End records the interval
+ since 'start' (unless 0) and returns the current time, so consecutive
+ intervals chain:
+ 
+   uint64_t t = TUIProfileBegin();
+   ...
+   t = TUIProfileEnd(TUIProfileDisplaySetup, self, t);
+   ...
+   TUIProfileEnd(TUIProfileDrawRect, self, t);
+ */
+static inline uint64_t TUIProfileBegin(void)
+{
+	return TUIViewProfilerEnabled ? mach_absolute_time() : 0;
+}
+
+static inline uint64_t TUIProfileEnd(TUIProfileKind kind, id object, uint64_t start)
+{
+	return start ? _TUIProfileRecord(kind, object, start) : 0;
+}
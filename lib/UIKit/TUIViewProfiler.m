@@ -0,0 +1,214 @@
+/*
+ Copyright 2011 Twitter, Inc.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this work except in compliance with the License.
+ You may obtain a copy of the License in the LICENSE file, or at:
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "TUIViewProfiler.h"
+#import "TUIKit.h"
+#import <objc/runtime.h>
+#import <libkern/OSAtomic.h>
+#import <pthread.h>
+#import <unistd.h>
+
+#define TUIViewProfilerCapacity 65536 // power of two
+
+typedef struct {
+	volatile int64_t sequence; // index + 1 once the record is complete, 0 while being written
+	TUIProfileKind kind;
+	__unsafe_unretained Class cls;
+	uint64_t start;
+	uint64_t end;
+	uint32_t thread;
+} TUIProfileRecord;
+
+BOOL TUIViewProfilerEnabled = NO;
+
+static TUIProfileRecord *TUIProfileRecords = NULL;
+static volatile int64_t TUIProfileNextIndex = 0;
+
+static NSString *TUIProfileKindName(TUIProfileKind kind)
+{
+	switch(kind) {
+		case TUIProfileDisplaySetup: return @"display setup";
+		case TUIProfileDisplayClear: return @"display clear";
+		case TUIProfileDrawRect: return @"drawRect";
+		case TUIProfileDisplayPublish: return @"display publish";
+		case TUIProfileLayoutSubviews: return @"layoutSubviews";
+		case TUIProfileBlockLayout: return @"block layout";
+		case TUIProfileTableLayoutCells: return @"layout cells";
+		case TUIProfileTableUpdateSectionInfo: return @"update section info";
+		default: return @"?";
+	}
+}
+
+static double TUIProfileSecondsPerTick(void)
+{
+	static double secondsPerTick = 0.0;
+	if(secondsPerTick == 0.0) {
+		mach_timebase_info_data_t info;
+		mach_timebase_info(&info);
+		secondsPerTick = (double)info.numer / info.denom / NSEC_PER_SEC;
+	}
+	return secondsPerTick;
+}
+
+uint64_t _TUIProfileRecord(TUIProfileKind kind, id object, uint64_t start)
+{
+	uint64_t end = mach_absolute_time();
+	TUIProfileRecord *records = TUIProfileRecords;
+	if(!records)
+		return end;
+	
+	int64_t index = OSAtomicIncrement64Barrier(&TUIProfileNextIndex) - 1;
+	TUIProfileRecord *r = &records[index & (TUIViewProfilerCapacity - 1)];
+	r->sequence = 0;
+	OSMemoryBarrier();
+	r->kind = kind;
+	r->cls = object_getClass(object);
+	r->start = start;
+	r->end = end;
+	r->thread = pthread_mach_thread_np(pthread_self());
+	OSMemoryBarrier();
+	r->sequence = index + 1;
+	return end;
+}
+
+/**
+ Calls 'block' for every complete record still in the buffer, oldest first.
+ Records being overwritten while we read are skipped.
+ */
+static void TUIProfileEnumerateRecords(void (^block)(TUIProfileRecord *r))
+{
+	TUIProfileRecord *records = TUIProfileRecords;
+	if(!records)
+		return;
+	
+	int64_t end = TUIProfileNextIndex;
+	int64_t begin = MAX(0, end - TUIViewProfilerCapacity);
+	for(int64_t i = begin; i < end; ++i) {
+		TUIProfileRecord copy = records[i & (TUIViewProfilerCapacity - 1)];
+		OSMemoryBarrier();
+		if(copy.sequence == i + 1 && records[i & (TUIViewProfilerCapacity - 1)].sequence == i + 1)
+			block(&copy);
+	}
+}
+
+@implementation TUIViewProfiler
+
++ (void)load
+{
+	if(TUIEnvironmentFlag(@"TUIViewProfiler"))
+		[self setEnabled:YES];
+}
+
++ (BOOL)isEnabled
+{
+	return TUIViewProfilerEnabled;
+}
+
++ (void)setEnabled:(BOOL)enabled
+{
+	if(enabled && !TUIProfileRecords) {
+		// never freed, writers on other threads may still hold it
+		TUIProfileRecords = calloc(TUIViewProfilerCapacity, sizeof(TUIProfileRecord));
+		OSMemoryBarrier();
+	}
+	TUIViewProfilerEnabled = enabled;
+}
+
++ (void)reset
+{
+	TUIProfileRecord *records = TUIProfileRecords;
+	if(!records)
+		return;
+	for(NSUInteger i = 0; i < TUIViewProfilerCapacity; ++i)
+		records[i].sequence = 0;
+	OSMemoryBarrier();
+}
+
++ (NSData *)chromeTraceData
+{
+	double secondsPerTick = TUIProfileSecondsPerTick();
+	int pid = getpid();
+	NSMutableString *json = [NSMutableString stringWithString:@"{\"traceEvents\":[\n"];
+	__block BOOL first = YES;
+	TUIProfileEnumerateRecords(^(TUIProfileRecord *r) {
+		// complete events, timestamps in microseconds
+		[json appendFormat:@"%@{\"name\":\"%@\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u}",
+		 first ? @"" : @",\n",
+		 TUIProfileKindName(r->kind), class_getName(r->cls),
+		 r->start * secondsPerTick * 1e6, (r->end - r->start) * secondsPerTick * 1e6,
+		 pid, r->thread];
+		first = NO;
+	}];
+	[json appendString:@"\n],\"displayTimeUnit\":\"ms\"}\n"];
+	return [json dataUsingEncoding:NSUTF8StringEncoding];
+}
+
++ (BOOL)writeChromeTraceToURL:(NSURL *)url
+{
+	return [[self chromeTraceData] writeToURL:url atomically:YES];
+}
+
++ (NSDictionary *)aggregates
+{
+	double secondsPerTick = TUIProfileSecondsPerTick();
+	NSMutableDictionary *classes = [NSMutableDictionary dictionary];
+	TUIProfileEnumerateRecords(^(TUIProfileRecord *r) {
+		NSString *className = NSStringFromClass(r->cls);
+		NSMutableDictionary *kinds = [classes objectForKey:className];
+		if(!kinds) {
+			kinds = [NSMutableDictionary dictionary];
+			[classes setObject:kinds forKey:className];
+		}
+		NSString *kindName = TUIProfileKindName(r->kind);
+		NSDictionary *a = [kinds objectForKey:kindName];
+		double t = (r->end - r->start) * secondsPerTick;
+		[kinds setObject:[NSDictionary dictionaryWithObjectsAndKeys:
+						  [NSNumber numberWithUnsignedInteger:[[a objectForKey:@"count"] unsignedIntegerValue] + 1], @"count",
+						  [NSNumber numberWithDouble:[[a objectForKey:@"total"] doubleValue] + t], @"total",
+						  [NSNumber numberWithDouble:MAX([[a objectForKey:@"max"] doubleValue], t)], @"max",
+						  nil] forKey:kindName];
+	}];
+	return classes;
+}
+
++ (NSString *)aggregateDescription
+{
+	NSDictionary *classes = [self aggregates];
+	NSMutableDictionary *totals = [NSMutableDictionary dictionaryWithCapacity:[classes count]];
+	for(NSString *className in classes) {
+		double total = 0.0;
+		for(NSDictionary *a in [[classes objectForKey:className] allValues])
+			total += [[a objectForKey:@"total"] doubleValue];
+		[totals setObject:[NSNumber numberWithDouble:total] forKey:className];
+	}
+	NSArray *sorted = [totals keysSortedByValueUsingComparator:^NSComparisonResult(NSNumber *a, NSNumber *b) {
+		return [b compare:a];
+	}];
+	
+	NSMutableString *s = [NSMutableString stringWithFormat:@"%-40s %-20s %8s %10s %10s %10s\n", "class", "phase", "count", "total ms", "mean ms", "max ms"];
+	for(NSString *className in sorted) {
+		NSDictionary *kinds = [classes objectForKey:className];
+		for(NSString *kindName in [[kinds allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+			NSDictionary *a = [kinds objectForKey:kindName];
+			NSUInteger count = [[a objectForKey:@"count"] unsignedIntegerValue];
+			double total = [[a objectForKey:@"total"] doubleValue];
+			[s appendFormat:@"%-40s %-20s %8lu %10.2f %10.3f %10.3f\n", [className UTF8String], [kindName UTF8String], (unsigned long)count, total * 1000.0, total * 1000.0 / count, [[a objectForKey:@"max"] doubleValue] * 1000.0];
+		}
+	}
+	return s;
+}
+
+@end